@@ -107,7 +107,8 @@ static void FreeString(const char* str)
 	};
 
 #ifndef FAST_BUFFER_SIZE
-	ICE_COMPILE_TIME_ASSERT(sizeof(DebugBlock)==24);	// Prevents surprises.....
+	ICE_COMPILE_TIME_ASSERT(sizeof(DebugBlock)==16+2*sizeof(void*));	// Prevents surprises.....
+	// Sizes are kept on 32 bits in the blocks, they're only used for stats & by shrink(), which is disabled
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -235,7 +236,7 @@ void DefaultAllocator::reset()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void* DefaultAllocator::malloc(udword size, MemoryType type)
+void* DefaultAllocator::malloc(size_t size, MemoryType type)
 {
 //	return ::malloc(size);
 
@@ -254,7 +255,7 @@ void* DefaultAllocator::malloc(udword size, MemoryType type)
 	mTotalNbAllocs++;
 	mNbAllocs++;
 
-	mNbAllocatedBytes+=size;
+	mNbAllocatedBytes+=sdword(size);
 	if(mNbAllocatedBytes>mHighWaterMark)	mHighWaterMark = mNbAllocatedBytes;
 
 #ifdef ZERO_OVERHEAD_RELEASE
@@ -263,7 +264,7 @@ void* DefaultAllocator::malloc(udword size, MemoryType type)
 	void* ptr = (void*)LOCAL_MALLOC(size+8);
 	udword* blockStart = (udword*)ptr;
 	blockStart[0] = DEBUG_IDENTIFIER;
-	blockStart[1] = size;
+	blockStart[1] = udword(size);
 	return ((udword*)ptr)+2;
 #endif
 }
@@ -319,7 +320,7 @@ void* DefaultAllocator::mallocDebug(size_t size, const char* filename, udword li
 	// Allocate one debug block in front of each real allocation
 	void* ptr = (void*)LOCAL_MALLOC(size + sizeof(DebugBlock));
 #endif
-	ASSERT(IS_ALIGNED_2(udword(ptr)));
+	ASSERT(IS_ALIGNED_2(size_t(ptr)));
 
 	// Fill debug block
 	DebugBlock* DB = (DebugBlock*)ptr;
@@ -327,7 +328,7 @@ void* DefaultAllocator::mallocDebug(size_t size, const char* filename, udword li
 #ifdef FAST_BUFFER_SIZE
 	DB->mType		= type;
 #endif
-	DB->mSize		= size;
+	DB->mSize		= udword(size);
 	DB->mLine		= line;
 	DB->mSlotIndex	= INVALID_ID;
 #ifdef ALLOC_STRINGS
@@ -341,7 +342,7 @@ void* DefaultAllocator::mallocDebug(size_t size, const char* filename, udword li
 	// Update global stats
 	mTotalNbAllocs++;
 	mNbAllocs++;
-	mNbAllocatedBytes += size;
+	mNbAllocatedBytes += sdword(size);
 	if(mNbAllocatedBytes>mHighWaterMark)
 		mHighWaterMark = mNbAllocatedBytes;
 
@@ -431,7 +432,7 @@ void* DefaultAllocator::mallocDebug(size_t size, const char* filename, udword li
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void* DefaultAllocator::shrink(void* memory, udword size)
+void* DefaultAllocator::shrink(void* memory, size_t size)
 {
 	return null;	// #ifdef ZERO_OVERHEAD_RELEASE
 
@@ -464,9 +465,9 @@ void* DefaultAllocator::shrink(void* memory, udword size)
 
 	// Update stats
 	mNbAllocatedBytes -= DB->mSize;
-	mNbAllocatedBytes += size;
+	mNbAllocatedBytes += sdword(size);
 	// Setup new size
-	DB->mSize = size;
+	DB->mSize = udword(size);
 
 	return memory;	// The pointer should not have changed!
 #else
@@ -494,9 +495,9 @@ void* DefaultAllocator::shrink(void* memory, udword size)
 
 	// Update stats
 	mNbAllocatedBytes -= SystemPointer[1];
-	mNbAllocatedBytes += size;
+	mNbAllocatedBytes += sdword(size);
 	// Setup new size
-	SystemPointer[1] = size;
+	SystemPointer[1] = udword(size);
 
 	return memory;	// The pointer should not have changed!
 #endif
@@ -504,7 +505,7 @@ void* DefaultAllocator::shrink(void* memory, udword size)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void* DefaultAllocator::realloc(void* memory, udword size)
+void* DefaultAllocator::realloc(void* memory, size_t size)
 {
 //	return ::realloc(memory, size);
 
@@ -47,6 +47,7 @@
 	//! Fast square root for floating-point values.
 	inline_ float FastSqrt(float square)
 	{
+#ifdef PLATFORM_X86
 			float retval;
 
 			__asm {
@@ -57,6 +58,10 @@
 					mov             [retval], eax
 			}
 			return retval;
+#else
+			const udword retval = udword((SIR(square) - 0x3F800000) >> 1) + 0x3F800000;
+			return FR(retval);
+#endif
 	}
 
 	//! Saturates positive to zero.
@@ -184,6 +189,7 @@
 		return x*x < epsilon;
 	}
 
+#ifdef PLATFORM_X86
 	#define FCOMI_ST0	_asm	_emit	0xdb	_asm	_emit	0xf0
 	#define FCOMIP_ST0	_asm	_emit	0xdf	_asm	_emit	0xf0
 	#define FCMOVB_ST0	_asm	_emit	0xda	_asm	_emit	0xc0
@@ -321,6 +327,15 @@
 		_asm	fcomp
 		return Res;
 	}
+#else
+	// No FCOMI/FCMOV without inline assembly, the compiler uses SSE min/max instead
+	inline_ float FCMax2(float a, float b)					{ return a > b ? a : b;								}
+	inline_ float FCMin2(float a, float b)					{ return a < b ? a : b;								}
+	inline_ float FCMax3(float a, float b, float c)			{ return FCMax2(FCMax2(a, b), c);					}
+	inline_ float FCMin3(float a, float b, float c)			{ return FCMin2(FCMin2(a, b), c);					}
+	inline_ float FCMax4(float a, float b, float c, float d)	{ return FCMax2(FCMax2(a, b), FCMax2(c, d));		}
+	inline_ float FCMin4(float a, float b, float c, float d)	{ return FCMin2(FCMin2(a, b), FCMin2(c, d));		}
+#endif
 
 	inline_ int ConvertToSortable(float f)
 	{
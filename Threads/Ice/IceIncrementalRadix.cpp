@@ -0,0 +1,354 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a time-sliced radix sort.
+ *	\file		IceIncrementalRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	This is the same 8-bit radix sort as RadixSort, except it can be run in small steps. One large sort call can
+ *	take dozens of milliseconds, which is a problem in a frame loop. Instead you call Start() once, then Step()
+ *	each frame with a work budget (a number of values to process) until it returns true. All the intermediate
+ *	state (histograms, current pass, offsets, partially sorted ranks) lives in the sorter.
+ *
+ *	The work is made of one histogram pass followed by (at most) four scatter passes, each of them processing
+ *	the N values in chunks. Computing the offsets between two passes is not accounted for in the budget, it's
+ *	just 256 additions. Each chunk goes through the RadixEngine kernels, with the same key traits as RadixSort.
+ *
+ *	Temporal coherence is limited to already sorted input (in linear order), since the previous ranks are gone
+ *	by the time the next sort starts.
+ *
+ *	\class		IncrementalRadixSort
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+IncrementalRadixSort::IncrementalRadixSort() :
+	mCurrentSize	(0),
+	mRanks			(null),
+	mRanks2			(null),
+	mInput			(null),
+	mNb				(0),
+	mKeyType		(RADIX_KEY_U32),
+	mAlreadySorted	(false),
+	mValidRanks		(false),
+	mState			(INCREMENTAL_RADIX_IDLE),
+	mPass			(0),
+	mNbPasses		(0),
+	mCursor			(0),
+	mPrevKey		(0),
+	mWorkDone		(0),
+	mTotalWork		(0),
+	mTotalCalls		(0),
+	mNbSteps		(0),
+	mNbHits			(0),
+	mDeleteRanks	(true)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+IncrementalRadixSort::~IncrementalRadixSort()
+{
+	// Release everything
+	if(mDeleteRanks)
+	{
+		ICE_FREE(mRanks2);
+		ICE_FREE(mRanks);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Resizes the inner lists.
+ *	\param		nb	[in] new size (number of dwords)
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IncrementalRadixSort::Resize(udword nb)
+{
+	if(mDeleteRanks)
+	{
+		// Free previously used ram
+		ICE_FREE(mRanks2);
+		ICE_FREE(mRanks);
+
+		// Get some fresh one
+		mRanks	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks);
+		mRanks2	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks2);
+	}
+	mCurrentSize = nb;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Starts sorting integer values. Nothing is sorted until Step() or Finish() is called.
+ *	\param		input	[in] a list of integer values to sort, must stay valid until the sort is done
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] same as for RadixSort
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IncrementalRadixSort::Start(const udword* input, udword nb, const RadixHints& hints)
+{
+	return StartSort(input, nb, hints, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Starts sorting floating-point values. Nothing is sorted until Step() or Finish() is called.
+ *	\param		input	[in] a list of floating-point values to sort, must stay valid until the sort is done
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] same as for RadixSort
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IncrementalRadixSort::Start(const float* input, udword nb, const RadixHints& hints)
+{
+	return StartSort((const udword*)input, nb, hints, true);
+}
+
+bool IncrementalRadixSort::StartSort(const udword* input, udword nb, const RadixHints& hints, bool is_float)
+{
+	// Checkings
+	mState = INCREMENTAL_RADIX_IDLE;
+	if(!input || !nb || nb&0x80000000)	return false;
+
+	// Stats
+	mTotalCalls++;
+
+	// Resize lists if needed
+	if(nb>mCurrentSize && !Resize(nb))	return false;
+
+	mInput			= input;
+	mNb				= nb;
+	mKeyType		= GetRadixKeyType(hints, is_float);
+	mNbPasses		= is_float ? 4 : hints.GetNbPasses(8, 4);
+	mAlreadySorted	= (hints.mFlags & RADIX_RANDOM)==0;
+	mValidRanks		= false;
+	mPass			= 0;
+	mCursor			= 0;
+	mPrevKey		= 0;
+	mWorkDone		= 0;
+	mTotalWork		= uqword(nb)*(1+mNbPasses);	// Worst case, refined once histograms are available
+	mState			= INCREMENTAL_RADIX_HISTOGRAMS;
+
+	ZeroMemory(mHistogram, 256*4*sizeof(udword));
+	return true;
+}
+
+// Histograms, offsets & scatters are the RadixEngine kernels, run on one chunk at a time
+template<class Traits>
+void IncrementalRadixSort::RunSteps(udword budget)
+{
+	while(budget && mState!=INCREMENTAL_RADIX_DONE)
+	{
+		const udword Start = mCursor;
+		const udword Count = MIN(budget, mNb - Start);
+		const udword End = Start + Count;
+
+		if(mState==INCREMENTAL_RADIX_HISTOGRAMS)	CreateHistograms<Traits>(Start, End);
+		else										Scatter<Traits>(Start, End);
+
+		mCursor		= End;
+		mWorkDone	+= Count;
+		budget		-= Count;
+
+		if(mCursor==mNb)
+		{
+			if(mState==INCREMENTAL_RADIX_HISTOGRAMS)	EndHistograms<Traits>();
+			else
+			{
+				EndPass();
+				StartNextPass<Traits>();
+			}
+		}
+	}
+}
+
+template<class Traits>
+void IncrementalRadixSort::CreateHistograms(udword start, udword end)
+{
+	typedef RadixEngine<Traits, 8>	Engine;
+
+	udword i = start;
+	if(mAlreadySorted)
+	{
+		// Keys are sortable, so this is the same as the float comparison in RadixSort, except negative zero is smaller than positive zero
+		udword PrevKey = start ? mPrevKey : Engine::GetKey(mInput, 0);
+		for(;i<end;i++)
+		{
+			const udword Key = Engine::GetKey(mInput, i);
+			if(Key<PrevKey)	{ mAlreadySorted = false; break; }	// Early out
+			PrevKey = Key;
+			Engine::UpdateHistograms(mHistogram, Key);
+		}
+		mPrevKey = PrevKey;
+	}
+
+	// Create histograms without the previous overhead
+	Engine::UpdateHistograms(mInput, i, end, mHistogram);
+}
+
+template<class Traits>
+void IncrementalRadixSort::EndHistograms()
+{
+	typedef RadixEngine<Traits, 8>	Engine;
+
+	// If all input values are already sorted, we just have to return identity ranks
+	if(mAlreadySorted)
+	{
+		mNbHits++;
+		for(udword i=0;i<mNb;i++)	mRanks[i] = i;
+		mState = INCREMENTAL_RADIX_DONE;
+		return;
+	}
+
+	// Now that we know which passes are useless, refine the amount of remaining work
+	udword NbPasses = 0;
+	for(udword j=0;j<mNbPasses;j++)
+	{
+		if(Engine::IsPassUseful(mInput, mNb, mHistogram, j))
+			NbPasses++;
+	}
+	mTotalWork = mWorkDone + uqword(NbPasses)*mNb;
+
+	mPass = 0;
+	StartNextPass<Traits>();
+}
+
+template<class Traits>
+bool IncrementalRadixSort::StartNextPass()
+{
+	typedef RadixEngine<Traits, 8>	Engine;
+
+	mCursor = 0;
+	while(mPass<mNbPasses)
+	{
+		// If all values have the same byte, sorting is useless. Else counters of the pass become the running offsets.
+		if(Engine::IsPassUseful(mInput, mNb, mHistogram, mPass))
+		{
+			Engine::CreateOffsets(&mHistogram[mPass<<8], Engine::GetFirstDigit(mPass, mNbPasses));
+			mState = INCREMENTAL_RADIX_SCATTER;
+			return true;
+		}
+		mPass++;
+	}
+
+	// All passes have been performed or skipped
+	if(!mValidRanks)
+	{
+		for(udword i=0;i<mNb;i++)	mRanks[i] = i;
+		mValidRanks = true;
+	}
+	mState = INCREMENTAL_RADIX_DONE;
+	return false;
+}
+
+template<class Traits>
+void IncrementalRadixSort::Scatter(udword start, udword end)
+{
+	// Keys are sortable, including negative floats, so the scatter always goes forward and equal values keep their order
+	RadixEngine<Traits, 8>::ScatterRange(mInput, start, end, mPass, &mHistogram[mPass<<8], mValidRanks ? mRanks : null, mRanks2);
+}
+
+void IncrementalRadixSort::EndPass()
+{
+	// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
+	udword* Tmp = mRanks;
+	mRanks = mRanks2;
+	mRanks2 = Tmp;
+	mValidRanks = true;
+
+	mPass++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Performs a bounded amount of work.
+ *	\param		budget	[in] max number of values to process during this call
+ *	\return		true if the sort is over, i.e. ranks are available
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IncrementalRadixSort::Step(udword budget)
+{
+	if(mState==INCREMENTAL_RADIX_IDLE || mState==INCREMENTAL_RADIX_DONE)
+		return IsDone();
+
+	// Stats
+	mNbSteps++;
+
+	switch(mKeyType)
+	{
+		case RADIX_KEY_U32:	RunSteps<RadixKeyU32>(budget);	break;
+		case RADIX_KEY_S32:	RunSteps<RadixKeyS32>(budget);	break;
+		case RADIX_KEY_F32:	RunSteps<RadixKeyF32>(budget);	break;
+	}
+	return IsDone();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Runs the remaining work, whatever it takes.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void IncrementalRadixSort::Finish()
+{
+	while(!Step(0xffffffff) && mState!=INCREMENTAL_RADIX_IDLE);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Returns the progress of current sort.
+ *	\return		a value between 0.0 (nothing done) and 1.0 (ranks are available)
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+float IncrementalRadixSort::GetProgress() const
+{
+	if(mState==INCREMENTAL_RADIX_DONE)	return 1.0f;
+	if(mState==INCREMENTAL_RADIX_IDLE || !mTotalWork)	return 0.0f;
+	return float(mWorkDone)/float(mTotalWork);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword IncrementalRadixSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(IncrementalRadixSort);
+	UsedRam += 2*mCurrentSize*sizeof(udword);	// 2 lists of indices
+	return UsedRam;
+}
+
+bool IncrementalRadixSort::SetRankBuffers(udword* ranks0, udword* ranks1)
+{
+	if(!ranks0 || !ranks1)	return false;
+
+	mRanks			= ranks0;
+	mRanks2			= ranks1;
+	mDeleteRanks	= false;
+	return true;
+}
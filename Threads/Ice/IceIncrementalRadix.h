@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a time-sliced radix sort.
+ *	\file		IceIncrementalRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICEINCREMENTALRADIX_H
+#define ICEINCREMENTALRADIX_H
+
+	enum IncrementalRadixState
+	{
+		INCREMENTAL_RADIX_IDLE,			//!< Nothing to sort, Start() hasn't been called
+		INCREMENTAL_RADIX_HISTOGRAMS,	//!< Creating the histograms
+		INCREMENTAL_RADIX_SCATTER,		//!< Running one of the radix passes
+		INCREMENTAL_RADIX_DONE,			//!< Ranks are available
+
+		INCREMENTAL_RADIX_FORCE_DWORD = 0x7fffffff
+	};
+
+	class ICECORE_API IncrementalRadixSort : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								IncrementalRadixSort();
+								~IncrementalRadixSort();
+		// Sorting methods. The input buffer must stay valid & unchanged until the sort is done.
+				bool			Start(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				bool			Start(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				bool			Step(udword budget);
+				void			Finish();
+
+		//! Checks whether the sort is over, i.e. ranks are available.
+		inline_	bool			IsDone()			const	{ return mState==INCREMENTAL_RADIX_DONE;	}
+		//! Returns the current state.
+		inline_	IncrementalRadixState	GetState()	const	{ return mState;		}
+		//! Returns the current pass number (0=LSB, 3=MSB), only meaningful during INCREMENTAL_RADIX_SCATTER.
+		inline_	udword			GetPass()			const	{ return mPass;			}
+				float			GetProgress()		const;
+
+		//! Access to results. mRanks is a list of indices in sorted order. Only valid once IsDone() returns true.
+		inline_	const udword*	GetRanks()			const	{ return mRanks;		}
+
+		//! mIndices2 gets trashed on calling the sort routine, but otherwise you can recycle it the way you want.
+		inline_	udword*			GetRecyclable()		const	{ return mRanks2;		}
+
+		// Stats
+				udword			GetUsedRam()		const;
+		//! Returns the total number of calls to the radix sorter.
+		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
+		//! Returns the total number of calls to the Step() function.
+		inline_	udword			GetNbSteps()		const	{ return mNbSteps;		}
+		//! Returns the number of early exits due to already sorted input.
+		inline_	udword			GetNbHits()			const	{ return mNbHits;		}
+
+				bool			SetRankBuffers(udword* ranks0, udword* ranks1);
+
+								PREVENT_COPY(IncrementalRadixSort)
+		private:
+				udword			mCurrentSize;		//!< Current size of the indices list
+				udword*			mRanks;				//!< Two lists, swapped each pass
+				udword*			mRanks2;
+		// Current sort
+				const udword*	mInput;				//!< Values being sorted (integer representation)
+				udword			mNb;				//!< Number of values being sorted
+				RadixKeyType	mKeyType;			//!< Key traits the engine kernels are run with
+				bool			mAlreadySorted;		//!< Running result of the coherence check
+				bool			mValidRanks;		//!< False until the first pass has been performed
+				IncrementalRadixState	mState;		//!< Current phase
+				udword			mPass;				//!< Current pass (0=LSB, 3=MSB)
+				udword			mNbPasses;			//!< Number of planned passes
+				udword			mCursor;			//!< Current position within the current phase
+				udword			mPrevKey;			//!< Previous key, for the coherence check
+				uqword			mWorkDone;			//!< Number of processed values so far, for progress report. 64-bit since values are counted once per pass.
+				uqword			mTotalWork;			//!< Total number of values to process, for progress report
+				udword			mHistogram[256*4];	//!< Counters for all passes, turned into offsets when their pass starts
+		// Stats
+				udword			mTotalCalls;		//!< Total number of calls to the sort routine
+				udword			mNbSteps;			//!< Total number of calls to the Step() function
+				udword			mNbHits;			//!< Number of early exits due to coherence
+		// Stack-radix
+				bool			mDeleteRanks;		//!<
+		// Internal methods
+				bool			Resize(udword nb);
+				bool			StartSort(const udword* input, udword nb, const RadixHints& hints, bool is_float);
+		template<class Traits>
+				void			RunSteps(udword budget);
+		template<class Traits>
+				void			CreateHistograms(udword start, udword end);
+		template<class Traits>
+				void			EndHistograms();
+		template<class Traits>
+				bool			StartNextPass();
+		template<class Traits>
+				void			Scatter(udword start, udword end);
+				void			EndPass();
+	};
+
+#endif // ICEINCREMENTALRADIX_H
@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a radix sort with a templated rank type, for very large arrays.
+ *	\file		IceLargeRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A radix sort for more than 2^31 values.
+ *
+ *	RadixSort and RadixSort3 are limited to 2^31 values: the top bit of mCurrentSize is the "invalid ranks" flag, and
+ *	sizes, ranks and histogram counters are all udwords. Here they all use the RankT type instead, and the flag has its
+ *	own bool. RadixSort64 (RankT = uqword) handles billions of values, at the cost of twice the memory for the ranks.
+ *	The regular sorters are left untouched, so 32-bit users don't pay for any of this.
+ *
+ *	The algorithm is the same as in RadixSort3 (11-bit radix, 3 passes max, temporal coherence). Keys are transformed
+ *	when they're read so that they sort as unsigned values, which removes the special negative pass:
+ *	- signed integers get their sign bit flipped,
+ *	- negative floats get all their bits flipped, positive floats only their sign bit (i.e. IEEE totalOrder).
+ *
+ *	Of course you need a 64-bit build (and a 64-bit allocator) to go over 4 Gb of ranks.
+ *
+ *	\class		RadixSortT
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#define	RADIX_NB_BITS	11
+#define	MAX_NB_PASSES	3
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class RankT>
+RadixSortT<RankT>::RadixSortT() : mCurrentSize(0), mMaxSize(0), mRanks(null), mRanks2(null), mValidRanks(false), mTotalCalls(0), mNbHits(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class RankT>
+RadixSortT<RankT>::~RadixSortT()
+{
+	ICE_FREE(mRanks2);
+	ICE_FREE(mRanks);
+}
+
+template<class RankT>
+bool RadixSortT<RankT>::CheckResize(RankT nb)
+{
+	if(nb==mCurrentSize)	return true;
+
+	mValidRanks = false;
+	if(nb>mMaxSize)
+	{
+		ICE_FREE(mRanks2);
+		ICE_FREE(mRanks);
+		mCurrentSize = mMaxSize = 0;
+
+		// Don't let the byte size wrap around on 32-bit builds
+		if(nb>RankT(size_t(-1)/sizeof(RankT)))	return false;
+		const size_t Size = size_t(nb)*sizeof(RankT);
+
+		mRanks	= (RankT*)ICE_ALLOC(Size);	CHECKALLOC(mRanks);
+		mRanks2	= (RankT*)ICE_ALLOC(Size);	CHECKALLOC(mRanks2);
+		mMaxSize = nb;
+	}
+	mCurrentSize = nb;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of integer values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_SIGNED to handle negative values, RADIX_UNSIGNED if you know your input buffer only contains positive values.
+ *							Extra hints (RADIX_POSITIVE, RADIX_PRESORTED, RADIX_RANDOM, number of bits) can be passed in a RadixHints struct.
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class RankT>
+RadixSortT<RankT>& RadixSortT<RankT>::Sort(const udword* input, RankT nb, const RadixHints& hints)
+{
+	// Checkings
+	if(!input || !nb)	return *this;
+
+	const udword NbPasses = hints.GetNbPasses(RADIX_NB_BITS, MAX_NB_PASSES);
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU32>(input, nb, NbPasses, hints);
+	else					return SortKeys<RadixKeyS32>(input, nb, NbPasses, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for floating-point values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of floating-point values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_POSITIVE if you know all values are positive, RADIX_PRESORTED or RADIX_RANDOM to tweak temporal coherence
+ *	\return		Self-Reference
+ *	\warning	only sorts IEEE floating-point values
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class RankT>
+RadixSortT<RankT>& RadixSortT<RankT>::Sort(const float* input, RankT nb, const RadixHints& hints)
+{
+	// Checkings
+	if(!input || !nb)	return *this;
+
+	// Positive floats sort like unsigned integers
+	if(hints.mFlags & RADIX_POSITIVE)	return SortKeys<RadixKeyU32>((const udword*)input, nb, MAX_NB_PASSES, hints);
+	else								return SortKeys<RadixKeyF32>((const udword*)input, nb, MAX_NB_PASSES, hints);
+}
+
+template<class RankT>
+template<class Traits>
+RadixSortT<RankT>& RadixSortT<RankT>::SortKeys(const typename Traits::Type* input, RankT nb, udword nb_passes, const RadixHints& hints)
+{
+	typedef RadixEngine<Traits, RADIX_NB_BITS, RankT>	Engine;
+
+	// Stats
+	mTotalCalls++;
+
+	// Resize lists if needed
+	if(!CheckResize(nb))	return *this;
+
+	// Allocate histograms on the stack. Counters must be able to count up to nb.
+	RankT Histogram[Engine::HistogramSize];
+
+	RadixRanks<RankT> Ranks = { mRanks, mRanks2, mValidRanks };
+	if(Engine::Sort(input, nb, nb_passes, hints, Histogram, Ranks))
+		mNbHits++;
+	mRanks		= Ranks.mRanks;
+	mRanks2		= Ranks.mRanks2;
+	mValidRanks	= Ranks.mValid;
+	return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class RankT>
+uqword RadixSortT<RankT>::GetUsedRam() const
+{
+	uqword UsedRam = sizeof(RadixSortT);
+	UsedRam += 2*uqword(mMaxSize)*sizeof(RankT);	// 2 lists of indices
+	return UsedRam;
+}
+
+// Explicit instantiations
+template class RadixSortT<udword>;
+template class RadixSortT<uqword>;
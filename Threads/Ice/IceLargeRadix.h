@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a radix sort with a templated rank type, for very large arrays.
+ *	\file		IceLargeRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICELARGERADIX_H
+#define ICELARGERADIX_H
+
+	//! Radix sort with RankT sizes, ranks and histogram counters. Instantiated for udword and uqword.
+	template<class RankT>
+	class RadixSortT : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								RadixSortT();
+								~RadixSortT();
+		// Sorting methods
+				RadixSortT&		Sort(const udword* input, RankT nb, const RadixHints& hints=RADIX_SIGNED);
+				RadixSortT&		Sort(const float* input, RankT nb, const RadixHints& hints=RADIX_SIGNED);
+
+		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data
+		inline_	const RankT*	GetRanks()			const	{ return mRanks;		}
+
+		//! mIndices2 gets trashed on calling the sort routine, but otherwise you can recycle it the way you want.
+		inline_	RankT*			GetRecyclable()		const	{ return mRanks2;		}
+
+		// Stats
+				uqword			GetUsedRam()		const;
+		//! Returns the total number of calls to the radix sorter.
+		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
+		//! Returns the number of early exits due to temporal coherence.
+		inline_	udword			GetNbHits()			const	{ return mNbHits;		}
+
+								PREVENT_COPY(RadixSortT)
+		private:
+				RankT			mCurrentSize;		//!< Current number of ranks
+				RankT			mMaxSize;			//!< Capacity of the rank lists
+				RankT*			mRanks;				//!< Two lists, swapped each pass
+				RankT*			mRanks2;
+				bool			mValidRanks;		//!< Ranks from the previous sort are valid. Not a size bit anymore, so all sizes can be used.
+		// Stats
+				udword			mTotalCalls;		//!< Total number of calls to the sort routine
+				udword			mNbHits;			//!< Number of early exits due to coherence
+		// Internal methods
+				bool			CheckResize(RankT nb);
+		template<class Traits>
+				RadixSortT&		SortKeys(const typename Traits::Type* input, RankT nb, udword nb_passes, const RadixHints& hints);
+	};
+
+	//! Same as RadixSort3 but with 64-bit sizes & ranks, for more than 2^31 values. Needs an x64 build, 32-bit builds can't allocate the ranks.
+	typedef RadixSortT<uqword>	RadixSort64;
+
+#endif // ICELARGERADIX_H
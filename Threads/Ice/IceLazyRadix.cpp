@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a lazy radix sort.
+ *	\file		IceLazyRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A sorted view where you only pay for the part you read. Typical users only need the front of the sorted
+ *	order: the N nearest objects, the highest priorities, or a traversal that stops early.
+ *
+ *	Init() does a single MSD pass. It partitions the values on their top 11 bits into 2048 buckets. Buckets
+ *	are then sorted one by one, in order, when the iterator (or GetRanks/GetRank) reaches them:
+ *	- small buckets are sorted with IntroSort, on (key, index) pairs packed in 64-bit values,
+ *	- mid-sized buckets use the 8-bit radix engine on their remaining 21 bits, i.e. 3 passes,
+ *	- large buckets use the 11-bit radix engine, i.e. 2 passes.
+ *
+ *	There are up to 2048 bucket sorts, so their fixed cost matters: 11-bit passes clear & sum 2048 counters each,
+ *	which is more than the scatter itself for a few hundred values. Hence the extra 8-bit pass for mid-sized
+ *	buckets. Both engines run in scratch ranks allocated once by Init(), for the largest bucket.
+ *
+ *	A full traversal therefore costs one partition pass plus two or three radix passes, about the same as RadixSort3.
+ *	Reading only the first few values costs the partition pass plus one bucket.
+ *
+ *	Values are transformed during the partition so that they all sort as unsigned integers (flipped sign bit
+ *	for signed integers, flipped sign bit or all bits for floats). The order is stable.
+ *
+ *	\class		LazyRadixSort
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#define	LAZY_RADIX_SHIFT			(32-LAZY_RADIX_NB_BITS)
+#define	LAZY_RADIX_INTROSORT_LIMIT	256		// Buckets smaller than this are sorted with IntroSort
+#define	LAZY_RADIX_8BIT_LIMIT		512		// Buckets smaller than this are sorted with 8-bit digits
+
+// Keys of a bucket only differ in their low bits, so the engines don't need histograms for the top digit
+struct RadixKeyLazyLow : RadixKeyU32
+{
+	enum { NbBits = LAZY_RADIX_SHIFT };
+};
+
+// Sorts the keys of a bucket. Returns ranks0 or ranks1, the other one can be recycled.
+template<udword NbDigitBits>
+static udword* SortBucketKeys(const udword* keys, udword nb, udword* ranks0, udword* ranks1)
+{
+	typedef RadixEngine<RadixKeyLazyLow, NbDigitBits>	Engine;
+
+	// Previous ranks belong to another bucket: the coherence check would be useless, and starting from them would break the stability
+	udword Histogram[Engine::HistogramSize];
+	RadixRanks<udword> Ranks = { ranks0, ranks1, false };
+	Engine::Sort(keys, nb, Engine::MaxNbPasses, RadixHints(RADIX_UNSIGNED, RADIX_RANDOM), Histogram, Ranks);
+	return Ranks.mRanks;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+LazyRadixSort::LazyRadixSort() : mCurrentSize(0), mRanks(null), mKeys(null), mBucketRanks(null), mBucketRanksSize(0), mNb(0), mNbSorted(0), mNbSortedBuckets(0)
+{
+	ZeroMemory(mBucketStart, sizeof(mBucketStart));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+LazyRadixSort::~LazyRadixSort()
+{
+	ICE_FREE(mBucketRanks);
+	ICE_FREE(mKeys);
+	ICE_FREE(mRanks);
+}
+
+bool LazyRadixSort::Resize(udword nb)
+{
+	if(nb<=mCurrentSize)	return true;
+
+	ICE_FREE(mKeys);
+	ICE_FREE(mRanks);
+	mCurrentSize = 0;
+
+	mRanks	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks);
+	mKeys	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mKeys);
+	mCurrentSize = nb;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Prepares the sorted view of a list of integer values. The input buffer can be discarded after the call.
+ *	\param		input	[in] a list of integer values
+ *	\param		nb		[in] number of values
+ *	\param		hints	[in] RADIX_SIGNED or RADIX_UNSIGNED
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool LazyRadixSort::Init(const udword* input, udword nb, const RadixHints& hints)
+{
+	if(hints.IsUnsigned())	return Partition<RadixKeyU32>(input, nb);
+	else					return Partition<RadixKeyS32>(input, nb);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Prepares the sorted view of a list of floating-point values. The input buffer can be discarded after the call.
+ *	\param		input	[in] a list of floating-point values
+ *	\param		nb		[in] number of values
+ *	\param		hints	[in] RADIX_POSITIVE if all values are known to be positive
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool LazyRadixSort::Init(const float* input, udword nb, const RadixHints& hints)
+{
+	if(hints.mFlags & RADIX_POSITIVE)	return Partition<RadixKeyU32>((const udword*)input, nb);
+	else								return Partition<RadixKeyF32>((const udword*)input, nb);
+}
+
+template<class Traits>
+bool LazyRadixSort::Partition(const udword* input, udword nb)
+{
+	// Checkings
+	if(nb && !input)	return false;
+	if(nb&0x80000000)	return false;
+
+	mNb = 0;
+	mNbSorted = 0;
+	mNbSortedBuckets = 0;
+	if(!Resize(nb))	return false;
+	mNb = nb;
+
+	// Histogram of the top digit
+	udword Histogram[LAZY_RADIX_NB_BUCKETS];
+	ZeroMemory(Histogram, sizeof(Histogram));
+	for(udword i=0;i<nb;i++)
+		Histogram[Traits::ToSortable(input[i])>>LAZY_RADIX_SHIFT]++;
+
+	// Bucket offsets
+	udword* Link = mBucketStart;
+	Link[0] = 0;
+	udword MaxBucketSize = 0;
+	for(udword i=0;i<LAZY_RADIX_NB_BUCKETS;i++)
+	{
+		Link[i+1] = Link[i] + Histogram[i];
+		if(Histogram[i]>MaxBucketSize)	MaxBucketSize = Histogram[i];
+	}
+
+	// Scratch ranks for the radix engines, two lists for the largest bucket
+	if(MaxBucketSize>=LAZY_RADIX_INTROSORT_LIMIT && MaxBucketSize>mBucketRanksSize)
+	{
+		ICE_FREE(mBucketRanks);
+		mBucketRanksSize = 0;
+		mBucketRanks = (udword*)ICE_ALLOC(sizeof(udword)*MaxBucketSize*2);
+		if(!mBucketRanks)
+		{
+			mNb = 0;
+			return false;
+		}
+		mBucketRanksSize = MaxBucketSize;
+	}
+
+	// Scatter keys & indices. We reuse the histogram as running offsets.
+	for(udword i=0;i<LAZY_RADIX_NB_BUCKETS;i++)
+		Histogram[i] = Link[i];
+
+	udword* Keys = mKeys;
+	udword* Ranks = mRanks;
+	for(udword i=0;i<nb;i++)
+	{
+		const udword Data = Traits::ToSortable(input[i]);
+		const udword Pos = Histogram[Data>>LAZY_RADIX_SHIFT]++;
+		Keys[Pos] = Data;
+		Ranks[Pos] = i;
+	}
+	return true;
+}
+
+void LazyRadixSort::SortBucket(udword bucket)
+{
+	const udword Start = mBucketStart[bucket];
+	const udword Nb = mBucketStart[bucket+1] - Start;
+	if(Nb<2)	return;
+
+	udword* Ranks = mRanks + Start;
+	const udword* Keys = mKeys + Start;
+
+	if(Nb<LAZY_RADIX_INTROSORT_LIMIT)
+	{
+		// Indices within a bucket are increasing after the partition, so packing them in the low bits keeps the sort stable
+		uqword Pairs[LAZY_RADIX_INTROSORT_LIMIT];
+		for(udword i=0;i<Nb;i++)
+			Pairs[i] = (uqword(Keys[i])<<32)|Ranks[i];
+
+		IntroSort<uqword> Sorter;
+		Sorter.Sort(Pairs, Nb);
+
+		for(udword i=0;i<Nb;i++)
+			Ranks[i] = udword(Pairs[i]);
+	}
+	else
+	{
+		// Top bits are the same for the whole bucket, only the low ones need sorting
+		udword* Ranks0 = mBucketRanks;
+		udword* Ranks1 = mBucketRanks + mBucketRanksSize;
+		const udword* Sorted = Nb<LAZY_RADIX_8BIT_LIMIT ? SortBucketKeys<8>(Keys, Nb, Ranks0, Ranks1) : SortBucketKeys<11>(Keys, Nb, Ranks0, Ranks1);
+		udword* Tmp = Sorted==Ranks0 ? Ranks1 : Ranks0;
+		for(udword i=0;i<Nb;i++)
+			Tmp[i] = Ranks[Sorted[i]];
+		CopyMemory(Ranks, Tmp, Nb*sizeof(udword));
+	}
+}
+
+void LazyRadixSort::SortUpTo(udword nb)
+{
+	// Buckets are always sorted in order, so the sorted part is a prefix of the ranks
+	while(mNbSorted<nb && mNbSortedBuckets<LAZY_RADIX_NB_BUCKETS)
+	{
+		SortBucket(mNbSortedBuckets++);
+		mNbSorted = mBucketStart[mNbSortedBuckets];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ranks, making sure the first ones are sorted. Use mNb to get the full sorted list.
+ *	\param		nb		[in] number of ranks needed in sorted order
+ *	\return		list of indices, the first nb ones (at least) in sorted order
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+const udword* LazyRadixSort::GetRanks(udword nb)
+{
+	if(nb>mNb)	nb = mNb;
+	if(nb>mNbSorted)	SortUpTo(nb);
+	return mRanks;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword LazyRadixSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(LazyRadixSort);
+	UsedRam += 2*mCurrentSize*sizeof(udword);	// Keys & ranks
+	UsedRam += 2*mBucketRanksSize*sizeof(udword);	// Scratch ranks for the largest bucket
+	return UsedRam;
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a lazy radix sort.
+ *	\file		IceLazyRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICELAZYRADIX_H
+#define ICELAZYRADIX_H
+
+	#define LAZY_RADIX_NB_BITS		11								//!< Width of the top digit used for the partition
+	#define LAZY_RADIX_NB_BUCKETS	(1<<LAZY_RADIX_NB_BITS)
+
+	class LazyRadixSort;
+
+	//! Walks the ranks in sorted order. Buckets are sorted when the iterator reaches them.
+	class ICECORE_API LazyRadixIterator
+	{
+		public:
+		inline_					LazyRadixIterator(LazyRadixSort* sorter, udword index) : mSorter(sorter), mIndex(index)	{}
+
+		inline_	udword			operator*()								const;
+		inline_	LazyRadixIterator&	operator++();
+		inline_	bool			operator==(const LazyRadixIterator& it)	const	{ return mIndex==it.mIndex;	}
+		inline_	bool			operator!=(const LazyRadixIterator& it)	const	{ return mIndex!=it.mIndex;	}
+
+		//! Returns the position in the sorted order.
+		inline_	udword			GetIndex()								const	{ return mIndex;			}
+		private:
+				LazyRadixSort*	mSorter;
+				udword			mIndex;
+	};
+
+	class ICECORE_API LazyRadixSort : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								LazyRadixSort();
+								~LazyRadixSort();
+		// Partitions the values on the top digit. Nothing else is sorted until needed.
+				bool			Init(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				bool			Init(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+
+		// Returns the ranks, with at least the first nb ones in sorted order
+				const udword*	GetRanks(udword nb);
+		// Returns the rank at a given position in the sorted order
+		inline_	udword			GetRank(udword i)
+								{
+									ASSERT(i<mNb);
+									if(i>=mNbSorted)	SortUpTo(i+1);
+									return mRanks[i];
+								}
+
+		// Iteration
+		inline_	LazyRadixIterator	Begin()				{ if(mNb && !mNbSorted) SortUpTo(1);	return LazyRadixIterator(this, 0);	}
+		inline_	LazyRadixIterator	End()				{ return LazyRadixIterator(this, mNb);							}
+
+		// Stats
+		//! Returns the number of values.
+		inline_	udword			GetNbValues()		const	{ return mNb;				}
+		//! Returns the number of values already in sorted order.
+		inline_	udword			GetNbSorted()		const	{ return mNbSorted;			}
+		//! Returns the number of buckets sorted so far.
+		inline_	udword			GetNbSortedBuckets()const	{ return mNbSortedBuckets;	}
+				udword			GetUsedRam()		const;
+
+								PREVENT_COPY(LazyRadixSort)
+		private:
+				udword			mCurrentSize;		//!< Current size of the lists
+				udword*			mRanks;				//!< Indices, grouped by bucket. Sorted up to mNbSorted.
+				udword*			mKeys;				//!< Transformed keys, grouped by bucket
+				udword*			mBucketRanks;		//!< Two scratch rank lists for the radix engines
+				udword			mBucketRanksSize;	//!< Capacity of each scratch list, at least the largest bucket
+				udword			mNb;				//!< Number of values
+				udword			mNbSorted;			//!< Number of ranks in final sorted order
+				udword			mNbSortedBuckets;	//!< Number of buckets sorted so far
+				udword			mBucketStart[LAZY_RADIX_NB_BUCKETS+1];	//!< Start of each bucket in mRanks/mKeys
+		// Internal methods
+				bool			Resize(udword nb);
+		template<class Traits>
+				bool			Partition(const udword* input, udword nb);
+				void			SortBucket(udword bucket);
+				void			SortUpTo(udword nb);
+
+		friend	class			LazyRadixIterator;
+	};
+
+	inline_ udword LazyRadixIterator::operator*() const
+	{
+		ASSERT(mIndex<mSorter->mNbSorted);
+		return mSorter->mRanks[mIndex];
+	}
+
+	inline_ LazyRadixIterator& LazyRadixIterator::operator++()
+	{
+		if(++mIndex==mSorter->mNbSorted && mIndex<mSorter->mNb)
+			mSorter->SortUpTo(mIndex+1);
+		return *this;
+	}
+
+#endif // ICELAZYRADIX_H
@@ -0,0 +1,532 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a NUMA-aware parallel radix sort.
+ *	\file		IceNumaRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A parallel radix sort for multi-socket machines.
+ *
+ *	With a single pool of threads, buffers end up on the node of whichever thread touched them first, and half the
+ *	threads read & scatter across the interconnect on each pass. Here each node has its own pool of threads bound
+ *	to its cores, and its own buffers, allocated and first written by these threads so that they're node-local:
+ *	- partition phase: each node partitions its slice of the input on the top 11 bits, locally,
+ *	- the global histogram gives each node a range of buckets, with about the same number of values,
+ *	- exchange phase: each node copies its buckets from the other nodes. This is the only cross-node traffic: one
+ *	  sequential read of each remote segment, while all writes stay local,
+ *	- each node sorts its values with a ParallelRadixSort running on its own pool, and writes its part of the
+ *	  ranks. The rank buffer is first written there too, so its pages are spread over the nodes.
+ *
+ *	Values are received in node order, and nodes own consecutive slices of the input, so equal keys stay in input
+ *	order: the sort is stable, ranks are the same as RadixSort's. A single bucket can't be split across nodes though,
+ *	so heavily skewed keys can leave a node with most of the work.
+ *
+ *	Small arrays, and machines with a single node, are sorted by the first node's ParallelRadixSort.
+ *
+ *	\class		NumaRadixSort
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#define	TOP_NB_BITS			11
+#define	TOP_SIZE			(1<<TOP_NB_BITS)
+
+// Per-node data. Buffers are only allocated & first written by the node's threads.
+struct IceCore::NumaSortNode
+{
+						NumaSortNode() :
+							mOwner(null), mIndex(0), mExecutor(null), mStart(0), mNb(0), mKeys(null), mIndices(null), mCapacity(0),
+							mFirstBucket(0), mEndBucket(0), mOutStart(0), mOutNb(0), mRecvKeys(null), mRecvIndices(null), mRecvCapacity(0), mLocalRanks(null),
+							mFailed(false)
+						{
+						}
+
+						~NumaSortNode()
+						{
+							ICE_FREE(mRecvIndices);
+							ICE_FREE(mRecvKeys);
+							ICE_FREE(mIndices);
+							ICE_FREE(mKeys);
+						}
+
+	NumaRadixSort*		mOwner;
+	udword				mIndex;
+	SortThreadPool		mPool;				//!< Threads bound to the node, unless the user provides an executor
+	SortExecutor*		mExecutor;			//!< Runs the node's jobs: mPool or the user's executor
+	ParallelRadixSort	mSorter;			//!< Final sort, on mExecutor
+	// Partition phase: slice [mStart, mStart+mNb[ of the input, partitioned on the top digit
+	udword				mStart;
+	udword				mNb;
+	udword*				mKeys;
+	udword*				mIndices;
+	udword				mCapacity;
+	udword				mOffsets[TOP_SIZE+1];	//!< Start of each bucket in mKeys
+	// Exchange phase: buckets [mFirstBucket, mEndBucket[ of all nodes, i.e. ranks [mOutStart, mOutStart+mOutNb[
+	udword				mFirstBucket;
+	udword				mEndBucket;
+	udword				mOutStart;
+	udword				mOutNb;
+	udword*				mRecvKeys;
+	udword*				mRecvIndices;
+	udword				mRecvCapacity;
+	const udword*		mLocalRanks;
+	bool				mFailed;			//!< Out of memory during the current phase
+
+
+	// Size of the segment this node receives from another one
+	inline_	udword		GetSegmentSize(const NumaSortNode& source)	const	{ return source.mOffsets[mEndBucket] - source.mOffsets[mFirstBucket];	}
+
+	inline_	udword		GetNbChunks(udword nb)	const
+	{
+		const udword NbChunks = mExecutor->GetNbThreads() + 1;
+		if(nb/NbChunks>=PARALLEL_RADIX_MIN_CHUNK)
+			return NbChunks;
+		return nb/PARALLEL_RADIX_MIN_CHUNK ? nb/PARALLEL_RADIX_MIN_CHUNK : 1;
+	}
+
+	// Resizes a pair of lists. Old data is discarded.
+	static	bool		Resize(udword*& keys, udword*& indices, udword& capacity, udword nb)
+	{
+		if(nb<=capacity)
+			return true;
+		ICE_FREE(indices);
+		ICE_FREE(keys);
+		capacity = 0;
+		keys	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(keys);
+		indices	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(indices);
+		capacity = nb;
+		return true;
+	}
+};
+
+namespace
+{
+	// Signaled when all the nodes are done with a phase. The calling thread isn't one of the nodes' threads, so it
+	// sleeps instead of helping.
+	struct NodePhaseSync
+	{
+		inline_			NodePhaseSync(udword nb) : mNbPending(nb)	{}
+
+		std::mutex				mMutex;
+		std::condition_variable	mCondition;
+		udword					mNbPending;
+	};
+
+	// Runs a phase on one node's pool
+	class NodePhaseJob : public SortJob
+	{
+		public:
+		virtual	void			Execute()
+								{
+									(mFunction)(mNode, mUserData);
+									// The job & the sync object are gone as soon as the waiting thread sees the counter reach zero
+									std::lock_guard<std::mutex> Lock(mSync->mMutex);
+									if(!--mSync->mNbPending)
+										mSync->mCondition.notify_one();
+								}
+
+				SortTaskFunction	mFunction;
+				void*			mUserData;
+				udword			mNode;
+				NodePhaseSync*	mSync;
+	};
+
+	// Sorts on a node, with the same key type as the main routine
+	inline_	void SortOnNode(ParallelRadixSort& sorter, const udword* input, udword nb, const RadixKeyU32&)	{ sorter.Sort(input, nb, RADIX_UNSIGNED);					}
+	inline_	void SortOnNode(ParallelRadixSort& sorter, const udword* input, udword nb, const RadixKeyS32&)	{ sorter.Sort(input, nb, RADIX_SIGNED);						}
+	inline_	void SortOnNode(ParallelRadixSort& sorter, const udword* input, udword nb, const RadixKeyF32&)	{ sorter.Sort((const float*)input, nb, RADIX_SIGNED);		}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+NumaRadixSort::NumaRadixSort() : mNodes(null), mNbNodes(0), mRanks(null), mCurrentSize(0), mSortedRanks(null), mInput(null), mNb(0), mNbExchanged(0), mTotalCalls(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+NumaRadixSort::~NumaRadixSort()
+{
+	Release();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Starts the node pools, for the topology of the machine.
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaRadixSort::Init()
+{
+	NumaTopology Topology;
+	if(!Topology.Detect())
+		return false;
+	return Init(Topology);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Starts the node pools, for a given topology (e.g. a simulated one). Each node gets one worker per core.
+ *	\param		topology	[in] the topology, copied
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaRadixSort::Init(const NumaTopology& topology)
+{
+	return Init(topology, null);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Runs each node on a user executor, e.g. a part of the application's job system whose threads are already bound
+ *	to that node. Nodes without an executor get their own pool, as above.
+ *	\param		topology		[in] the topology, copied
+ *	\param		node_executors	[in] one executor per node (or null entries), or null. They must outlive the sorter.
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaRadixSort::Init(const NumaTopology& topology, SortExecutor** node_executors)
+{
+	Release();
+
+	if(!topology.GetNbNodes() || !mTopology.Copy(topology))
+		return false;
+
+	mNodes = new NumaSortNode[topology.GetNbNodes()];
+	CHECKALLOC(mNodes);
+	mNbNodes = topology.GetNbNodes();
+
+	for(udword i=0;i<mNbNodes;i++)
+	{
+		NumaSortNode& Node = mNodes[i];
+		Node.mOwner = this;
+		Node.mIndex = i;
+		Node.mExecutor = node_executors ? node_executors[i] : null;
+		if(!Node.mExecutor)
+		{
+			if(!Node.mPool.Init(mTopology.GetNbCpus(i), BindWorker, &Node))
+			{
+				Release();
+				return false;
+			}
+			Node.mExecutor = &Node.mPool;
+		}
+		Node.mSorter.SetExecutor(Node.mExecutor);
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Stops the node pools and frees all buffers.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void NumaRadixSort::Release()
+{
+	DELETEARRAY(mNodes);
+	mNbNodes = 0;
+	ICE_FREE(mRanks);
+	mCurrentSize = 0;
+	mSortedRanks = null;
+	mTopology.Release();
+}
+
+void NumaRadixSort::BindWorker(udword, void* user_data)
+{
+	const NumaSortNode* Node = reinterpret_cast<const NumaSortNode*>(user_data);
+	Node->mOwner->mTopology.BindThread(Node->mIndex);
+}
+
+// Runs a function on each node, on one of the node's threads, and returns when all nodes are done
+bool NumaRadixSort::RunOnNodes(SortTaskFunction function)
+{
+	NodePhaseJob Jobs[64];
+	NodePhaseJob* NodeJobs = mNbNodes<=64 ? Jobs : new NodePhaseJob[mNbNodes];
+
+	NodePhaseSync Sync(mNbNodes);
+	for(udword i=0;i<mNbNodes;i++)
+	{
+		mNodes[i].mFailed		= false;
+		NodeJobs[i].mFunction	= function;
+		NodeJobs[i].mUserData	= this;
+		NodeJobs[i].mNode		= i;
+		NodeJobs[i].mSync		= &Sync;
+		mNodes[i].mExecutor->Submit(&NodeJobs[i]);
+	}
+
+	{
+		std::unique_lock<std::mutex> Lock(Sync.mMutex);
+		while(Sync.mNbPending)
+			Sync.mCondition.wait(Lock);
+	}
+
+	if(NodeJobs!=Jobs)
+		DELETEARRAY(NodeJobs);
+
+	for(udword i=0;i<mNbNodes;i++)
+	{
+		if(mNodes[i].mFailed)
+			return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of integer values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_SIGNED to handle negative values, RADIX_UNSIGNED if you know your input buffer only contains positive values.
+ *	\return		true if success. On failure (out of memory), GetRanks() returns null.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaRadixSort::Sort(const udword* input, udword nb, const RadixHints& hints)
+{
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU32>(input, nb, hints);
+	else					return SortKeys<RadixKeyS32>(input, nb, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for floating-point values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of floating-point values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_POSITIVE if you know all values are positive
+ *	\return		true if success. On failure (out of memory), GetRanks() returns null.
+ *	\warning	only sorts IEEE floating-point values
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaRadixSort::Sort(const float* input, udword nb, const RadixHints& hints)
+{
+	if(hints.mFlags & RADIX_POSITIVE)	return SortKeys<RadixKeyU32>((const udword*)input, nb, hints);
+	else								return SortKeys<RadixKeyF32>((const udword*)input, nb, hints);
+}
+
+template<class Traits>
+bool NumaRadixSort::SortKeys(const udword* input, udword nb, const RadixHints& hints)
+{
+	// Ranks of a previous call are gone, whatever happens next
+	mSortedRanks = null;
+
+	// Checkings
+	if(!nb)						return true;
+	if(!input)					return false;
+	if(!mNbNodes && !Init())	return false;
+
+	// Stats
+	mTotalCalls++;
+	mNbExchanged = 0;
+
+	mInput = input;
+	mNb = nb;
+
+	if(mNbNodes==1 || nb<NUMA_RADIX_MIN_NB)
+	{
+		for(udword i=0;i<mNbNodes;i++)
+			mNodes[i].mOutNb = 0;
+		mNodes[0].mOutNb = nb;
+		if(!RunOnNodes(SingleNodePhase<Traits>))
+			return false;
+		mSortedRanks = mNodes[0].mSorter.GetRanks();
+		return true;
+	}
+
+	// The rank buffer is only allocated here, pages are touched by the nodes writing their ranks
+	if(nb>mCurrentSize)
+	{
+		ICE_FREE(mRanks);
+		mCurrentSize = 0;
+		mRanks = (udword*)ICE_ALLOC(sizeof(udword)*nb);
+		if(!mRanks)	return false;
+		mCurrentSize = nb;
+	}
+
+	for(udword i=0;i<mNbNodes;i++)
+	{
+		mNodes[i].mStart = udword((uqword(nb)*i)/mNbNodes);
+		mNodes[i].mNb = udword((uqword(nb)*(i+1))/mNbNodes) - mNodes[i].mStart;
+	}
+	if(!RunOnNodes(PartitionPhase<Traits>))
+		return false;
+
+	// Give each node a range of buckets with about nb/mNbNodes values. A bucket goes to the node holding its middle.
+	udword Bucket = 0;
+	udword Sum = 0;
+	for(udword i=0;i<mNbNodes;i++)
+	{
+		NumaSortNode& Node = mNodes[i];
+		const uqword Target = (uqword(nb)*(i+1))/mNbNodes;
+		Node.mFirstBucket = Bucket;
+		Node.mOutStart = Sum;
+		while(Bucket<TOP_SIZE)
+		{
+			udword Size = 0;
+			for(udword j=0;j<mNbNodes;j++)
+				Size += mNodes[j].mOffsets[Bucket+1] - mNodes[j].mOffsets[Bucket];
+			if(i!=mNbNodes-1 && Sum + Size/2>=Target)
+				break;
+			Sum += Size;
+			Bucket++;
+		}
+		Node.mEndBucket = Bucket;
+		Node.mOutNb = Sum - Node.mOutStart;
+		mNbExchanged += Node.mOutNb - Node.GetSegmentSize(Node);
+	}
+
+	if(!RunOnNodes(ExchangePhase))
+		return false;
+
+	mSortedRanks = mRanks;
+	return true;
+}
+
+template<class Traits>
+void NumaRadixSort::SingleNodePhase(udword node, void* user_data)
+{
+	if(node)	return;
+	NumaRadixSort* Owner = reinterpret_cast<NumaRadixSort*>(user_data);
+	NumaSortNode& Node = Owner->mNodes[0];
+	SortOnNode(Node.mSorter, Owner->mInput, Owner->mNb, Traits());
+	Node.mFailed = !Node.mSorter.GetRanks();
+}
+
+template<class Traits>
+void NumaRadixSort::PartitionPhase(udword node, void* user_data)
+{
+	NumaRadixSort* Owner = reinterpret_cast<NumaRadixSort*>(user_data);
+	NumaSortNode& Node = Owner->mNodes[node];
+
+	// A node out of memory partitions nothing, the sort fails after the phase
+	udword Sizes[TOP_SIZE];
+	ZeroMemory(Sizes, sizeof(Sizes));
+	Node.mFailed = !NumaSortNode::Resize(Node.mKeys, Node.mIndices, Node.mCapacity, Node.mNb);
+	if(Node.mNb && !Node.mFailed)
+	{
+		ParallelRadixPartition<Traits>(Node.mExecutor, Owner->mInput + Node.mStart, null, Node.mStart, Node.mKeys, Node.mIndices,
+										Node.mNb, 32 - TOP_NB_BITS, TOP_NB_BITS, Sizes, false);
+	}
+
+	Node.mOffsets[0] = 0;
+	for(udword i=0;i<TOP_SIZE;i++)
+		Node.mOffsets[i+1] = Node.mOffsets[i] + Sizes[i];
+}
+
+// Copies a part of the segment received from a node. Item index = source node * nb chunks + chunk.
+void NumaRadixSort::ExchangeJob(udword index, void* user_data)
+{
+	const NumaSortNode& Node = *reinterpret_cast<const NumaSortNode*>(user_data);
+	const NumaRadixSort* Owner = Node.mOwner;
+	const udword NbChunks = Node.GetNbChunks(Node.mOutNb);
+	const udword SourceIndex = index / NbChunks;
+	const udword Chunk = index % NbChunks;
+
+	// Segments are stored in node order
+	udword Dest = 0;
+	for(udword i=0;i<SourceIndex;i++)
+		Dest += Node.GetSegmentSize(Owner->mNodes[i]);
+
+	const NumaSortNode& Source = Owner->mNodes[SourceIndex];
+	const udword Nb = Node.GetSegmentSize(Source);
+	const udword Start = udword((uqword(Nb)*Chunk)/NbChunks);
+	const udword End = udword((uqword(Nb)*(Chunk+1))/NbChunks);
+	const udword SrcOffset = Source.mOffsets[Node.mFirstBucket] + Start;
+	CopyMemory(Node.mRecvKeys + Dest + Start, Source.mKeys + SrcOffset, (End - Start)*sizeof(udword));
+	CopyMemory(Node.mRecvIndices + Dest + Start, Source.mIndices + SrcOffset, (End - Start)*sizeof(udword));
+}
+
+// Writes a part of the node's ranks
+void NumaRadixSort::OutputJob(udword index, void* user_data)
+{
+	const NumaSortNode& Node = *reinterpret_cast<const NumaSortNode*>(user_data);
+	const udword NbChunks = Node.GetNbChunks(Node.mOutNb);
+	const udword Start = udword((uqword(Node.mOutNb)*index)/NbChunks);
+	const udword End = udword((uqword(Node.mOutNb)*(index+1))/NbChunks);
+
+	udword* Ranks = Node.mOwner->mRanks + Node.mOutStart;
+	const udword* LocalRanks = Node.mLocalRanks;
+	const udword* Indices = Node.mRecvIndices;
+	for(udword i=Start;i<End;i++)
+		Ranks[i] = Indices[LocalRanks[i]];
+}
+
+void NumaRadixSort::ExchangePhase(udword node, void* user_data)
+{
+	NumaRadixSort* Owner = reinterpret_cast<NumaRadixSort*>(user_data);
+	NumaSortNode& Node = Owner->mNodes[node];
+	const udword Nb = Node.mOutNb;
+	if(!Nb)
+		return;
+
+	if(!NumaSortNode::Resize(Node.mRecvKeys, Node.mRecvIndices, Node.mRecvCapacity, Nb))
+	{
+		Node.mFailed = true;
+		return;
+	}
+
+	const udword NbChunks = Node.GetNbChunks(Nb);
+	Node.mExecutor->ParallelFor(Owner->mNbNodes*NbChunks, ExchangeJob, &Node);
+
+	// Keys are already sortable
+	Node.mSorter.Sort(Node.mRecvKeys, Nb, RADIX_UNSIGNED);
+	Node.mLocalRanks = Node.mSorter.GetRanks();
+	if(!Node.mLocalRanks)
+	{
+		Node.mFailed = true;
+		return;
+	}
+
+	Node.mExecutor->ParallelFor(NbChunks, OutputJob, &Node);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Returns the number of values sorted by a node during the last call.
+ *	\param		node	[in] node index
+ *	\return		number of values
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword NumaRadixSort::GetNodeSize(udword node) const
+{
+	return node<mNbNodes ? mNodes[node].mOutNb : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword NumaRadixSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(NumaRadixSort);
+	UsedRam += mCurrentSize*sizeof(udword);			// Ranks
+	for(udword i=0;i<mNbNodes;i++)
+	{
+		const NumaSortNode& Node = mNodes[i];
+		UsedRam += sizeof(NumaSortNode);
+		UsedRam += 2*Node.mCapacity*sizeof(udword);		// Partitioned keys & indices
+		UsedRam += 2*Node.mRecvCapacity*sizeof(udword);	// Received keys & indices
+		UsedRam += Node.mSorter.GetUsedRam() - sizeof(ParallelRadixSort);
+	}
+	return UsedRam;
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a NUMA-aware parallel radix sort.
+ *	\file		IceNumaRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICENUMARADIX_H
+#define ICENUMARADIX_H
+
+	#define NUMA_RADIX_MIN_NB	262144	// Smaller arrays are sorted by the first node only
+
+	struct NumaSortNode;
+
+	class ICECORE_API NumaRadixSort : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								NumaRadixSort();
+								~NumaRadixSort();
+
+		// Starts one pool of bound worker threads per node. Sort() calls Init() with the detected topology if needed.
+				bool			Init();
+				bool			Init(const NumaTopology& topology);
+		// Same, with the user's executors for some or all nodes
+				bool			Init(const NumaTopology& topology, SortExecutor** node_executors);
+				void			Release();
+
+		// Sorting methods. They return false if a node ran out of memory, ranks are then not available.
+				bool			Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				bool			Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+
+		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data. Null if the last sort failed.
+		inline_	const udword*	GetRanks()			const	{ return mSortedRanks;	}
+
+		// Stats
+				udword			GetUsedRam()		const;
+		//! Returns the total number of calls to the radix sorter.
+		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
+		//! Returns the number of nodes.
+		inline_	udword			GetNbNodes()		const	{ return mNbNodes;		}
+		//! Returns the number of values sorted by a node during the last call.
+				udword			GetNodeSize(udword node)	const;
+		//! Returns the number of values sent to another node during the last call.
+		inline_	udword			GetNbExchanged()	const	{ return mNbExchanged;	}
+
+								PREVENT_COPY(NumaRadixSort)
+		private:
+				NumaTopology	mTopology;
+				NumaSortNode*	mNodes;
+				udword			mNbNodes;
+				udword*			mRanks;				//!< Sorted ranks, each node writes its part first
+				udword			mCurrentSize;
+				const udword*	mSortedRanks;		//!< Ranks from the last call
+				const udword*	mInput;				//!< Input of the current call
+				udword			mNb;
+				udword			mNbExchanged;
+		// Stats
+				udword			mTotalCalls;		//!< Total number of calls to the sort routine
+		// Internal methods
+		template<class Traits>
+				bool			SortKeys(const udword* input, udword nb, const RadixHints& hints);
+				bool			RunOnNodes(SortTaskFunction function);
+		template<class Traits>
+		static	void			PartitionPhase(udword node, void* user_data);
+		static	void			ExchangePhase(udword node, void* user_data);
+		template<class Traits>
+		static	void			SingleNodePhase(udword node, void* user_data);
+		static	void			ExchangeJob(udword index, void* user_data);
+		static	void			OutputJob(udword index, void* user_data);
+		static	void			BindWorker(udword index, void* user_data);
+	};
+
+#endif // ICENUMARADIX_H
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains the NUMA topology of the machine.
+ *	\file		IceNumaTopology.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	NUMA nodes and their cores, as seen by the OS:
+ *	- on Windows, from GetNumaHighestNodeNumber / GetNumaNodeProcessorMask (first processor group only),
+ *	- on Linux, from libnuma when ICE_USE_LIBNUMA is defined (link with -lnuma), else from sysfs
+ *	  (/sys/devices/system/node/online and nodeN/cpulist).
+ *
+ *	Nodes without cores (memory-only nodes) are skipped. Memory is allocated on the node of the thread that touches it
+ *	first, so code running on threads bound with BindThread() gets node-local buffers by writing them first.
+ *
+ *	Simulate() creates a fake topology, with threads left unbound, so that NUMA code paths can be tested anywhere.
+ *
+ *	\class		NumaTopology
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#elif defined(ICE_USE_LIBNUMA)
+	#include <numa.h>
+#elif LINUX
+	#include <sched.h>
+#endif
+
+using namespace IceCore;
+
+#define NUMA_MAX_NODES	64
+#define NUMA_MAX_CPUS	1024
+
+namespace
+{
+	// Topology read from the OS
+	struct NodeList
+	{
+		udword	mNbNodes;
+		udword	mNbCpus;
+		udword	mIDs[NUMA_MAX_NODES];
+		udword	mNodeStart[NUMA_MAX_NODES+1];
+		udword	mCpus[NUMA_MAX_CPUS];
+
+		inline_	void	Init()	{ mNbNodes = mNbCpus = 0; mNodeStart[0] = 0;	}
+
+		inline_	void	AddCpu(udword cpu)
+		{
+			if(mNbCpus<NUMA_MAX_CPUS)
+				mCpus[mNbCpus++] = cpu;
+		}
+
+		// Ends the current node, dropped if it has no core
+		inline_	void	AddNode(udword id)
+		{
+			if(mNbCpus==mNodeStart[mNbNodes] || mNbNodes==NUMA_MAX_NODES)
+				return;
+			mIDs[mNbNodes++] = id;
+			mNodeStart[mNbNodes] = mNbCpus;
+		}
+	};
+
+#if defined(_WIN32)
+
+	bool ReadTopology(NodeList& list)
+	{
+		ULONG HighestNode;
+		if(!GetNumaHighestNodeNumber(&HighestNode))
+			return false;
+
+		for(ULONG Node=0;Node<=HighestNode;Node++)
+		{
+			ULONGLONG Mask;
+			if(!GetNumaNodeProcessorMask(UCHAR(Node), &Mask))
+				continue;
+			for(udword i=0;i<64;i++)
+				if(Mask & (ULONGLONG(1)<<i))
+					list.AddCpu(i);
+			list.AddNode(Node);
+		}
+		return list.mNbNodes!=0;
+	}
+
+	bool BindCurrentThread(udword, const udword* cpus, udword nb_cpus)
+	{
+		DWORD_PTR Mask = 0;
+		for(udword i=0;i<nb_cpus;i++)
+			if(cpus[i]<sizeof(DWORD_PTR)*8)
+				Mask |= DWORD_PTR(1)<<cpus[i];
+		return Mask && SetThreadAffinityMask(GetCurrentThread(), Mask)!=0;
+	}
+
+#elif defined(ICE_USE_LIBNUMA)
+
+	bool ReadTopology(NodeList& list)
+	{
+		if(numa_available()<0)
+			return false;
+
+		const int NbNodes = numa_max_node() + 1;
+		const int NbCpus = numa_num_configured_cpus();
+		struct bitmask* Mask = numa_allocate_cpumask();
+		if(!Mask)
+			return false;
+
+		for(int Node=0;Node<NbNodes;Node++)
+		{
+			if(numa_node_to_cpus(Node, Mask)<0)
+				continue;
+			for(int i=0;i<NbCpus;i++)
+				if(numa_bitmask_isbitset(Mask, i))
+					list.AddCpu(i);
+			list.AddNode(Node);
+		}
+		numa_free_cpumask(Mask);
+		return list.mNbNodes!=0;
+	}
+
+	bool BindCurrentThread(udword node_id, const udword*, udword)
+	{
+		return numa_run_on_node(node_id)==0;
+	}
+
+#elif LINUX
+
+	bool ReadFile(const char* filename, char* buffer, udword size)
+	{
+		FILE* fp = fopen(filename, "r");
+		if(!fp)
+			return false;
+		const size_t Size = fread(buffer, 1, size-1, fp);
+		fclose(fp);
+		buffer[Size] = 0;
+		return true;
+	}
+
+	// Parses a sysfs list such as "0-3,8-11"
+	template<class Function>
+	void ParseList(const char* text, Function function)
+	{
+		while(*text)
+		{
+			if(*text<'0' || *text>'9')
+			{
+				text++;
+				continue;
+			}
+			char* End;
+			const udword First = udword(strtoul(text, &End, 10));
+			udword Last = First;
+			if(*End=='-')
+				Last = udword(strtoul(End+1, &End, 10));
+			for(udword i=First;i<=Last && i<NUMA_MAX_CPUS;i++)
+				function(i);
+			text = End;
+		}
+	}
+
+	struct AddCpu
+	{
+		NodeList*	mList;
+		void		operator()(udword cpu)	const	{ mList->AddCpu(cpu);	}
+	};
+
+	struct AddNodeID
+	{
+		udword*		mIDs;
+		udword*		mNb;
+		void		operator()(udword id)	const	{ if(*mNb<NUMA_MAX_NODES)	mIDs[(*mNb)++] = id;	}
+	};
+
+	bool ReadTopology(NodeList& list)
+	{
+		char Buffer[4096];
+		if(!ReadFile("/sys/devices/system/node/online", Buffer, sizeof(Buffer)))
+			return false;
+
+		udword NodeIDs[NUMA_MAX_NODES];
+		udword NbNodes = 0;
+		const AddNodeID AddID = { NodeIDs, &NbNodes };
+		ParseList(Buffer, AddID);
+
+		for(udword i=0;i<NbNodes;i++)
+		{
+			char Filename[256];
+			sprintf(Filename, "/sys/devices/system/node/node%u/cpulist", NodeIDs[i]);
+			if(!ReadFile(Filename, Buffer, sizeof(Buffer)))
+				continue;
+			const AddCpu Add = { &list };
+			ParseList(Buffer, Add);
+			list.AddNode(NodeIDs[i]);
+		}
+		return list.mNbNodes!=0;
+	}
+
+	bool BindCurrentThread(udword, const udword* cpus, udword nb_cpus)
+	{
+		cpu_set_t Set;
+		CPU_ZERO(&Set);
+		for(udword i=0;i<nb_cpus;i++)
+			CPU_SET(cpus[i], &Set);
+		return sched_setaffinity(0, sizeof(Set), &Set)==0;
+	}
+
+#else
+
+	bool ReadTopology(NodeList&)								{ return false;	}
+	bool BindCurrentThread(udword, const udword*, udword)		{ return false;	}
+
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+NumaTopology::NumaTopology() : mNbNodes(0), mNodeStart(null), mCpus(null), mNodeIDs(null), mCanBind(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+NumaTopology::~NumaTopology()
+{
+	Release();
+}
+
+void NumaTopology::Release()
+{
+	ICE_FREE(mNodeIDs);
+	ICE_FREE(mCpus);
+	ICE_FREE(mNodeStart);
+	mNbNodes = 0;
+	mCanBind = false;
+}
+
+bool NumaTopology::Setup(udword nb_nodes, udword nb_cpus)
+{
+	Release();
+	mNodeStart	= (udword*)ICE_ALLOC(sizeof(udword)*(nb_nodes+1));	CHECKALLOC(mNodeStart);
+	mCpus		= (udword*)ICE_ALLOC(sizeof(udword)*nb_cpus);		CHECKALLOC(mCpus);
+	mNodeIDs	= (udword*)ICE_ALLOC(sizeof(udword)*nb_nodes);		CHECKALLOC(mNodeIDs);
+	mNbNodes = nb_nodes;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Reads the topology from the OS. When that fails, or on unknown platforms, the machine is seen as a single node.
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaTopology::Detect()
+{
+	NodeList List;
+	List.Init();
+	if(!ReadTopology(List))
+	{
+		const udword NbCores = std::thread::hardware_concurrency();
+		return Simulate(1, NbCores ? NbCores : 1);
+	}
+
+	if(!Setup(List.mNbNodes, List.mNbCpus))
+		return false;
+	CopyMemory(mNodeStart, List.mNodeStart, sizeof(udword)*(List.mNbNodes+1));
+	CopyMemory(mCpus, List.mCpus, sizeof(udword)*List.mNbCpus);
+	CopyMemory(mNodeIDs, List.mIDs, sizeof(udword)*List.mNbNodes);
+	mCanBind = true;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Creates a fake topology. Cores are numbered from 0, node after node.
+ *	\param		nb_nodes			[in] number of nodes
+ *	\param		nb_cpus_per_node	[in] number of cores per node
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaTopology::Simulate(udword nb_nodes, udword nb_cpus_per_node)
+{
+	if(!nb_nodes || !nb_cpus_per_node)
+		return false;
+
+	if(!Setup(nb_nodes, nb_nodes*nb_cpus_per_node))
+		return false;
+
+	for(udword i=0;i<nb_nodes;i++)
+	{
+		mNodeStart[i] = i*nb_cpus_per_node;
+		mNodeIDs[i] = i;
+	}
+	mNodeStart[nb_nodes] = nb_nodes*nb_cpus_per_node;
+	for(udword i=0;i<nb_nodes*nb_cpus_per_node;i++)
+		mCpus[i] = i;
+	mCanBind = false;
+	return true;
+}
+
+bool NumaTopology::Copy(const NumaTopology& topology)
+{
+	if(&topology==this)
+		return true;
+
+	const udword NbNodes = topology.mNbNodes;
+	if(!NbNodes)
+	{
+		Release();
+		return true;
+	}
+
+	if(!Setup(NbNodes, topology.mNodeStart[NbNodes]))
+		return false;
+	CopyMemory(mNodeStart, topology.mNodeStart, sizeof(udword)*(NbNodes+1));
+	CopyMemory(mCpus, topology.mCpus, sizeof(udword)*topology.mNodeStart[NbNodes]);
+	CopyMemory(mNodeIDs, topology.mNodeIDs, sizeof(udword)*NbNodes);
+	mCanBind = topology.mCanBind;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Binds the calling thread to the cores of a node.
+ *	\param		node	[in] node index, from 0 to GetNbNodes()-1
+ *	\return		true if success, false if the topology can't be bound to (see CanBind()) or if the OS refused
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool NumaTopology::BindThread(udword node) const
+{
+	if(!mCanBind || node>=mNbNodes)
+		return false;
+	return BindCurrentThread(mNodeIDs[node], GetCpus(node), GetNbCpus(node));
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains the NUMA topology of the machine.
+ *	\file		IceNumaTopology.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICENUMATOPOLOGY_H
+#define ICENUMATOPOLOGY_H
+
+	class ICECORE_API NumaTopology : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								NumaTopology();
+								~NumaTopology();
+
+		// Reads the topology from the OS. Falls back to a single node with all the cores.
+				bool			Detect();
+		// Fake topology, e.g. to test NUMA code paths on a single node. Threads are not bound to any core.
+				bool			Simulate(udword nb_nodes, udword nb_cpus_per_node);
+		// Copies another topology
+				bool			Copy(const NumaTopology& topology);
+				void			Release();
+
+		//! Returns the number of nodes with at least one core.
+		inline_	udword			GetNbNodes()				const	{ return mNbNodes;								}
+		//! Returns the number of cores of a node.
+		inline_	udword			GetNbCpus(udword node)		const	{ return mNodeStart[node+1] - mNodeStart[node];	}
+		//! Returns the cores of a node.
+		inline_	const udword*	GetCpus(udword node)		const	{ return mCpus + mNodeStart[node];				}
+		//! Checks whether threads can be bound to the nodes. False for simulated topologies & unknown platforms.
+		inline_	bool			CanBind()					const	{ return mCanBind;								}
+
+		// Binds the calling thread to the cores of a node. Memory it touches first is then allocated on that node.
+				bool			BindThread(udword node)		const;
+
+								PREVENT_COPY(NumaTopology)
+		private:
+				udword			mNbNodes;
+				udword*			mNodeStart;		//!< First core of each node in mCpus, plus the total number of cores
+				udword*			mCpus;			//!< Cores, sorted by node
+				udword*			mNodeIDs;		//!< OS node numbers
+				bool			mCanBind;
+		// Internal methods
+				bool			Setup(udword nb_nodes, udword nb_cpus);
+	};
+
+#endif // ICENUMATOPOLOGY_H
@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a parallel MSD radix sort.
+ *	\file		IceParallelRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A parallel radix sort, MSD first then LSD.
+ *
+ *	Running LSD passes on several threads still moves all the data through memory on each pass. Here:
+ *	- the top 10 bits are used to partition the keys in 1024 buckets, in parallel: each thread counts its own chunk,
+ *	  then scatters it to its own offsets, so the partition is stable,
+ *	- each bucket is then sorted on its own by one thread, with the 11-bit LSD kernels of RadixSort3. Buckets are
+ *	  small, so these passes mostly run in cache. 10 + 2*11 bits = 32, i.e. 3 passes over the data in total.
+ *	- skewed data (e.g. Zipf distributions) can put most values in a few buckets. Buckets larger than their share
+ *	  of the work are partitioned again in parallel, on the next 11 bits, and so on. Digits where all the bucket's
+ *	  values are the same are skipped without moving anything, so a single hot key costs one counting pass per
+ *	  level, and its ranks are copied in parallel.
+ *
+ *	Buckets are picked up by the executor's workers as they become idle, and nested partitions go to the deques of the
+ *	workers running them, where idle workers steal them.
+ *
+ *	The sort is stable, so ranks are the same as RadixSort's. There's no temporal coherence: this is meant for large
+ *	arrays of fresh data. Memory: 5 lists of nb dwords (ranks, 2 x keys, 2 x indices).
+ *
+ *	\class		ParallelRadixSort
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#define	TOP_NB_BITS			10		// First partition
+#define	RADIX_NB_BITS		11		// Next partitions & LSD passes
+#define	RADIX_SIZE			(1<<RADIX_NB_BITS)
+
+typedef RadixEngine<RadixKeyU32, RADIX_NB_BITS>	BucketEngine;
+
+namespace
+{
+	// One parallel partition of a range, on one digit
+	struct PartitionContext
+	{
+		const udword*	mSrcKeys;		//!< Input values at the first level, sortable keys after that
+		const udword*	mSrcIndices;	//!< Null at the first level, indices are implicit
+		udword			mBaseIndex;		//!< First implicit index
+		udword*			mDstKeys;
+		udword*			mDstIndices;
+		udword			mNb;
+		udword			mShift;
+		udword			mMask;
+		udword			mNbChunks;
+		udword*			mCounters;		//!< RADIX_SIZE counters per chunk, turned into offsets before scattering
+	};
+
+	inline_ udword GetChunkStart(const PartitionContext* context, udword chunk)
+	{
+		return udword((uqword(context->mNb)*chunk)/context->mNbChunks);
+	}
+
+	template<class Traits>
+	void CountJob(udword chunk, void* user_data)
+	{
+		const PartitionContext* Context = reinterpret_cast<const PartitionContext*>(user_data);
+		udword* Counters = Context->mCounters + chunk*RADIX_SIZE;
+		ZeroMemory(Counters, RADIX_SIZE*sizeof(udword));
+
+		const udword Shift = Context->mShift;
+		const udword Mask = Context->mMask;
+		const udword* Keys = Context->mSrcKeys;
+		const udword End = GetChunkStart(Context, chunk+1);
+		for(udword i=GetChunkStart(Context, chunk);i<End;i++)
+			Counters[(Traits::ToSortable(Keys[i])>>Shift) & Mask]++;
+	}
+
+	template<class Traits>
+	void ScatterJob(udword chunk, void* user_data)
+	{
+		const PartitionContext* Context = reinterpret_cast<const PartitionContext*>(user_data);
+		udword* Offsets = Context->mCounters + chunk*RADIX_SIZE;
+
+		const udword Shift = Context->mShift;
+		const udword Mask = Context->mMask;
+		const udword* Keys = Context->mSrcKeys;
+		const udword* Indices = Context->mSrcIndices;
+		udword* DstKeys = Context->mDstKeys;
+		udword* DstIndices = Context->mDstIndices;
+		const udword End = GetChunkStart(Context, chunk+1);
+		for(udword i=GetChunkStart(Context, chunk);i<End;i++)
+		{
+			const udword Key = Traits::ToSortable(Keys[i]);
+			const udword Pos = Offsets[(Key>>Shift) & Mask]++;
+			DstKeys[Pos] = Key;
+			DstIndices[Pos] = Indices ? Indices[i] : Context->mBaseIndex + i;
+		}
+	}
+
+	struct BucketContext
+	{
+		ParallelRadixSort*	mSorter;
+		const udword*		mStarts;		//!< Start of each bucket
+		udword				mShift;
+		udword				mCurrent;
+	};
+
+	struct CopyContext
+	{
+		udword*				mDst;
+		const udword*		mSrc;
+		udword				mNb;
+		udword				mNbChunks;
+	};
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Stable parallel partition of nb values on one digit. Each chunk of values is counted and scattered by one thread.
+ *	\param		executor	[in] executor running the chunks
+ *	\param		src_keys	[in] values to partition, converted with Traits::ToSortable
+ *	\param		src_indices	[in] indices of these values, or null for implicit indices (base_index + i)
+ *	\param		base_index	[in] first implicit index
+ *	\param		dst_keys	[out] partitioned sortable keys
+ *	\param		dst_indices	[out] partitioned indices
+ *	\param		nb			[in] number of values
+ *	\param		shift		[in] first bit of the digit
+ *	\param		nb_bits		[in] number of bits of the digit, up to 11
+ *	\param		sizes		[out] 1<<nb_bits bucket sizes
+ *	\param		skip		[in] true to skip the scatter when all values fall in the same bucket
+ *	\return		false if the scatter has been skipped
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class Traits>
+bool IceCore::ParallelRadixPartition(SortExecutor* executor, const udword* src_keys, const udword* src_indices, udword base_index, udword* dst_keys, udword* dst_indices,
+									udword nb, udword shift, udword nb_bits, udword* sizes, bool skip)
+{
+	udword NbChunks = executor->GetNbThreads() + 1;
+	if(nb/NbChunks<PARALLEL_RADIX_MIN_CHUNK)
+		NbChunks = nb/PARALLEL_RADIX_MIN_CHUNK ? nb/PARALLEL_RADIX_MIN_CHUNK : 1;
+
+	PartitionContext Context;
+	Context.mSrcKeys	= src_keys;
+	Context.mSrcIndices	= src_indices;
+	Context.mBaseIndex	= base_index;
+	Context.mDstKeys	= dst_keys;
+	Context.mDstIndices	= dst_indices;
+	Context.mNb			= nb;
+	Context.mShift		= shift;
+	Context.mMask		= (1<<nb_bits)-1;
+	Context.mNbChunks	= NbChunks;
+	Context.mCounters	= reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*RADIX_SIZE*NbChunks));
+	if(!Context.mCounters)
+	{
+		// Can't go wrong with one chunk
+		udword Counters[RADIX_SIZE];
+		Context.mNbChunks	= 1;
+		Context.mCounters	= Counters;
+		CountJob<Traits>(0, &Context);
+		CopyMemory(sizes, Counters, sizeof(udword)<<nb_bits);
+		if(skip)
+		{
+			for(udword i=0;i<=Context.mMask;i++)
+				if(sizes[i]==nb)	return false;
+		}
+		udword Offset = 0;
+		for(udword i=0;i<=Context.mMask;i++)
+		{
+			Counters[i] = Offset;
+			Offset += sizes[i];
+		}
+		ScatterJob<Traits>(0, &Context);
+		return true;
+	}
+
+	executor->ParallelFor(NbChunks, CountJob<Traits>, &Context);
+
+	for(udword i=0;i<=Context.mMask;i++)
+	{
+		udword Size = 0;
+		for(udword j=0;j<NbChunks;j++)
+			Size += Context.mCounters[j*RADIX_SIZE + i];
+		sizes[i] = Size;
+		if(skip && Size==nb)
+		{
+			ICE_FREE(Context.mCounters);
+			return false;
+		}
+	}
+
+	// Each chunk writes its values after the same bucket's values from previous chunks
+	udword Offset = 0;
+	for(udword i=0;i<=Context.mMask;i++)
+	{
+		for(udword j=0;j<NbChunks;j++)
+		{
+			const udword Count = Context.mCounters[j*RADIX_SIZE + i];
+			Context.mCounters[j*RADIX_SIZE + i] = Offset;
+			Offset += Count;
+		}
+	}
+
+	executor->ParallelFor(NbChunks, ScatterJob<Traits>, &Context);
+	ICE_FREE(Context.mCounters);
+	return true;
+}
+
+// Key types used by the sorters
+template bool IceCore::ParallelRadixPartition<RadixKeyU32>(SortExecutor*, const udword*, const udword*, udword, udword*, udword*, udword, udword, udword, udword*, bool);
+template bool IceCore::ParallelRadixPartition<RadixKeyS32>(SortExecutor*, const udword*, const udword*, udword, udword*, udword*, udword, udword, udword, udword*, bool);
+template bool IceCore::ParallelRadixPartition<RadixKeyF32>(SortExecutor*, const udword*, const udword*, udword, udword*, udword*, udword, udword, udword, udword*, bool);
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ParallelRadixSort::ParallelRadixSort() : mCurrentSize(0), mRanks(null), mExecutor(null), mSplitSize(0), mTotalCalls(0), mNbSplits(0)
+{
+	mKeys[0] = mKeys[1] = null;
+	mIndices[0] = mIndices[1] = null;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ParallelRadixSort::~ParallelRadixSort()
+{
+	ICE_FREE(mIndices[1]);
+	ICE_FREE(mIndices[0]);
+	ICE_FREE(mKeys[1]);
+	ICE_FREE(mKeys[0]);
+	ICE_FREE(mRanks);
+}
+
+bool ParallelRadixSort::CheckResize(udword nb)
+{
+	if(nb<=mCurrentSize)	return true;
+
+	ICE_FREE(mIndices[1]);
+	ICE_FREE(mIndices[0]);
+	ICE_FREE(mKeys[1]);
+	ICE_FREE(mKeys[0]);
+	ICE_FREE(mRanks);
+	mCurrentSize = 0;
+
+	// Ranks last, so that GetRanks() returns null if any allocation failed
+	mKeys[0]	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mKeys[0]);
+	mKeys[1]	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mKeys[1]);
+	mIndices[0]	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mIndices[0]);
+	mIndices[1]	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mIndices[1]);
+	mRanks		= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks);
+	mCurrentSize = nb;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of integer values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_SIGNED to handle negative values, RADIX_UNSIGNED if you know your input buffer only contains positive values.
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ParallelRadixSort& ParallelRadixSort::Sort(const udword* input, udword nb, const RadixHints& hints)
+{
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU32>(input, nb);
+	else					return SortKeys<RadixKeyS32>(input, nb);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for floating-point values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of floating-point values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_POSITIVE if you know all values are positive
+ *	\return		Self-Reference
+ *	\warning	only sorts IEEE floating-point values
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+ParallelRadixSort& ParallelRadixSort::Sort(const float* input, udword nb, const RadixHints& hints)
+{
+	// Positive floats sort like unsigned integers
+	if(hints.mFlags & RADIX_POSITIVE)	return SortKeys<RadixKeyU32>((const udword*)input, nb);
+	else								return SortKeys<RadixKeyF32>((const udword*)input, nb);
+}
+
+template<class Traits>
+ParallelRadixSort& ParallelRadixSort::SortKeys(const udword* input, udword nb)
+{
+	typedef RadixEngine<Traits, RADIX_NB_BITS>	Engine;
+
+	// Checkings
+	if(!input || !nb)	return *this;
+
+	// Stats
+	mTotalCalls++;
+	mNbSplits = 0;
+
+	// Resize lists if needed
+	if(!CheckResize(nb))	return *this;
+
+	SortExecutor* Executor = mExecutor ? mExecutor : GetSortExecutor();
+
+	// Small arrays: plain LSD sort, as in RadixSort3
+	if(nb<PARALLEL_RADIX_MIN_NB || !Executor->GetNbThreads())
+	{
+		udword Histogram[Engine::HistogramSize];
+		RadixRanks<udword> Ranks = { mRanks, mIndices[0], false };
+		Engine::Sort(input, nb, Engine::MaxNbPasses, RADIX_UNSIGNED, Histogram, Ranks);
+		// Keep the result in mRanks
+		mIndices[0] = Ranks.mRanks2;
+		mRanks = Ranks.mRanks;
+		return *this;
+	}
+
+	// A bucket larger than a thread's share of the work is split further
+	mSplitSize = nb/(Executor->GetNbThreads()+1);
+	if(mSplitSize<PARALLEL_RADIX_MIN_NB)
+		mSplitSize = PARALLEL_RADIX_MIN_NB;
+
+	// First partition, from the input, always done since it creates the keys
+	udword Sizes[RADIX_SIZE];
+	ParallelRadixPartition<Traits>(Executor, input, null, 0, mKeys[0], mIndices[0], nb, 32 - TOP_NB_BITS, TOP_NB_BITS, Sizes, false);
+
+	SortBuckets(0, Sizes, 1<<TOP_NB_BITS, 32 - TOP_NB_BITS, 0);
+	return *this;
+}
+
+// Sorts all the buckets of a partition, in parallel
+void ParallelRadixSort::SortBuckets(udword start, const udword* sizes, udword nb_buckets, udword shift, udword current)
+{
+	udword Starts[RADIX_SIZE+1];
+	Starts[0] = start;
+	for(udword i=0;i<nb_buckets;i++)
+		Starts[i+1] = Starts[i] + sizes[i];
+
+	BucketContext Context;
+	Context.mSorter		= this;
+	Context.mStarts		= Starts;
+	Context.mShift		= shift;
+	Context.mCurrent	= current;
+	SortExecutor* Executor = mExecutor ? mExecutor : GetSortExecutor();
+	Executor->ParallelFor(nb_buckets, SortBucketJob, &Context);
+}
+
+void ParallelRadixSort::SortBucketJob(udword index, void* user_data)
+{
+	const BucketContext* Context = reinterpret_cast<const BucketContext*>(user_data);
+	const udword Start = Context->mStarts[index];
+	const udword Nb = Context->mStarts[index+1] - Start;
+	if(Nb)
+		Context->mSorter->SortRange(Start, Nb, Context->mShift, Context->mCurrent);
+}
+
+void ParallelRadixSort::CopyRanksJob(udword index, void* user_data)
+{
+	const CopyContext* Context = reinterpret_cast<const CopyContext*>(user_data);
+	const udword Start = udword((uqword(Context->mNb)*index)/Context->mNbChunks);
+	const udword End = udword((uqword(Context->mNb)*(index+1))/Context->mNbChunks);
+	CopyMemory(Context->mDst + Start, Context->mSrc + Start, (End - Start)*sizeof(udword));
+}
+
+// Sorts nb values from 'start', whose bits above 'shift' are all the same. Keys & indices are in list 'current'.
+void ParallelRadixSort::SortRange(udword start, udword nb, udword shift, udword current)
+{
+	const udword* Keys = mKeys[current] + start;
+	const udword* Indices = mIndices[current] + start;
+	udword* Ranks = mRanks + start;
+
+	if(nb>mSplitSize)
+	{
+		SortExecutor* Executor = mExecutor ? mExecutor : GetSortExecutor();
+
+		// Skewed bucket: partition it again in parallel, on the next digit. Digits shared by all values are skipped.
+		while(shift)
+		{
+			shift -= RADIX_NB_BITS;
+			udword Sizes[RADIX_SIZE];
+			if(ParallelRadixPartition<RadixKeyU32>(Executor, Keys, Indices, 0, mKeys[1-current] + start, mIndices[1-current] + start, nb, shift, RADIX_NB_BITS, Sizes, true))
+			{
+				mNbSplits++;
+				SortBuckets(start, Sizes, RADIX_SIZE, shift, 1-current);
+				return;
+			}
+		}
+
+		// All keys are the same, the partitions kept the input order
+		CopyContext Context;
+		Context.mDst		= Ranks;
+		Context.mSrc		= Indices;
+		Context.mNb			= nb;
+		Context.mNbChunks	= nb/PARALLEL_RADIX_MIN_CHUNK;
+		Executor->ParallelFor(Context.mNbChunks, CopyRanksJob, &Context);
+		return;
+	}
+
+	if(!shift || nb==1)
+	{
+		CopyMemory(Ranks, Indices, nb*sizeof(udword));
+		return;
+	}
+
+	// LSD passes on the remaining bits. The other lists are free in that range, they're used for the local ranks.
+	udword Histogram[BucketEngine::HistogramSize];
+	RadixRanks<udword> LocalRanks = { mKeys[1-current] + start, mIndices[1-current] + start, false };
+	BucketEngine::Sort(Keys, nb, shift/RADIX_NB_BITS, RADIX_UNSIGNED, Histogram, LocalRanks);
+
+	for(udword i=0;i<nb;i++)
+		Ranks[i] = Indices[LocalRanks.mRanks[i]];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword ParallelRadixSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(ParallelRadixSort);
+	UsedRam += 5*mCurrentSize*sizeof(udword);	// Ranks, 2 lists of keys, 2 lists of indices
+	return UsedRam;
+}
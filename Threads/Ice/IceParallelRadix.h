@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a parallel MSD radix sort.
+ *	\file		IceParallelRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICEPARALLELRADIX_H
+#define ICEPARALLELRADIX_H
+
+	#define PARALLEL_RADIX_MIN_NB		65536	// Smaller arrays are sorted on the calling thread
+	#define PARALLEL_RADIX_MIN_CHUNK	16384	// Smallest part of a partition given to a thread
+
+	// Stable parallel partition on one digit, shared by the parallel sorters. Instantiated for RadixKeyU32, RadixKeyS32 & RadixKeyF32.
+	template<class Traits>
+	bool	ParallelRadixPartition(SortExecutor* executor, const udword* src_keys, const udword* src_indices, udword base_index, udword* dst_keys, udword* dst_indices,
+									udword nb, udword shift, udword nb_bits, udword* sizes, bool skip);
+
+	class ICECORE_API ParallelRadixSort : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								ParallelRadixSort();
+								~ParallelRadixSort();
+		// Sorting methods
+				ParallelRadixSort&	Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				ParallelRadixSort&	Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+
+		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data
+		inline_	const udword*	GetRanks()			const	{ return mRanks;		}
+
+		// Settings
+		//! Runs the sort on a given executor. Null (the default) uses the global sort executor.
+		inline_	void			SetExecutor(SortExecutor* executor)	{ mExecutor = executor;	}
+
+		// Stats
+				udword			GetUsedRam()		const;
+		//! Returns the total number of calls to the radix sorter.
+		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
+		//! Returns the number of buckets too large for one thread, partitioned again in parallel during the last call.
+		inline_	udword			GetNbSplits()		const	{ return mNbSplits;		}
+
+								PREVENT_COPY(ParallelRadixSort)
+		private:
+				udword			mCurrentSize;		//!< Current size of the lists
+				udword*			mRanks;				//!< Sorted ranks
+				udword*			mKeys[2];			//!< Sortable keys, partitioned back and forth
+				udword*			mIndices[2];		//!< Indices of these keys
+				SortExecutor*	mExecutor;
+				udword			mSplitSize;			//!< Buckets larger than this are partitioned again in parallel
+		// Stats
+				udword			mTotalCalls;		//!< Total number of calls to the sort routine
+				std::atomic<udword>	mNbSplits;		//!< Number of buckets partitioned again
+		// Internal methods
+				bool			CheckResize(udword nb);
+		template<class Traits>
+				ParallelRadixSort&	SortKeys(const udword* input, udword nb);
+				void			SortRange(udword start, udword nb, udword shift, udword current);
+				void			SortBuckets(udword start, const udword* sizes, udword nb_buckets, udword shift, udword current);
+		static	void			SortBucketJob(udword index, void* user_data);
+		static	void			CopyRanksJob(udword index, void* user_data);
+	};
+
+#endif // ICEPARALLELRADIX_H
@@ -0,0 +1,308 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains parallel permutation kernels, to apply sorted ranks to payloads.
+ *	\file		IcePermutation.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Permutation kernels.
+ *
+ *	Once the ranks are known, reordering the payloads is a gather: one random read per element and per array, which
+ *	easily costs more than the sort itself. The kernels here:
+ *	- split the ranks in chunks, gathered in parallel by the executor. Within a chunk the streams are gathered one
+ *	  after the other. Interleaving them, block by block, reads the ranks once instead of once per stream, but the
+ *	  random reads then hit all the source arrays at the same time, and their TLB entries & page tables no longer
+ *	  stay in cache: that was measured up to 50% slower than reading the (sequential) ranks again for each stream,
+ *	- prefetch the source elements PERMUTATION_PREFETCH_DISTANCE ranks ahead, so that several cache misses are in
+ *	  flight at the same time instead of one,
+ *	- have specialized loops for 1, 2, 4, 8, 12 & 16-byte elements (indices, colors, float2/3/4...), and use AVX2
+ *	  gathers for 4 & 8-byte elements when compiled for AVX2.
+ *
+ *	The inverse permutation is a scatter, with the same chunks & prefetches. Composition is a 4-byte gather.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define	PERMUTATION_PREFETCH(p)	_mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
+#else
+	#define	PERMUTATION_PREFETCH(p)
+#endif
+
+#ifdef __AVX2__
+	#include <immintrin.h>
+	#define	PERMUTATION_AVX2
+#endif
+
+#define	PERMUTATION_PREFETCH_DISTANCE	32
+
+namespace
+{
+	struct Element8		{ udword	mData[2];	};
+	struct Element12	{ udword	mData[3];	};
+	struct Element16	{ udword	mData[4];	};
+
+	// dst[i] = src[ranks[i]], for a block of ranks
+	template<class T>
+	void Gather(const void* src, void* dst, const udword* ranks, udword nb)
+	{
+		const T* Src = reinterpret_cast<const T*>(src);
+		T* Dst = reinterpret_cast<T*>(dst);
+
+		udword i=0;
+		if(nb>PERMUTATION_PREFETCH_DISTANCE)
+		{
+			for(;i<nb-PERMUTATION_PREFETCH_DISTANCE;i++)
+			{
+				PERMUTATION_PREFETCH(Src + ranks[i+PERMUTATION_PREFETCH_DISTANCE]);
+				Dst[i] = Src[ranks[i]];
+			}
+		}
+		for(;i<nb;i++)
+			Dst[i] = Src[ranks[i]];
+	}
+
+#ifdef PERMUTATION_AVX2
+	// 8 elements per gather. Indices are signed, so ranks must be below 2^31.
+	template<>
+	void Gather<udword>(const void* src, void* dst, const udword* ranks, udword nb)
+	{
+		const int* Src = reinterpret_cast<const int*>(src);
+		udword* Dst = reinterpret_cast<udword*>(dst);
+
+		udword i=0;
+		for(;i+8+PERMUTATION_PREFETCH_DISTANCE<=nb;i+=8)
+		{
+			for(udword j=0;j<8;j++)
+				PERMUTATION_PREFETCH(Src + ranks[i+j+PERMUTATION_PREFETCH_DISTANCE]);
+			const __m256i Indices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ranks + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i), _mm256_i32gather_epi32(Src, Indices, 4));
+		}
+		for(;i<nb;i++)
+			Dst[i] = Src[ranks[i]];
+	}
+
+	// 4 elements per gather
+	template<>
+	void Gather<Element8>(const void* src, void* dst, const udword* ranks, udword nb)
+	{
+		const long long* Src = reinterpret_cast<const long long*>(src);
+		long long* Dst = reinterpret_cast<long long*>(dst);
+
+		udword i=0;
+		for(;i+4+PERMUTATION_PREFETCH_DISTANCE<=nb;i+=4)
+		{
+			for(udword j=0;j<4;j++)
+				PERMUTATION_PREFETCH(Src + ranks[i+j+PERMUTATION_PREFETCH_DISTANCE]);
+			const __m128i Indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranks + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + i), _mm256_i32gather_epi64(Src, Indices, 8));
+		}
+		for(;i<nb;i++)
+			Dst[i] = Src[ranks[i]];
+	}
+#endif
+
+	// Any other size
+	void GatherBytes(const void* src, void* dst, const udword* ranks, udword nb, udword size)
+	{
+		const ubyte* Src = reinterpret_cast<const ubyte*>(src);
+		ubyte* Dst = reinterpret_cast<ubyte*>(dst);
+
+		for(udword i=0;i<nb;i++)
+		{
+			if(i+PERMUTATION_PREFETCH_DISTANCE<nb)
+				PERMUTATION_PREFETCH(Src + size_t(ranks[i+PERMUTATION_PREFETCH_DISTANCE])*size);
+			CopyMemory(Dst, Src + size_t(ranks[i])*size, size);
+			Dst += size;
+		}
+	}
+
+	void GatherStream(const PermutationStream& stream, const udword* ranks, udword start, udword nb)
+	{
+		const udword Size = stream.mSize;
+		void* Dst = reinterpret_cast<ubyte*>(stream.mDst) + size_t(start)*Size;
+		ranks += start;
+
+		switch(Size)
+		{
+			case 1:		Gather<ubyte>(stream.mSrc, Dst, ranks, nb);		break;
+			case 2:		Gather<uword>(stream.mSrc, Dst, ranks, nb);		break;
+			case 4:		Gather<udword>(stream.mSrc, Dst, ranks, nb);	break;
+			case 8:		Gather<Element8>(stream.mSrc, Dst, ranks, nb);	break;
+			case 12:	Gather<Element12>(stream.mSrc, Dst, ranks, nb);	break;
+			case 16:	Gather<Element16>(stream.mSrc, Dst, ranks, nb);	break;
+			default:	GatherBytes(stream.mSrc, Dst, ranks, nb, Size);	break;
+		}
+	}
+
+	// Shared by the jobs of a call
+	struct PermutationContext
+	{
+		const udword*				mRanks;
+		udword						mNb;
+		const PermutationStream*	mStreams;
+		udword						mNbStreams;
+		udword*						mInverse;
+		udword						mChunkSize;
+	};
+
+	void GatherJob(udword index, void* user_data)
+	{
+		const PermutationContext* Context = reinterpret_cast<const PermutationContext*>(user_data);
+
+		const udword Start = index*Context->mChunkSize;
+		const udword End = Start + Context->mChunkSize < Context->mNb ? Start + Context->mChunkSize : Context->mNb;
+
+		for(udword i=0;i<Context->mNbStreams;i++)
+			GatherStream(Context->mStreams[i], Context->mRanks, Start, End - Start);
+	}
+
+	void InvertJob(udword index, void* user_data)
+	{
+		const PermutationContext* Context = reinterpret_cast<const PermutationContext*>(user_data);
+
+		const udword Start = index*Context->mChunkSize;
+		const udword End = Start + Context->mChunkSize < Context->mNb ? Start + Context->mChunkSize : Context->mNb;
+		const udword* Ranks = Context->mRanks;
+		udword* Inverse = Context->mInverse;
+
+		udword i=Start;
+		if(End-Start>PERMUTATION_PREFETCH_DISTANCE)
+		{
+			for(;i<End-PERMUTATION_PREFETCH_DISTANCE;i++)
+			{
+				PERMUTATION_PREFETCH(Inverse + Ranks[i+PERMUTATION_PREFETCH_DISTANCE]);
+				Inverse[Ranks[i]] = i;
+			}
+		}
+		for(;i<End;i++)
+			Inverse[Ranks[i]] = i;
+	}
+
+	// Splits the ranks in chunks & runs them, on the calling thread only for small arrays
+	void Run(PermutationContext& context, SortTaskFunction function, SortExecutor* executor)
+	{
+		if(!executor)
+			executor = GetSortExecutor();
+
+		// A few chunks per thread, since cache misses make their timings uneven
+		const udword NbThreads = executor->GetNbThreads() + 1;
+		udword NbChunks = context.mNb/PERMUTATION_MIN_CHUNK;
+		if(NbChunks>NbThreads*2)
+			NbChunks = NbThreads*2;
+		if(NbChunks<2 || NbThreads==1)
+		{
+			context.mChunkSize = context.mNb;
+			(function)(0, &context);
+			return;
+		}
+
+		context.mChunkSize = (context.mNb + NbChunks - 1)/NbChunks;
+		NbChunks = (context.mNb + context.mChunkSize - 1)/context.mChunkSize;
+
+		executor->ParallelFor(NbChunks, function, &context);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Permutes several arrays at once, with the ranks from a sorter. Streams share the chunks & the threads, which is
+ *	faster than permuting each of them on its own.
+ *	\param		ranks		[in] sorted ranks, e.g. from RadixSort::GetRanks()
+ *	\param		nb			[in] number of ranks, i.e. of elements in each stream
+ *	\param		streams		[in] arrays to permute. Destinations can't overlap sources.
+ *	\param		nb_streams	[in] number of streams
+ *	\param		executor	[in] executor running the chunks, or null for the global one
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IceCore::ApplyPermutation(const udword* ranks, udword nb, const PermutationStream* streams, udword nb_streams, SortExecutor* executor)
+{
+	// Checkings
+	if(!nb || !nb_streams)		return true;
+	if(!ranks || !streams)		return false;
+	for(udword i=0;i<nb_streams;i++)
+	{
+		if(!streams[i].mSrc || !streams[i].mDst || !streams[i].mSize)	return false;
+	}
+
+	PermutationContext Context;
+	Context.mRanks		= ranks;
+	Context.mNb			= nb;
+	Context.mStreams	= streams;
+	Context.mNbStreams	= nb_streams;
+	Context.mInverse	= null;
+	Run(Context, GatherJob, executor);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Permutes one array with the ranks from a sorter.
+ *	\param		ranks		[in] sorted ranks
+ *	\param		nb			[in] number of ranks
+ *	\param		src			[in] unsorted elements
+ *	\param		dst			[out] sorted elements, can't overlap src
+ *	\param		size		[in] size of an element in bytes
+ *	\param		executor	[in] executor running the chunks, or null for the global one
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IceCore::ApplyPermutation(const udword* ranks, udword nb, const void* src, void* dst, udword size, SortExecutor* executor)
+{
+	const PermutationStream Stream(src, dst, size);
+	return ApplyPermutation(ranks, nb, &Stream, 1, executor);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Computes the inverse permutation, i.e. where each input element ends up once sorted.
+ *	\param		ranks		[in] sorted ranks, a permutation of [0, nb)
+ *	\param		nb			[in] number of ranks
+ *	\param		inverse		[out] inverse permutation, can't overlap ranks
+ *	\param		executor	[in] executor running the chunks, or null for the global one
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IceCore::InvertPermutation(const udword* ranks, udword nb, udword* inverse, SortExecutor* executor)
+{
+	// Checkings
+	if(!nb)					return true;
+	if(!ranks || !inverse)	return false;
+
+	PermutationContext Context;
+	Context.mRanks		= ranks;
+	Context.mNb			= nb;
+	Context.mStreams	= null;
+	Context.mNbStreams	= 0;
+	Context.mInverse	= inverse;
+	Run(Context, InvertJob, executor);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Composes two permutations: sorting data with first, then sorting the result with second, is the same as sorting
+ *	the original data with the result. Typically used to chain sorts on different keys.
+ *	\param		first		[in] first permutation
+ *	\param		second		[in] second permutation
+ *	\param		nb			[in] number of ranks
+ *	\param		result		[out] composed permutation. Can be second, but can't overlap first.
+ *	\param		executor	[in] executor running the chunks, or null for the global one
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool IceCore::ComposePermutations(const udword* first, const udword* second, udword nb, udword* result, SortExecutor* executor)
+{
+	return ApplyPermutation(second, nb, first, result, sizeof(udword), executor);
+}
@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains parallel permutation kernels, to apply sorted ranks to payloads.
+ *	\file		IcePermutation.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICEPERMUTATION_H
+#define ICEPERMUTATION_H
+
+	#define PERMUTATION_MIN_CHUNK	16384	// Smallest part of the ranks given to a thread
+
+	//! One array permuted by ApplyPermutation. Elements are packed, i.e. the stride is the element size.
+	struct PermutationStream
+	{
+		inline_					PermutationStream() : mSrc(null), mDst(null), mSize(0)	{}
+		inline_					PermutationStream(const void* src, void* dst, udword size) : mSrc(src), mDst(dst), mSize(size)	{}
+
+				const void*		mSrc;		//!< Unsorted elements
+				void*			mDst;		//!< Sorted elements, can't overlap mSrc
+				udword			mSize;		//!< Size of an element in bytes
+	};
+
+	// Gathers each stream in sorted order: dst[i] = src[ranks[i]]. Null executor = the global sort executor.
+	ICECORE_API	bool	ApplyPermutation(const udword* ranks, udword nb, const PermutationStream* streams, udword nb_streams, SortExecutor* executor=null);
+	ICECORE_API	bool	ApplyPermutation(const udword* ranks, udword nb, const void* src, void* dst, udword size, SortExecutor* executor=null);
+	// inverse[ranks[i]] = i, i.e. the sorted position of each input element
+	ICECORE_API	bool	InvertPermutation(const udword* ranks, udword nb, udword* inverse, SortExecutor* executor=null);
+	// result[i] = first[second[i]], i.e. the ranks of data sorted by first, then by second. Same as permuting first with second.
+	ICECORE_API	bool	ComposePermutations(const udword* first, const udword* second, udword nb, udword* result, SortExecutor* executor=null);
+
+#endif // ICEPERMUTATION_H
@@ -20,6 +20,14 @@
 		#pragma message("Compiling on unknown platform...")
 	#endif
 
+	// Check CPU. Inline assembly is only available on 32-bit x86.
+	#if defined(_M_IX86)
+		#define PLATFORM_X86
+	#elif defined(_M_X64)
+		#pragma message("Compiling for x64...")
+		#define PLATFORM_X64
+	#endif
+
 	// Check compiler
 	#if defined(_MSC_VER)
 		#pragma message("Compiling with VC++...")
@@ -19,8 +19,11 @@
 								RadixSort3();
 								~RadixSort3();
 		// Sorting methods
-				RadixSort3&		Sort(const udword* input, udword nb, RadixHint hint=RADIX_SIGNED);
-				RadixSort3&		Sort(const float* input, udword nb);
+				RadixSort3&		Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				RadixSort3&		Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+		// Asynchronous sorting methods, running on the shared sort thread pool. Don't call Sort() while an asynchronous sort is pending.
+				SortFuture&		SortAsync(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				SortFuture&		SortAsync(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
 
 		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data
 		inline_	const udword*	GetRanks()			const	{ return mRanks;		}
@@ -28,6 +31,9 @@
 		//! mIndices2 gets trashed on calling the sort routine, but otherwise you can recycle it the way you want.
 		inline_	udword*			GetRecyclable()		const	{ return mRanks2;		}
 
+		//! Forgets the previous ranks: the next sort starts from the input order instead, and equal values keep that order.
+		inline_	void			ResetRanks()				{ mCurrentSize|=0x80000000;	}
+
 		// Stats
 		//! Returns the total number of calls to the radix sorter.
 		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
@@ -44,11 +50,15 @@
 		// Stats
 				udword			mTotalCalls;		//!< Total number of calls to the sort routine
 				udword			mNbHits;			//!< Number of early exits due to coherence
+		// Async
+				SortFuture		mFuture;			//!< Pending asynchronous sort
 		// Stack-radix
 				bool			mDeleteRanks;		//!<
 		// Internal methods
 				void			CheckResize(udword nb);
 				bool			Resize(udword nb);
+		template<class Traits>
+				RadixSort3&		SortKeys(const typename Traits::Type* input, udword nb, udword nb_passes, const RadixHints& hints);
 	};
 
 	#define StackRadixSort3(name, ranks0, ranks1)	\
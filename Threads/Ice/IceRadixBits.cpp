@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a radix sort with a compile-time digit width.
+ *	\file		IceRadixBits.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A radix sort where the digit width is a template parameter.
+ *
+ *	RadixSort uses 8-bit digits and RadixSort3 uses 11-bit digits. Which one wins depends on the machine (L1 size,
+ *	TLB, number of values) and on the key range. Here the width is a compile-time constant, and everything else
+ *	(histogram size, number of passes, masks) is derived from it. Kernels come from IceRadixEngine.h so the shifts
+ *	are constants as well.
+ *
+ *	The 8, 10, 11, 12 and 16 bits versions are prebuilt, to benchmark them and pick one per machine:
+ *	- wider digits mean less passes over the data, i.e. less memory traffic,
+ *	- but histograms get bigger: 16-bit digits need 512Kb of counters, well beyond L1 and L2 on most parts,
+ *	  and creating the offsets costs 65536 iterations per pass, which only pays off for large arrays.
+ *
+ *	Histograms are allocated once with the ranks, since the 16-bit version can't use the stack.
+ *
+ *	\class		RadixSortBits
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<udword NbBits>
+RadixSortBits<NbBits>::RadixSortBits() : mCurrentSize(0), mRanks(null), mRanks2(null), mHistogram(null), mValidRanks(false), mTotalCalls(0), mNbHits(0)
+{
+	// Narrower digits don't make sense, wider ones need too many counters
+	ICE_COMPILE_TIME_ASSERT(NbBits>=8 && NbBits<=16);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<udword NbBits>
+RadixSortBits<NbBits>::~RadixSortBits()
+{
+	ICE_FREE(mHistogram);
+	ICE_FREE(mRanks2);
+	ICE_FREE(mRanks);
+}
+
+template<udword NbBits>
+bool RadixSortBits<NbBits>::CheckResize(udword nb)
+{
+	if(!mHistogram)
+	{
+		mHistogram = (udword*)ICE_ALLOC(sizeof(udword)*GetHistogramSize());	CHECKALLOC(mHistogram);
+	}
+
+	if(nb==mCurrentSize)	return true;
+
+	mValidRanks = false;
+	if(nb>mCurrentSize)
+	{
+		ICE_FREE(mRanks2);
+		ICE_FREE(mRanks);
+		mCurrentSize = 0;
+
+		mRanks	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks);
+		mRanks2	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks2);
+	}
+	mCurrentSize = nb;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of integer values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_SIGNED to handle negative values, RADIX_UNSIGNED if you know your input buffer only contains positive values.
+ *							Extra hints (RADIX_POSITIVE, RADIX_PRESORTED, RADIX_RANDOM, number of bits) can be passed in a RadixHints struct.
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<udword NbBits>
+RadixSortBits<NbBits>& RadixSortBits<NbBits>::Sort(const udword* input, udword nb, const RadixHints& hints)
+{
+	const udword NbPasses = hints.GetNbPasses(NbBits, GetMaxNbPasses());
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU32>(input, nb, NbPasses, hints);
+	else					return SortKeys<RadixKeyS32>(input, nb, NbPasses, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for floating-point values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of floating-point values to sort
+ *	\param		nb		[in] number of values to sort
+ *	\param		hints	[in] RADIX_POSITIVE if you know all values are positive, RADIX_PRESORTED or RADIX_RANDOM to tweak temporal coherence
+ *	\return		Self-Reference
+ *	\warning	only sorts IEEE floating-point values
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<udword NbBits>
+RadixSortBits<NbBits>& RadixSortBits<NbBits>::Sort(const float* input, udword nb, const RadixHints& hints)
+{
+	// Positive floats sort like unsigned integers
+	if(hints.mFlags & RADIX_POSITIVE)	return SortKeys<RadixKeyU32>((const udword*)input, nb, GetMaxNbPasses(), hints);
+	else								return SortKeys<RadixKeyF32>((const udword*)input, nb, GetMaxNbPasses(), hints);
+}
+
+template<udword NbBits>
+template<class Traits>
+RadixSortBits<NbBits>& RadixSortBits<NbBits>::SortKeys(const typename Traits::Type* input, udword nb, udword nb_passes, const RadixHints& hints)
+{
+	typedef RadixEngine<Traits, NbBits>	Engine;
+	ICE_COMPILE_TIME_ASSERT(Engine::HistogramSize==GetHistogramSize());
+
+	// Checkings
+	if(!input || !nb)	return *this;
+
+	// Stats
+	mTotalCalls++;
+
+	// Resize lists if needed
+	if(!CheckResize(nb))	return *this;
+
+	RadixRanks<udword> Ranks = { mRanks, mRanks2, mValidRanks };
+	if(Engine::Sort(input, nb, nb_passes, hints, mHistogram, Ranks))
+		mNbHits++;
+	mRanks		= Ranks.mRanks;
+	mRanks2		= Ranks.mRanks2;
+	mValidRanks	= Ranks.mValid;
+	return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<udword NbBits>
+udword RadixSortBits<NbBits>::GetUsedRam() const
+{
+	udword UsedRam = sizeof(RadixSortBits);
+	UsedRam += 2*mCurrentSize*sizeof(udword);				// 2 lists of indices
+	if(mHistogram)
+		UsedRam += GetHistogramSize()*sizeof(udword);		// Counters
+	return UsedRam;
+}
+
+// Explicit instantiations
+template class RadixSortBits<8>;
+template class RadixSortBits<10>;
+template class RadixSortBits<11>;
+template class RadixSortBits<12>;
+template class RadixSortBits<16>;
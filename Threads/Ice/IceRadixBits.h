@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a radix sort with a compile-time digit width.
+ *	\file		IceRadixBits.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICERADIXBITS_H
+#define ICERADIXBITS_H
+
+	//! Radix sort with a NbBits-wide digit. Instantiated for 8, 10, 11, 12 and 16 bits.
+	template<udword NbBits>
+	class RadixSortBits : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								RadixSortBits();
+								~RadixSortBits();
+		// Sorting methods
+				RadixSortBits&	Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				RadixSortBits&	Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+
+		// Digit width & derived sizes
+		//! Returns the number of bits per digit.
+		static	constexpr udword	GetNbBits()			{ return NbBits;							}
+		//! Returns the number of counters per histogram.
+		static	constexpr udword	GetRadixSize()		{ return 1<<NbBits;							}
+		//! Returns the mask extracting one digit.
+		static	constexpr udword	GetRadixMask()		{ return GetRadixSize()-1;					}
+		//! Returns the maximum number of passes for 32-bit keys.
+		static	constexpr udword	GetMaxNbPasses()	{ return (32+NbBits-1)/NbBits;				}
+		//! Returns the number of counters for all passes.
+		static	constexpr udword	GetHistogramSize()	{ return GetRadixSize()*GetMaxNbPasses();	}
+
+		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data
+		inline_	const udword*	GetRanks()			const	{ return mRanks;		}
+
+		//! mIndices2 gets trashed on calling the sort routine, but otherwise you can recycle it the way you want.
+		inline_	udword*			GetRecyclable()		const	{ return mRanks2;		}
+
+		//! Forgets the previous ranks: the next sort starts from the input order instead, and equal values keep that order.
+		inline_	void			ResetRanks()				{ mValidRanks = false;	}
+
+		// Stats
+				udword			GetUsedRam()		const;
+		//! Returns the total number of calls to the radix sorter.
+		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
+		//! Returns the number of early exits due to temporal coherence.
+		inline_	udword			GetNbHits()			const	{ return mNbHits;		}
+
+								PREVENT_COPY(RadixSortBits)
+		private:
+				udword			mCurrentSize;		//!< Current size of the indices list
+				udword*			mRanks;				//!< Two lists, swapped each pass
+				udword*			mRanks2;
+				udword*			mHistogram;			//!< Counters for all passes. Too big for the stack with 16-bit digits.
+				bool			mValidRanks;		//!< Ranks from the previous sort are valid
+		// Stats
+				udword			mTotalCalls;		//!< Total number of calls to the sort routine
+				udword			mNbHits;			//!< Number of early exits due to coherence
+		// Internal methods
+				bool			CheckResize(udword nb);
+		template<class Traits>
+				RadixSortBits&	SortKeys(const typename Traits::Type* input, udword nb, udword nb_passes, const RadixHints& hints);
+	};
+
+	typedef RadixSortBits<8>	RadixSort8Bits;		//!< Same digit as RadixSort, 4 passes
+	typedef RadixSortBits<10>	RadixSort10Bits;	//!< 4 passes, the last one on 2 bits
+	typedef RadixSortBits<11>	RadixSort11Bits;	//!< Same digit as RadixSort3, 3 passes
+	typedef RadixSortBits<12>	RadixSort12Bits;	//!< 3 passes, 32Kb of counters per pass
+	typedef RadixSortBits<16>	RadixSort16Bits;	//!< 2 passes, 256Kb of counters per pass
+
+#endif // ICERADIXBITS_H
@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains the key traits & the generic LSD radix kernels shared by the sorters.
+ *	\file		IceRadixEngine.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICERADIXENGINE_H
+#define ICERADIXENGINE_H
+
+	// Key traits. Each one defines the input type, the number of meaningful bits, and the order transform: ToSortable() returns
+	// a value that sorts as an unsigned integer in the desired order. Signed values get their sign bit flipped, negative floats
+	// get all their bits flipped. This replaces the special "negative" last pass of the old code.
+
+	// The 32-bit traits also have FromSortable(), the inverse transform, for sorters that keep transformed keys around.
+
+	//! Unsigned 32-bit integers
+	struct RadixKeyU32
+	{
+		typedef udword	Type;
+		enum { NbBits = 32, IsSigned = 0 };
+		static	inline_	udword	ToSortable(udword key)		{ return key;					}
+		static	inline_	udword	FromSortable(udword key)	{ return key;					}
+	};
+
+	//! Signed 32-bit integers
+	struct RadixKeyS32
+	{
+		typedef udword	Type;
+		enum { NbBits = 32, IsSigned = 1 };
+		static	inline_	udword	ToSortable(udword key)		{ return key ^ 0x80000000;		}
+		static	inline_	udword	FromSortable(udword key)	{ return key ^ 0x80000000;		}
+	};
+
+	//! IEEE floats, in IEEE totalOrder: -NaN < -Inf < ... < -0 < +0 < ... < +Inf < +NaN
+	struct RadixKeyF32
+	{
+		typedef udword	Type;
+		enum { NbBits = 32, IsSigned = 1 };
+		static	inline_	udword	ToSortable(udword key)		{ return key ^ (udword(sdword(key)>>31) | 0x80000000);	}
+		static	inline_	udword	FromSortable(udword key)	{ return key ^ (udword(sdword(~key)>>31) | 0x80000000);	}
+	};
+
+	//! Runtime tag for the 32-bit traits, for sorters that can't pick an instantiation once and for all (e.g. work split across calls)
+	enum RadixKeyType
+	{
+		RADIX_KEY_U32,		//!< RadixKeyU32
+		RADIX_KEY_S32,		//!< RadixKeyS32
+		RADIX_KEY_F32,		//!< RadixKeyF32
+	};
+
+	//! Returns the key type for the given hints, with the same rules as the Sort() functions
+	inline_ RadixKeyType GetRadixKeyType(const RadixHints& hints, bool is_float)
+	{
+		if(is_float)	return (hints.mFlags & RADIX_POSITIVE) ? RADIX_KEY_U32 : RADIX_KEY_F32;
+		return hints.IsUnsigned() ? RADIX_KEY_U32 : RADIX_KEY_S32;
+	}
+
+	//! IEEE floats, with all NaNs remapped to the same sortable key (0 = NaNs first, 0xffffffff = NaNs last)
+	template<udword NaNKey>
+	struct RadixKeyF32NaN
+	{
+		typedef udword	Type;
+		enum { NbBits = 32, IsSigned = 1 };
+		// IsNAN() from IceFPU.h also catches infinities, so we test the bits here
+		static	inline_	bool	IsNaN(udword key)		{ return (key & 0x7fffffff) > 0x7f800000;	}
+		static	inline_	udword	ToSortable(udword key)	{ return IsNaN(key) ? NaNKey : RadixKeyF32::ToSortable(key);	}
+	};
+	typedef RadixKeyF32NaN<0>			RadixKeyF32NaNsFirst;
+	typedef RadixKeyF32NaN<0xffffffff>	RadixKeyF32NaNsLast;
+
+	//! Unsigned 16-bit integers
+	struct RadixKeyU16
+	{
+		typedef uword	Type;
+		enum { NbBits = 16, IsSigned = 0 };
+		static	inline_	udword	ToSortable(uword key)	{ return key;					}
+	};
+
+	//! Signed 16-bit integers
+	struct RadixKeyS16
+	{
+		typedef sword	Type;
+		enum { NbBits = 16, IsSigned = 1 };
+		static	inline_	udword	ToSortable(sword key)	{ return udword(uword(key)) ^ 0x8000;	}
+	};
+
+	//! IEEE half floats (binary16), stored as 16-bit values
+	struct RadixKeyF16
+	{
+		typedef uword	Type;
+		enum { NbBits = 16, IsSigned = 1 };
+		static	inline_	udword	ToSortable(uword key)	{ return key ^ ((udword(-sdword(key>>15)) & 0x7fff) | 0x8000);	}
+	};
+
+	//! Unsigned 8-bit integers
+	struct RadixKeyU8
+	{
+		typedef ubyte	Type;
+		enum { NbBits = 8, IsSigned = 0 };
+		static	inline_	udword	ToSortable(ubyte key)	{ return key;					}
+	};
+
+	//! Signed 8-bit integers
+	struct RadixKeyS8
+	{
+		typedef sbyte	Type;
+		enum { NbBits = 8, IsSigned = 1 };
+		static	inline_	udword	ToSortable(sbyte key)	{ return udword(ubyte(key)) ^ 0x80;		}
+	};
+
+	//! The two rank lists of a sorter, swapped after each pass
+	template<class RankT>
+	struct RadixRanks
+	{
+		RankT*	mRanks;		//!< Current ranks
+		RankT*	mRanks2;	//!< Destination of the next pass
+		bool	mValid;		//!< False if ranks are still implicit (identity)
+
+		inline_	void	Swap()	{ RankT* Tmp = mRanks; mRanks = mRanks2; mRanks2 = Tmp;	}
+	};
+
+	//! Pass number as a type, so that each pass gets its own instantiation
+	template<udword Pass>	struct RadixPass	{};
+
+	//! Generic LSD radix sort on ranks, for a given key type, digit width and rank type
+	template<class Traits, udword NbDigitBits, class RankT=udword>
+	class RadixEngine
+	{
+		public:
+		typedef typename Traits::Type	KeyType;
+
+		enum
+		{
+			RadixSize		= 1<<NbDigitBits,
+			RadixMask		= RadixSize-1,
+			MaxNbPasses		= (Traits::NbBits + NbDigitBits - 1)/NbDigitBits,
+			HistogramSize	= RadixSize*MaxNbPasses,	//!< Number of counters needed for all passes
+		};
+
+		//! Reads a key and makes it sortable as an unsigned value
+		static	inline_	udword	GetKey(const KeyType* input, RankT i)	{ return Traits::ToSortable(input[i]);	}
+
+		//! Extracts a digit, the shift is a compile-time constant
+		template<udword Pass>
+		static	inline_	udword	GetDigit(udword key)	{ return (key>>(Pass*NbDigitBits)) & RadixMask;	}
+
+		//! Extracts a digit, for a pass only known at runtime
+		static	inline_	udword	GetDigit(udword key, udword pass)	{ return (key>>(pass*NbDigitBits)) & RadixMask;	}
+
+		//! Updates the histograms of all passes with one key. The loop is unrolled by the compiler.
+		static	inline_	void	UpdateHistograms(RankT* histograms, udword key)
+								{
+									for(udword j=0;j<MaxNbPasses;j++)
+										histograms[j*RadixSize + ((key>>(j*NbDigitBits)) & RadixMask)]++;
+								}
+
+		//! Creates the histograms of all passes, without checking temporal coherence
+		static			void	CreateHistograms(const KeyType* input, RankT nb, RankT* histograms)
+								{
+									ZeroMemory(histograms, HistogramSize*sizeof(RankT));
+									for(RankT i=0;i<nb;i++)
+										UpdateHistograms(histograms, GetKey(input, i));
+								}
+
+		//! Updates the histograms of all passes with a range of keys, e.g. one chunk of a stream. Histograms aren't cleared.
+		static			void	UpdateHistograms(const KeyType* input, RankT start, RankT end, RankT* histograms)
+								{
+									for(RankT i=start;i<end;i++)
+										UpdateHistograms(histograms, GetKey(input, i));
+								}
+
+		//! Checks whether a pass is needed. If all values have the same digit, sorting is useless.
+		template<udword Pass>
+		static	inline_	bool	IsPassUseful(const KeyType* input, RankT nb, const RankT* histograms)
+								{
+									return histograms[Pass*RadixSize + GetDigit<Pass>(GetKey(input, 0))]!=nb;
+								}
+
+		//! Same as above, for a pass only known at runtime
+		static	inline_	bool	IsPassUseful(const KeyType* input, RankT nb, const RankT* histograms, udword pass)
+								{
+									return histograms[pass*RadixSize + GetDigit(GetKey(input, 0), pass)]!=nb;
+								}
+
+		//! Turns the counters of a pass into offsets, starting from digit 'first_digit' and wrapping around
+		static	inline_	void	CreateOffsets(RankT* counters, udword first_digit)
+								{
+									RankT Offset = 0;
+									for(udword i=0;i<RadixSize;i++)
+									{
+										const udword Digit = (i + first_digit) & RadixMask;
+										const RankT Count = counters[Digit];
+										counters[Digit] = Offset;
+										Offset += Count;
+									}
+								}
+
+		//! Scatters ranks [start, end[ of a pass only known at runtime, to dest. Offsets come from CreateOffsets() and are
+		//! updated, so consecutive ranges can be scattered in separate calls. Null ranks stand for the identity.
+		static			void	ScatterRange(const KeyType* input, RankT start, RankT end, udword pass, RankT* offsets, const RankT* ranks, RankT* dest)
+								{
+									if(!ranks)
+									{
+										for(RankT i=start;i<end;i++)
+											dest[offsets[GetDigit(GetKey(input, i), pass)]++] = i;
+									}
+									else
+									{
+										const RankT* Indices	= ranks + start;
+										const RankT* IndicesEnd	= ranks + end;
+										while(Indices!=IndicesEnd)
+										{
+											const RankT id = *Indices++;
+											dest[offsets[GetDigit(GetKey(input, id), pass)]++] = id;
+										}
+									}
+								}
+
+		//! Runs one pass, from ranks.mRanks to ranks.mRanks2. Counters of the pass are turned into offsets on the way, starting
+		//! from digit 'first_digit' and wrapping around.
+		template<udword Pass>
+		static			void	Scatter(const KeyType* input, RankT nb, RankT* counters, RadixRanks<RankT>& ranks, udword first_digit=0)
+								{
+									CreateOffsets(counters, first_digit);
+
+									// Perform Radix Sort
+									RankT* Dest = ranks.mRanks2;
+									if(!ranks.mValid)
+									{
+										for(RankT i=0;i<nb;i++)
+											Dest[counters[GetDigit<Pass>(GetKey(input, i))]++] = i;
+										ranks.mValid = true;
+									}
+									else
+									{
+										const RankT* Indices	= ranks.mRanks;
+										const RankT* IndicesEnd	= ranks.mRanks + nb;
+										while(Indices!=IndicesEnd)
+										{
+											const RankT id = *Indices++;
+											Dest[counters[GetDigit<Pass>(GetKey(input, id))]++] = id;
+										}
+									}
+
+									// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
+									ranks.Swap();
+								}
+
+		//! Sorts the values. Returns true for an early exit due to temporal coherence, in which case ranks are left unchanged.
+		static			bool	Sort(const KeyType* input, RankT nb, udword nb_passes, const RadixHints& hints, RankT* histograms, RadixRanks<RankT>& ranks)
+								{
+									// Create histograms (counters) for all passes in one run, and check temporal coherence at the same time
+									ZeroMemory(histograms, HistogramSize*sizeof(RankT));
+
+									RankT i = 0;
+									if(hints.mFlags & RADIX_RANDOM)
+									{
+										// Random input, checking for temporal coherence would be a waste of time
+									}
+									else if(!ranks.mValid || (hints.mFlags & RADIX_PRESORTED))
+									{
+										// Read input buffer in input order
+										udword PrevVal = GetKey(input, 0);
+										for(;i<nb;i++)
+										{
+											const udword Val = GetKey(input, i);
+											if(Val<PrevVal)	break;	// Early out
+											PrevVal = Val;
+											UpdateHistograms(histograms, Val);
+										}
+										if(i==nb)
+										{
+											for(RankT j=0;j<nb;j++)	ranks.mRanks[j] = j;
+											ranks.mValid = true;
+											return true;
+										}
+									}
+									else
+									{
+										// Read input buffer in previous sorted order, histograms are still created in input order
+										const RankT* Indices = ranks.mRanks;
+										udword PrevVal = GetKey(input, Indices[0]);
+										for(;i<nb;i++)
+										{
+											const udword Val = GetKey(input, Indices[i]);
+											if(Val<PrevVal)	break;	// Early out
+											PrevVal = Val;
+											UpdateHistograms(histograms, GetKey(input, i));
+										}
+										// If all input values are already sorted, we just have to return and leave the previous list unchanged
+										if(i==nb)	return true;
+									}
+
+									// Else there has been an early out and we must finish computing the histograms
+									for(;i<nb;i++)
+										UpdateHistograms(histograms, GetKey(input, i));
+
+									RunPasses(input, nb, nb_passes, histograms, ranks, RadixPass<0>());
+
+									// Ranks are still implicit if all passes have been skipped without checking coherence first (e.g. RADIX_RANDOM with identical values)
+									if(!ranks.mValid)
+									{
+										for(RankT j=0;j<nb;j++)	ranks.mRanks[j] = j;
+										ranks.mValid = true;
+									}
+									return false;
+								}
+
+		//! Returns the first digit of a pass. Signed keys narrower than the traits (see RadixHints::mNbBits) are sign-extended, so
+		//! the top bit of their last digit is the sign bit, unflipped: negative digits go first in that pass.
+		static	inline_	udword	GetFirstDigit(udword pass, udword nb_passes)
+								{
+									return (Traits::IsSigned && pass+1==nb_passes && nb_passes*NbDigitBits<Traits::NbBits) ? RadixSize/2 : 0;
+								}
+
+		private:
+		template<udword Pass>
+		static	inline_	void	RunPasses(const KeyType* input, RankT nb, udword nb_passes, RankT* histograms, RadixRanks<RankT>& ranks, RadixPass<Pass>)
+								{
+									if(Pass<nb_passes && IsPassUseful<Pass>(input, nb, histograms))
+										Scatter<Pass>(input, nb, &histograms[Pass*RadixSize], ranks, GetFirstDigit(Pass, nb_passes));
+									RunPasses(input, nb, nb_passes, histograms, ranks, RadixPass<Pass+1>());
+								}
+		static	inline_	void	RunPasses(const KeyType*, RankT, udword, RankT*, RadixRanks<RankT>&, RadixPass<MaxNbPasses>)	{}
+	};
+
+#endif // ICERADIXENGINE_H
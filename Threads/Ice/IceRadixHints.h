@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains the hints shared by all radix sorters.
+ *	\file		IceRadixHints.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICERADIXHINTS_H
+#define ICERADIXHINTS_H
+
+	enum RadixHint
+	{
+		RADIX_SIGNED,		//!< Input values are signed
+		RADIX_UNSIGNED,		//!< Input values are unsigned
+
+		RADIX_FORCE_DWORD = 0x7fffffff
+	};
+
+	enum RadixHintFlag
+	{
+		RADIX_POSITIVE		= (1<<0),	//!< All input values are positive (integers with a cleared MSB, floats >= +0.0)
+		RADIX_PRESORTED		= (1<<1),	//!< Input values are probably already sorted, check that first
+		RADIX_RANDOM		= (1<<2),	//!< Input values are random, don't bother checking for temporal coherence
+		// NaN policies (floats only). NaNs are counted, see RadixSort::GetNbNaNs().
+		RADIX_NANS_FIRST	= (1<<3),	//!< All NaNs go first, in input order
+		RADIX_NANS_LAST		= (1<<4),	//!< All NaNs go last, in input order
+		RADIX_TOTAL_ORDER	= (1<<5),	//!< IEEE totalOrder: negative NaNs first, positive NaNs last
+	};
+
+	#define RADIX_NAN_POLICY	(RADIX_NANS_FIRST|RADIX_NANS_LAST|RADIX_TOTAL_ORDER)
+
+	//! Everything the caller knows about the input values. Hints are trusted: wrong hints give wrong results.
+	struct RadixHints
+	{
+		inline_	RadixHints(RadixHint sign=RADIX_SIGNED, udword flags=0, udword nb_bits=32) : mSign(sign), mFlags(flags), mNbBits(nb_bits)	{}
+
+		//! Checks whether values can be sorted as unsigned integers
+		inline_	bool		IsUnsigned()	const	{ return mSign==RADIX_UNSIGNED || (mFlags & RADIX_POSITIVE);	}
+		//! Returns the number of passes needed for a given radix width
+		inline_	udword		GetNbPasses(udword nb_radix_bits, udword max_nb_passes)	const
+							{
+								const udword NbPasses = (mNbBits + nb_radix_bits - 1)/nb_radix_bits;
+								return NbPasses<1 ? 1 : NbPasses>max_nb_passes ? max_nb_passes : NbPasses;
+							}
+
+				RadixHint	mSign;		//!< RADIX_SIGNED or RADIX_UNSIGNED (integers only)
+				udword		mFlags;		//!< Combination of RadixHintFlag
+				udword		mNbBits;	//!< Input values fit in that many bits (integers only, signed ones sign-extended from that width). 32 = no hint.
+	};
+
+#endif // ICERADIXHINTS_H
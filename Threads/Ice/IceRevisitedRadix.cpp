@@ -38,6 +38,11 @@
  *	- 01.12.06:	added optimizations suggested by Kyle Hubert
  *	- 06.08.08:	removed optimizations from Kyle Hubert, since they made the code crash when negative zeros are involved.
  *				Big thanks to Ignacio Castano for reporting this bug!
+ *	- 10.19.26:	RadixHint enum extended to a RadixHints struct (positive values, number of bits, presorted or random input)
+ *	- 10.19.26:	native ubyte/uword/sword keys, no need to widen them to udwords anymore
+ *	- 10.19.26:	NaN policies for floats (NaNs first, NaNs last, or IEEE totalOrder)
+ *	- 10.19.26:	key traits & templated kernels (IceRadixEngine.h) replace the CREATE_HISTOGRAMS / CHECK_PASS_VALIDITY macros.
+ *				Keys are transformed when read, so negative values don't need a special last pass anymore.
  *
  *	\class		RadixSort
  *	\author		Pierre Terdiman
@@ -60,8 +65,6 @@ To do:
 
 using namespace IceCore;
 
-//#define KYLE_HUBERT_VERSION
-
 #define INVALIDATE_RANKS	mCurrentSize|=0x80000000
 #define VALIDATE_RANKS		mCurrentSize&=0x7fffffff
 #define CURRENT_SIZE		(mCurrentSize&0x7fffffff)
@@ -75,122 +78,12 @@ using namespace IceCore;
 		mPreviousSize = n;																	\
 	}
 
-#if defined(__APPLE__) || defined(_XBOX)
-	#define H0_OFFSET	768
-	#define H1_OFFSET	512
-	#define H2_OFFSET	256
-	#define H3_OFFSET	0
-	#define BYTES_INC	(3-j)
-#else 
-	#define H0_OFFSET	0
-	#define H1_OFFSET	256
-	#define H2_OFFSET	512
-	#define H3_OFFSET	768
-	#define BYTES_INC	j
-#endif
-
-#define CREATE_HISTOGRAMS(type, buffer)														\
-	/* Clear counters/histograms */															\
-	ZeroMemory(Histogram, 256*4*sizeof(udword));											\
-																							\
-	/* Prepare to count */																	\
-	const ubyte* p = (const ubyte*)input;													\
-	const ubyte* pe = &p[nb*4];																\
-	udword* h0 = &Histogram[H0_OFFSET];	/* Histogram for first pass (LSB)	*/				\
-	udword* h1 = &Histogram[H1_OFFSET];	/* Histogram for second pass		*/				\
-	udword* h2 = &Histogram[H2_OFFSET];	/* Histogram for third pass			*/				\
-	udword* h3 = &Histogram[H3_OFFSET];	/* Histogram for last pass (MSB)	*/				\
-																							\
-	bool AlreadySorted = true;	/* Optimism... */											\
-																							\
-	if(INVALID_RANKS)																		\
-	{																						\
-		/* Prepare for temporal coherence */												\
-		const type* Running = (type*)buffer;												\
-		type PrevVal = *Running;															\
-																							\
-		while(p!=pe)																		\
-		{																					\
-			/* Read input buffer in previous sorted order */								\
-			const type Val = *Running++;													\
-			/* Check whether already sorted or not */										\
-			if(Val<PrevVal)	{ AlreadySorted = false; break; } /* Early out */				\
-			/* Update for next iteration */													\
-			PrevVal = Val;																	\
-																							\
-			/* Create histograms */															\
-			h0[*p++]++;	h1[*p++]++;	h2[*p++]++;	h3[*p++]++;									\
-		}																					\
-																							\
-		/* If all input values are already sorted, we just have to return and leave the */	\
-		/* previous list unchanged. That way the routine may take advantage of temporal */	\
-		/* coherence, for example when used to sort transparent faces.					*/	\
-		if(AlreadySorted)																	\
-		{																					\
-			mNbHits++;																		\
-			for(udword i=0;i<nb;i++)	mRanks[i] = i;										\
-			return *this;																	\
-		}																					\
-	}																						\
-	else																					\
-	{																						\
-		/* Prepare for temporal coherence */												\
-		const udword* Indices = mRanks;														\
-		type PrevVal = (type)buffer[*Indices];												\
-																							\
-		while(p!=pe)																		\
-		{																					\
-			/* Read input buffer in previous sorted order */								\
-			const type Val = (type)buffer[*Indices++];										\
-			/* Check whether already sorted or not */										\
-			if(Val<PrevVal)	{ AlreadySorted = false; break; } /* Early out */				\
-			/* Update for next iteration */													\
-			PrevVal = Val;																	\
-																							\
-			/* Create histograms */															\
-			h0[*p++]++;	h1[*p++]++;	h2[*p++]++;	h3[*p++]++;									\
-		}																					\
-																							\
-		/* If all input values are already sorted, we just have to return and leave the */	\
-		/* previous list unchanged. That way the routine may take advantage of temporal */	\
-		/* coherence, for example when used to sort transparent faces.					*/	\
-		if(AlreadySorted)	{ mNbHits++; return *this;	}									\
-	}																						\
-																							\
-	/* Else there has been an early out and we must finish computing the histograms */		\
-	while(p!=pe)																			\
-	{																						\
-		/* Create histograms without the previous overhead */								\
-		h0[*p++]++;	h1[*p++]++;	h2[*p++]++;	h3[*p++]++;										\
-	}
-
-#define CHECK_PASS_VALIDITY(pass)															\
-	/* Shortcut to current counters */														\
-	const udword* CurCount = &Histogram[pass<<8];											\
-																							\
-	/* Reset flag. The sorting pass is supposed to be performed. (default) */				\
-	bool PerformPass = true;																\
-																							\
-	/* Check pass validity */																\
-																							\
-	/* If all values have the same byte, sorting is useless. */								\
-	/* It may happen when sorting bytes or words instead of dwords. */						\
-	/* This routine actually sorts words faster than dwords, and bytes */					\
-	/* faster than words. Standard running time (O(4*n))is reduced to O(2*n) */				\
-	/* for words and O(n) for bytes. Running time for floats depends on actual values... */	\
-																							\
-	/* Get first byte */																	\
-	const ubyte UniqueVal = *(((ubyte*)input)+pass);										\
-																							\
-	/* Check that byte's counter */															\
-	if(CurCount[UniqueVal]==nb)	PerformPass=false;
-
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Constructor.
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-RadixSort::RadixSort() : mRanks(null), mRanks2(null), mCurrentSize(0), mTotalCalls(0), mNbHits(0), mDeleteRanks(true)
+RadixSort::RadixSort() : mRanks(null), mRanks2(null), mCurrentSize(0), mTotalCalls(0), mNbHits(0), mNbNaNs(0), mDeleteRanks(true)
 {
 	// Initialize indices
 	INVALIDATE_RANKS;
@@ -203,6 +96,9 @@ RadixSort::RadixSort() : mRanks(null), mRanks2(null), mCurrentSize(0), mTotalCal
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 RadixSort::~RadixSort()
 {
+	// Wait for pending asynchronous sort, if any
+	mFuture.Wait();
+
 	// Release everything
 	if(mDeleteRanks)
 	{
@@ -250,124 +146,17 @@ inline_ void RadixSort::CheckResize(udword nb)
  *	This one is for integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
  *	\param		input	[in] a list of integer values to sort
  *	\param		nb		[in] number of values to sort, must be < 2^31
- *	\param		hint	[in] RADIX_SIGNED to handle negative values, RADIX_UNSIGNED if you know your input buffer only contains positive values
+ *	\param		hints	[in] RADIX_SIGNED to handle negative values, RADIX_UNSIGNED if you know your input buffer only contains positive values.
+ *							Extra hints (RADIX_POSITIVE, RADIX_PRESORTED, RADIX_RANDOM, number of bits) can be passed in a RadixHints struct.
  *	\return		Self-Reference
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-RadixSort& RadixSort::Sort(const udword* input, udword nb, RadixHint hint)
+RadixSort& RadixSort::Sort(const udword* input, udword nb, const RadixHints& hints)
 {
-	// Checkings
-	if(!input || !nb || nb&0x80000000)	return *this;
-
-	// Stats
-	mTotalCalls++;
-
-	// Resize lists if needed
-	CheckResize(nb);
-
-	// Allocate histograms & offsets on the stack
-	udword Histogram[256*4];
-//	udword mOffset[256];
-	udword* Link[256];
-
-	// Create histograms (counters). Counters for all passes are created in one run.
-	// Pros:	read input buffer once instead of four times
-	// Cons:	mHistogram is 4Kb instead of 1Kb
-	// We must take care of signed/unsigned values for temporal coherence.... I just
-	// have 2 code paths even if just a single opcode changes. Self-modifying code, someone?
-	if(hint==RADIX_UNSIGNED)	{ CREATE_HISTOGRAMS(udword, input);	}
-	else						{ CREATE_HISTOGRAMS(sdword, input);	}
-
-	// Radix sort, j is the pass number (0=LSB, 3=MSB)
-	for(udword j=0;j<4;j++)
-	{
-		CHECK_PASS_VALIDITY(j);
-
-		// Sometimes the fourth (negative) pass is skipped because all numbers are negative and the MSB is 0xFF (for example). This is
-		// not a problem, numbers are correctly sorted anyway.
-		if(PerformPass)
-		{
-			// Should we care about negative values?
-			if(j!=3 || hint==RADIX_UNSIGNED)
-			{
-				// Here we deal with positive values only
-
-				// Create offsets
-//				mOffset[0] = 0;
-//				for(udword i=1;i<256;i++)		mOffset[i] = mOffset[i-1] + CurCount[i-1];
-				Link[0] = mRanks2;
-				for(udword i=1;i<256;i++)		Link[i] = Link[i-1] + CurCount[i-1];
-			}
-			else
-			{
-				// This is a special case to correctly handle negative integers. They're sorted in the right order but at the wrong place.
-
-#ifdef KYLE_HUBERT_VERSION
-				// From Kyle Hubert:
-
-				//mOffset[128] = 0;
-				mLink[128] = mRanks2;
-				//for(i=129;i<256;i++)	mOffset[i] = mOffset[i-1] + CurCount[i-1];
-				for(udword i=129;i<256;i++)	mLink[i] = mLink[i-1] + CurCount[i-1];
-
-				//mOffset[0] = mOffset[255] + CurCount[255];
-				mLink[0] = mLink[255] + CurCount[255];
-				//for(i=1;i<128;i++)	mOffset[i] = mOffset[i-1] + CurCount[i-1];
-				for(udword i=1;i<128;i++)	mLink[i] = mLink[i-1] + CurCount[i-1];
-#else
-				// Compute #negative values involved if needed
-				udword NbNegativeValues = 0;
-				if(hint==RADIX_SIGNED)
-				{
-					// An efficient way to compute the number of negatives values we'll have to deal with is simply to sum the 128
-					// last values of the last histogram. Last histogram because that's the one for the Most Significant Byte,
-					// responsible for the sign. 128 last values because the 128 first ones are related to positive numbers.
-					const udword* h3 = &Histogram[H3_OFFSET];
-					for(udword i=128;i<256;i++)	NbNegativeValues += h3[i];	// 768 for last histogram, 128 for negative part
-				}
-
-				// Create biased offsets, in order for negative numbers to be sorted as well
-//				mOffset[0] = NbNegativeValues;												// First positive number takes place after the negative ones
-//				for(udword i=1;i<128;i++)		mOffset[i] = mOffset[i-1] + CurCount[i-1];	// 1 to 128 for positive numbers
-				Link[0] = &mRanks2[NbNegativeValues];										// First positive number takes place after the negative ones
-				for(udword i=1;i<128;i++)		Link[i] = Link[i-1] + CurCount[i-1];		// 1 to 128 for positive numbers
-
-				// Fixing the wrong place for negative values
-//				mOffset[128] = 0;
-//				for(i=129;i<256;i++)			mOffset[i] = mOffset[i-1] + CurCount[i-1];
-				Link[128] = mRanks2;
-				for(udword i=129;i<256;i++)		Link[i] = Link[i-1] + CurCount[i-1];
-#endif
-			}
-
-			// Perform Radix Sort
-			const ubyte* InputBytes	= (const ubyte*)input;
-			InputBytes += BYTES_INC;
-			if(INVALID_RANKS)
-			{
-//				for(udword i=0;i<nb;i++)	mRanks2[mOffset[InputBytes[i<<2]]++] = i;
-				for(udword i=0;i<nb;i++)	*Link[InputBytes[i<<2]]++ = i;
-				VALIDATE_RANKS;
-			}
-			else
-			{
-				const udword* Indices		= mRanks;
-				const udword* IndicesEnd	= &mRanks[nb];
-				while(Indices!=IndicesEnd)
-				{
-					const udword id = *Indices++;
-//					mRanks2[mOffset[InputBytes[id<<2]]++] = id;
-					*Link[InputBytes[id<<2]]++ = id;
-				}
-			}
-
-			// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
-			udword* Tmp = mRanks;
-			mRanks = mRanks2;
-			mRanks2 = Tmp;
-		}
-	}
-	return *this;
+	// Plan ahead: values known to be positive don't need the sign flip, and small values need less passes
+	const udword NbPasses = hints.GetNbPasses(8, 4);
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU32>(input, nb, NbPasses, hints);
+	else					return SortKeys<RadixKeyS32>(input, nb, NbPasses, hints);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -376,182 +165,169 @@ RadixSort& RadixSort::Sort(const udword* input, udword nb, RadixHint hint)
  *	This one is for floating-point values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
  *	\param		input			[in] a list of floating-point values to sort
  *	\param		nb				[in] number of values to sort, must be < 2^31
+ *	\param		hints			[in] RADIX_POSITIVE if you know all values are positive, RADIX_PRESORTED or RADIX_RANDOM to tweak temporal coherence,
+ *								RADIX_NANS_FIRST, RADIX_NANS_LAST or RADIX_TOTAL_ORDER to define where NaNs go
  *	\return		Self-Reference
  *	\warning	only sorts IEEE floating-point values
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-RadixSort& RadixSort::Sort(const float* input2, udword nb)
+RadixSort& RadixSort::Sort(const float* input2, udword nb, const RadixHints& hints)
 {
 	// Checkings
+	mNbNaNs = 0;
 	if(!input2 || !nb || nb&0x80000000)	return *this;
 
-	// Stats
-	mTotalCalls++;
+	// NaNs without a policy end up wherever their bit patterns put them
+	if(hints.mFlags & RADIX_NAN_POLICY)
+		return SortFloatsWithPolicy(input2, nb, hints);
 
+	// Positive floats sort like unsigned integers. Others are compared as sortable keys for temporal coherence, so the
+	// dreadful floating-point comparison is gone as well.
 	const udword* input = (const udword*)input2;
+	if(hints.mFlags & RADIX_POSITIVE)	return SortKeys<RadixKeyU32>(input, nb, 4, hints);
+	else								return SortKeys<RadixKeyF32>(input, nb, 4, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Generic sort routine. Traits transform the keys so that they sort as unsigned values, so there is no special last pass for
+ *	negative values. Keys are transformed each time they're read, the input is never copied.
+ *	\param		input		[in] a list of keys to sort
+ *	\param		nb			[in] number of values to sort, must be < 2^31
+ *	\param		nb_passes	[in] number of 8-bit passes
+ *	\param		hints		[in] extra hints (RADIX_PRESORTED, RADIX_RANDOM)
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class Traits>
+RadixSort& RadixSort::SortKeys(const typename Traits::Type* input, udword nb, udword nb_passes, const RadixHints& hints)
+{
+	typedef RadixEngine<Traits, 8>	Engine;
+
+	// Checkings
+	if(!input || !nb || nb&0x80000000)	return *this;
+
+	// Stats
+	mTotalCalls++;
 
 	// Resize lists if needed
 	CheckResize(nb);
 
-	// Allocate histograms & offsets on the stack
-	udword Histogram[256*4];
-//	udword mOffset[256];
-	udword* Link[256];
-
-	// Create histograms (counters). Counters for all passes are created in one run.
-	// Pros:	read input buffer once instead of four times
-	// Cons:	mHistogram is 4Kb instead of 1Kb
-	// Floating-point values are always supposed to be signed values, so there's only one code path there.
-	// Please note the floating point comparison needed for temporal coherence! Although the resulting asm code
-	// is dreadful, this is surprisingly not such a performance hit - well, I suppose that's a big one on first
-	// generation Pentiums....We can't make comparison on integer representations because, as Chris said, it just
-	// wouldn't work with mixed positive/negative values....
-	{ CREATE_HISTOGRAMS(float, input2); }
-
-	// Radix sort, j is the pass number (0=LSB, 3=MSB)
-	for(udword j=0;j<4;j++)
+	// Allocate histograms on the stack. Counters for all passes are created in one run.
+	udword Histogram[Engine::HistogramSize];
+
+	RadixRanks<udword> Ranks = { mRanks, mRanks2, !INVALID_RANKS };
+	if(Engine::Sort(input, nb, nb_passes, hints, Histogram, Ranks))
+		mNbHits++;
+	mRanks	= Ranks.mRanks;
+	mRanks2	= Ranks.mRanks2;
+	VALIDATE_RANKS;
+	return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Sort routine for floating-point values with a NaN policy. Keys are transformed to IEEE totalOrder when they're read, and NaNs
+ *	are optionally remapped to the first or last key. So NaNs are placed during the sort itself, and they end up contiguous at one
+ *	end (or both ends for totalOrder) where we count them.
+ *	\param		input	[in] a list of floating-point values to sort
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] NaN policy & extra hints
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+RadixSort& RadixSort::SortFloatsWithPolicy(const float* input, udword nb, const RadixHints& hints)
+{
+	const udword* Bits = (const udword*)input;
+	const bool NaNsFirst = (hints.mFlags & RADIX_NANS_FIRST)!=0;
+	const bool NaNsLast = !NaNsFirst && (hints.mFlags & RADIX_NANS_LAST);
+
+	if(NaNsFirst)		SortKeys<RadixKeyF32NaNsFirst>(Bits, nb, 4, hints);
+	else if(NaNsLast)	SortKeys<RadixKeyF32NaNsLast>(Bits, nb, 4, hints);
+	else				SortKeys<RadixKeyF32>(Bits, nb, 4, hints);
+
+	// Count NaNs from both ends of the sorted list, it only touches the NaNs themselves
+	udword NbNaNs = 0;
+	if(!NaNsLast)
+	{
+		while(NbNaNs<nb && RadixKeyF32NaNsFirst::IsNaN(Bits[mRanks[NbNaNs]]))	NbNaNs++;
+	}
+	if(!NaNsFirst)
 	{
-		// Should we care about negative values?
-		if(j!=3)
-		{
-			// Here we deal with positive values only
-			CHECK_PASS_VALIDITY(j);
-
-			if(PerformPass)
-			{
-				// Create offsets
-//				mOffset[0] = 0;
-				Link[0] = mRanks2;
-//				for(udword i=1;i<256;i++)		mOffset[i] = mOffset[i-1] + CurCount[i-1];
-				for(udword i=1;i<256;i++)		Link[i] = Link[i-1] + CurCount[i-1];
-
-				// Perform Radix Sort
-				const ubyte* InputBytes = (const ubyte*)input;
-				InputBytes += BYTES_INC;
-				if(INVALID_RANKS)
-				{
-//					for(i=0;i<nb;i++)	mRanks2[mOffset[InputBytes[i<<2]]++] = i;
-					for(udword i=0;i<nb;i++)	*Link[InputBytes[i<<2]]++ = i;
-					VALIDATE_RANKS;
-				}
-				else
-				{
-					const udword* Indices		= mRanks;
-					const udword* IndicesEnd	= &mRanks[nb];
-					while(Indices!=IndicesEnd)
-					{
-						const udword id = *Indices++;
-//						mRanks2[mOffset[InputBytes[id<<2]]++] = id;
-						*Link[InputBytes[id<<2]]++ = id;
-					}
-				}
-
-				// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
-				udword* Tmp = mRanks;
-				mRanks = mRanks2;
-				mRanks2 = Tmp;
-			}
-		}
-		else
-		{
-			// This is a special case to correctly handle negative values
-			CHECK_PASS_VALIDITY(j);
-
-			if(PerformPass)
-			{
-#ifdef KYLE_HUBERT_VERSION
-				// From Kyle Hubert:
-
-				//mOffset[255] = CurCount[255];
-				mLink[255] = mRanks2 + CurCount[255];
-				//for(udword i=254;i>127;i--)	mOffset[i] = mOffset[i+1] + CurCount[i];
-				for(udword i=254;i>127;i--)	mLink[i] = mLink[i+1] + CurCount[i];
-				//mOffset[0] = mOffset[128] + CurCount[128];
-				mLink[0] = mLink[128] + CurCount[128];
-				//for(udword i=1;i<128;i++)	mOffset[i] = mOffset[i-1] + CurCount[i-1];
-				for(udword i=1;i<128;i++)	mLink[i] = mLink[i-1] + CurCount[i-1];
-#else
-				// Compute #negative values involved if needed
-				udword NbNegativeValues = 0;
-				// An efficient way to compute the number of negatives values we'll have to deal with is simply to sum the 128
-				// last values of the last histogram. Last histogram because that's the one for the Most Significant Byte,
-				// responsible for the sign. 128 last values because the 128 first ones are related to positive numbers.
-				// ### is that ok on Apple ?!
-				const udword* h3 = &Histogram[H3_OFFSET];
-				for(udword i=128;i<256;i++)	NbNegativeValues += h3[i];	// 768 for last histogram, 128 for negative part
-
-				// Create biased offsets, in order for negative numbers to be sorted as well
-//				mOffset[0] = NbNegativeValues;												// First positive number takes place after the negative ones
-//				for(udword i=1;i<128;i++)		mOffset[i] = mOffset[i-1] + CurCount[i-1];	// 1 to 128 for positive numbers
-				Link[0] = &mRanks2[NbNegativeValues];										// First positive number takes place after the negative ones
-				for(udword i=1;i<128;i++)		Link[i] = Link[i-1] + CurCount[i-1];		// 1 to 128 for positive numbers
-
-				// We must reverse the sorting order for negative numbers!
-//				mOffset[255] = 0;
-//				for(i=0;i<127;i++)		mOffset[254-i] = mOffset[255-i] + CurCount[255-i];	// Fixing the wrong order for negative values
-//				for(i=128;i<256;i++)	mOffset[i] += CurCount[i];							// Fixing the wrong place for negative values
-				Link[255] = mRanks2;
-				for(udword i=0;i<127;i++)	Link[254-i] = Link[255-i] + CurCount[255-i];	// Fixing the wrong order for negative values
-				for(udword i=128;i<256;i++)	Link[i] += CurCount[i];							// Fixing the wrong place for negative values
-#endif
-				// Perform Radix Sort
-				if(INVALID_RANKS)
-				{
-					for(udword i=0;i<nb;i++)
-					{
-						const udword Radix = input[i]>>24;						// Radix byte, same as above. AND is useless here (udword).
-						// ### cmp to be killed. Not good. Later.
-//						if(Radix<128)		mRanks2[mOffset[Radix]++] = i;		// Number is positive, same as above
-//						else				mRanks2[--mOffset[Radix]] = i;		// Number is negative, flip the sorting order
-						if(Radix<128)		*Link[Radix]++ = i;		// Number is positive, same as above
-						else				*(--Link[Radix]) = i;	// Number is negative, flip the sorting order
-					}
-					VALIDATE_RANKS;
-				}
-				else
-				{
-					for(udword i=0;i<nb;i++)
-					{
-						const udword Radix = input[mRanks[i]]>>24;						// Radix byte, same as above. AND is useless here (udword).
-						// ### cmp to be killed. Not good. Later.
-//						if(Radix<128)		mRanks2[mOffset[Radix]++] = mRanks[i];		// Number is positive, same as above
-//						else				mRanks2[--mOffset[Radix]] = mRanks[i];		// Number is negative, flip the sorting order
-						if(Radix<128)		*Link[Radix]++ = mRanks[i];		// Number is positive, same as above
-						else				*(--Link[Radix]) = mRanks[i];	// Number is negative, flip the sorting order
-					}
-				}
-				// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
-				udword* Tmp = mRanks;
-				mRanks = mRanks2;
-				mRanks2 = Tmp;
-			}
-			else
-			{
-				// The pass is useless, yet we still have to reverse the order of current list if all values are negative.
-				if(UniqueVal>=128)
-				{
-					if(INVALID_RANKS)
-					{
-						// ###Possible?
-						for(udword i=0;i<nb;i++)	mRanks2[i] = nb-i-1;
-						VALIDATE_RANKS;
-					}
-					else
-					{
-						for(udword i=0;i<nb;i++)	mRanks2[i] = mRanks[nb-i-1];
-					}
-
-					// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
-					udword* Tmp = mRanks;
-					mRanks = mRanks2;
-					mRanks2 = Tmp;
-				}
-			}
-		}
+		udword i = nb;
+		while(i>NbNaNs && RadixKeyF32NaNsFirst::IsNaN(Bits[mRanks[i-1]]))	{ i--; NbNaNs++;	}
 	}
+	mNbNaNs = NbNaNs;
 	return *this;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for 16-bit integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of 16-bit values to sort
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] RADIX_UNSIGNED by default, RADIX_SIGNED to interpret the values as signed words
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+RadixSort& RadixSort::Sort(const uword* input, udword nb, const RadixHints& hints)
+{
+	const udword NbPasses = hints.GetNbPasses(8, 2);
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU16>(input, nb, NbPasses, hints);
+	else					return SortKeys<RadixKeyS16>((const sword*)input, nb, NbPasses, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for signed 16-bit integer values. After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		input	[in] a list of 16-bit values to sort
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] RADIX_SIGNED by default, RADIX_UNSIGNED or RADIX_POSITIVE if you know all values are positive
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+RadixSort& RadixSort::Sort(const sword* input, udword nb, const RadixHints& hints)
+{
+	const udword NbPasses = hints.GetNbPasses(8, 2);
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU16>((const uword*)input, nb, NbPasses, hints);
+	else					return SortKeys<RadixKeyS16>(input, nb, NbPasses, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for 8-bit integer values, sorted in a single pass. After the call, mRanks contains a list of indices in sorted order.
+ *	\param		input	[in] a list of 8-bit values to sort
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] RADIX_UNSIGNED by default, RADIX_SIGNED to interpret the values as signed bytes
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+RadixSort& RadixSort::Sort(const ubyte* input, udword nb, const RadixHints& hints)
+{
+	if(hints.IsUnsigned())	return SortKeys<RadixKeyU8>(input, nb, 1, hints);
+	else					return SortKeys<RadixKeyS8>((const sbyte*)input, nb, 1, hints);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one is for IEEE half floats (binary16), read directly as 16-bit values. After the call, mRanks contains a list of indices in sorted order.
+ *	\param		input	[in] a list of half floats to sort
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] RADIX_POSITIVE if you know all values are positive, RADIX_PRESORTED or RADIX_RANDOM to tweak temporal coherence
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+RadixSort& RadixSort::SortHalfFloats(const uword* input, udword nb, const RadixHints& hints)
+{
+	// Positive half floats sort like unsigned integers. Negative ones get all their bits flipped, like the float version.
+	if(hints.mFlags & RADIX_POSITIVE)	return SortKeys<RadixKeyU16>(input, nb, 2, hints);
+	else								return SortKeys<RadixKeyF16>(input, nb, 2, hints);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Gets the ram used.
@@ -565,6 +341,48 @@ udword RadixSort::GetUsedRam() const
 	return UsedRam;
 }
 
+static const udword* SortIntegersAsync(void* sorter, const void* input, udword nb, const RadixHints& hints)
+{
+	return static_cast<RadixSort*>(sorter)->Sort(reinterpret_cast<const udword*>(input), nb, hints).GetRanks();
+}
+
+static const udword* SortFloatsAsync(void* sorter, const void* input, udword nb, const RadixHints& hints)
+{
+	return static_cast<RadixSort*>(sorter)->Sort(reinterpret_cast<const float*>(input), nb, hints).GetRanks();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Asynchronous sort routine.
+ *	This one is for integer values. The sort runs on the shared sort thread pool, the calling thread continues immediately.
+ *	\param		input	[in] a list of integer values to sort, must stay valid until the future is done
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] same as for Sort()
+ *	\return		the future, to poll, wait on, or chain continuations. Ranks are available from there once it's done.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortFuture& RadixSort::SortAsync(const udword* input, udword nb, const RadixHints& hints)
+{
+	mFuture.Launch(SortIntegersAsync, this, input, nb, hints);
+	return mFuture;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Asynchronous sort routine.
+ *	This one is for floating-point values. The sort runs on the shared sort thread pool, the calling thread continues immediately.
+ *	\param		input	[in] a list of floating-point values to sort, must stay valid until the future is done
+ *	\param		nb		[in] number of values to sort, must be < 2^31
+ *	\param		hints	[in] same as for Sort()
+ *	\return		the future, to poll, wait on, or chain continuations. Ranks are available from there once it's done.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortFuture& RadixSort::SortAsync(const float* input, udword nb, const RadixHints& hints)
+{
+	mFuture.Launch(SortFloatsAsync, this, input, nb, hints);
+	return mFuture;
+}
+
 bool RadixSort::SetRankBuffers(udword* ranks0, udword* ranks1)
 {
 	if(!ranks0 || !ranks1)	return false;
@@ -574,3 +392,4 @@ bool RadixSort::SetRankBuffers(udword* ranks0, udword* ranks1)
 	mDeleteRanks	= false;
 	return true;
 }
+
@@ -12,14 +12,6 @@
 #ifndef ICERADIXSORT_H
 #define ICERADIXSORT_H
 
-	enum RadixHint
-	{
-		RADIX_SIGNED,		//!< Input values are signed
-		RADIX_UNSIGNED,		//!< Input values are unsigned
-
-		RADIX_FORCE_DWORD = 0x7fffffff
-	};
-
 	class ICECORE_API RadixSort : public Allocateable
 	{
 		public:
@@ -27,8 +19,17 @@
 								RadixSort();
 								~RadixSort();
 		// Sorting methods
-				RadixSort&		Sort(const udword* input, udword nb, RadixHint hint=RADIX_SIGNED);
-				RadixSort&		Sort(const float* input, udword nb);
+				RadixSort&		Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				RadixSort&		Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+		// Sorting methods for narrow keys. They read the keys directly and only need 1 or 2 passes.
+				RadixSort&		Sort(const uword* input, udword nb, const RadixHints& hints=RADIX_UNSIGNED);
+				RadixSort&		Sort(const sword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				RadixSort&		Sort(const ubyte* input, udword nb, const RadixHints& hints=RADIX_UNSIGNED);
+		// Sorting method for IEEE half floats, stored as 16-bit values
+				RadixSort&		SortHalfFloats(const uword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+		// Asynchronous sorting methods, running on the shared sort thread pool. Don't call Sort() while an asynchronous sort is pending.
+				SortFuture&		SortAsync(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				SortFuture&		SortAsync(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
 
 		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data
 		inline_	const udword*	GetRanks()			const	{ return mRanks;		}
@@ -36,12 +37,17 @@
 		//! mIndices2 gets trashed on calling the sort routine, but otherwise you can recycle it the way you want.
 		inline_	udword*			GetRecyclable()		const	{ return mRanks2;		}
 
+		//! Forgets the previous ranks: the next sort starts from the input order instead, and equal values keep that order.
+		inline_	void			ResetRanks()				{ mCurrentSize|=0x80000000;	}
+
 		// Stats
 				udword			GetUsedRam()		const;
 		//! Returns the total number of calls to the radix sorter.
 		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
 		//! Returns the number of eraly exits due to temporal coherence.
 		inline_	udword			GetNbHits()			const	{ return mNbHits;		}
+		//! Returns the number of NaNs found by the last float sort, when a NaN policy was used.
+		inline_	udword			GetNbNaNs()			const	{ return mNbNaNs;		}
 
 				bool			SetRankBuffers(udword* ranks0, udword* ranks1);
 
@@ -53,11 +59,17 @@
 		// Stats
 				udword			mTotalCalls;		//!< Total number of calls to the sort routine
 				udword			mNbHits;			//!< Number of early exits due to coherence
+				udword			mNbNaNs;			//!< Number of NaNs found by the last float sort
+		// Async
+				SortFuture		mFuture;			//!< Pending asynchronous sort
 		// Stack-radix
 				bool			mDeleteRanks;		//!<
 		// Internal methods
 				void			CheckResize(udword nb);
 				bool			Resize(udword nb);
+				RadixSort&		SortFloatsWithPolicy(const float* input, udword nb, const RadixHints& hints);
+		template<class Traits>
+				RadixSort&		SortKeys(const typename Traits::Type* input, udword nb, udword nb_passes, const RadixHints& hints);
 	};
 
 	#define StackRadixSort(name, ranks0, ranks1)	\
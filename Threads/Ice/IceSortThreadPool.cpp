@@ -0,0 +1,530 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a worker pool for asynchronous sorts.
+ *	\file		IceSortThreadPool.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A basic pool of worker threads, shared by all sorters. Sort() blocks the calling thread until the sort is done,
+ *	SortAsync() doesn't: it queues the sort on the pool and returns a SortFuture that can be polled, waited on,
+ *	or given continuations (for example to permute a payload with the resulting ranks). That way the sort for
+ *	frame N+1 can overlap frame N's rendering.
+ *
+ *	Jobs are intrusive (no allocation). When the pool has no worker thread, jobs simply run on the calling thread.
+ *
+ *	Jobs submitted by a worker (e.g. sub-tasks of a parallel sort) go to that worker's own deque. The worker runs
+ *	them last-in first-out, which keeps its data in cache, while idle workers steal the oldest ones, i.e. the
+ *	biggest chunks of work. Jobs submitted from other threads go to a shared FIFO queue.
+ *
+ *	The pool is only the default SortExecutor. Applications with their own job system can implement SortExecutor
+ *	on top of it and pass it to SetSortExecutor(): parallel & asynchronous sorts then run on their workers, and the
+ *	pool is never created. SerialSortExecutor runs everything on the calling thread.
+ *
+ *	\class		SortThreadPool
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortThreadPool::SortThreadPool() : mThreads(null), mNbThreads(0), mFirstJob(null), mLastJob(null), mQueues(null), mNbPendingJobs(0), mQuit(false), mThreadInit(null), mThreadInitData(null)
+{
+}
+
+// Identifies the worker threads, for work stealing
+static thread_local SortThreadPool*	gCurrentPool = null;
+static thread_local udword			gWorkerIndex = INVALID_ID;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortThreadPool::~SortThreadPool()
+{
+	Release();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Starts the worker threads.
+ *	\param		nb_threads	[in] number of worker threads (0 to run jobs on the calling thread)
+ *	\param		thread_init	[in] function called by each worker thread before it runs any job, with the worker index, or null
+ *	\param		user_data	[in] user-defined data passed to thread_init
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SortThreadPool::Init(udword nb_threads, SortTaskFunction thread_init, void* user_data)
+{
+	Release();
+
+	if(!nb_threads)	return true;
+
+	mThreads = new std::thread[nb_threads];
+	CHECKALLOC(mThreads);
+	mQueues = new SortWorkerQueue[nb_threads];
+	CHECKALLOC(mQueues);
+
+	mQuit = false;
+	mThreadInit = thread_init;
+	mThreadInitData = user_data;
+	mNbThreads = nb_threads;
+	for(udword i=0;i<nb_threads;i++)
+		mThreads[i] = std::thread(&SortThreadPool::WorkerLoop, this, i);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Stops the worker threads. Pending jobs are executed first.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SortThreadPool::Release()
+{
+	if(!mThreads)	return;
+
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		mQuit = true;
+	}
+	mCondition.notify_all();
+
+	for(udword i=0;i<mNbThreads;i++)
+		mThreads[i].join();
+
+	DELETEARRAY(mQueues);
+	DELETEARRAY(mThreads);
+	mNbThreads = 0;
+	mQuit = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Queues a job. The job must stay alive until it has been executed.
+ *	\param		job		[in] the job to run
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SortThreadPool::Submit(SortJob* job)
+{
+	if(!job)	return;
+
+	if(!mNbThreads)
+	{
+		job->Execute();
+		return;
+	}
+
+	// Counted first, so that the counter never goes below the number of queued jobs
+	mNbPendingJobs++;
+	job->mNextJob = null;
+
+	bool Queued = false;
+	if(IsWorkerThread())
+	{
+		SortWorkerQueue& Queue = mQueues[gWorkerIndex];
+		std::lock_guard<std::mutex> Lock(Queue.mMutex);
+		if(Queue.mNb<SORT_WORKER_QUEUE_SIZE)
+		{
+			Queue.mJobs[(Queue.mFirst + Queue.mNb++) % SORT_WORKER_QUEUE_SIZE] = job;
+			Queued = true;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		if(!Queued)
+		{
+			if(mLastJob)	mLastJob->mNextJob = job;
+			else			mFirstJob = job;
+			mLastJob = job;
+		}
+	}
+	// Notified after taking the lock, so that a worker about to sleep can't miss the job
+	mCondition.notify_one();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Runs one pending job on the calling thread. Threads waiting for their jobs should call this instead of blocking:
+ *	it keeps all cores busy, and it can't deadlock when a worker waits for its own sub-jobs.
+ *	\return		true if a job has been executed
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SortThreadPool::RunPendingJob()
+{
+	SortJob* Job = PopJob(IsWorkerThread() ? gWorkerIndex : INVALID_ID);
+	if(!Job)	return false;
+
+	Job->Execute();
+	return true;
+}
+
+namespace
+{
+	// Shared by all the jobs of a ParallelFor call
+	struct ParallelForContext
+	{
+		SortTaskFunction	mFunction;
+		void*				mUserData;
+		udword				mNb;
+		std::atomic<udword>	mNextIndex;		//!< Next item to process
+		std::atomic<udword>	mNbRunning;		//!< Jobs not done yet
+
+		void	Run()
+		{
+			udword Index;
+			while((Index = mNextIndex++) < mNb)
+				(mFunction)(Index, mUserData);
+		}
+	};
+
+	// Each job grabs items until there's none left, so a slow worker doesn't hold the others back
+	class ParallelForJob : public SortJob
+	{
+		public:
+		virtual	void			Execute()
+								{
+									ParallelForContext* Context = mContext;
+									Context->Run();
+									// The job array is freed as soon as the counter reaches zero
+									Context->mNbRunning--;
+								}
+
+				ParallelForContext*	mContext;
+	};
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Runs a function over a range of items, in parallel. The calling thread processes items too, then runs pending jobs
+ *	until the other ones are done, so this can be called from a worker thread.
+ *	\param		nb			[in] number of items
+ *	\param		function	[in] function called for each item
+ *	\param		user_data	[in] user-defined data passed to the function
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SortThreadPool::ParallelFor(udword nb, SortTaskFunction function, void* user_data)
+{
+	if(!nb || !function)	return;
+
+	const udword NbJobs = nb-1 < mNbThreads ? nb-1 : mNbThreads;
+	ParallelForJob* Jobs = NbJobs ? new ParallelForJob[NbJobs] : null;
+	if(!Jobs)
+	{
+		for(udword i=0;i<nb;i++)
+			(function)(i, user_data);
+		return;
+	}
+
+	ParallelForContext Context;
+	Context.mFunction	= function;
+	Context.mUserData	= user_data;
+	Context.mNb			= nb;
+	Context.mNextIndex	= 0;
+	Context.mNbRunning	= NbJobs;
+
+	for(udword i=0;i<NbJobs;i++)
+	{
+		Jobs[i].mContext = &Context;
+		Submit(&Jobs[i]);
+	}
+
+	Context.Run();
+
+	Wait(Context.mNbRunning);
+	DELETEARRAY(Jobs);
+}
+
+void SortThreadPool::Wait(const std::atomic<udword>& nb_pending)
+{
+	while(nb_pending)
+	{
+		if(!RunPendingJob())
+			std::this_thread::yield();
+	}
+}
+
+bool SortThreadPool::IsWorkerThread() const
+{
+	return gCurrentPool==this;
+}
+
+SortJob* SortThreadPool::PopJob(udword index)
+{
+	if(!mNbPendingJobs)	return null;
+
+	SortJob* Job = null;
+
+	// Our own jobs first, newest first
+	if(index!=INVALID_ID)
+	{
+		SortWorkerQueue& Queue = mQueues[index];
+		std::lock_guard<std::mutex> Lock(Queue.mMutex);
+		if(Queue.mNb)
+			Job = Queue.mJobs[(Queue.mFirst + --Queue.mNb) % SORT_WORKER_QUEUE_SIZE];
+	}
+
+	// Then the shared queue
+	if(!Job)
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		Job = mFirstJob;
+		if(Job)
+		{
+			mFirstJob = Job->mNextJob;
+			if(!mFirstJob)	mLastJob = null;
+		}
+	}
+
+	// Then steal the oldest job of another worker
+	for(udword i=1;!Job && i<=mNbThreads;i++)
+	{
+		const udword Victim = (index + i) % mNbThreads;
+		if(Victim==index)	continue;
+
+		SortWorkerQueue& Queue = mQueues[Victim];
+		std::lock_guard<std::mutex> Lock(Queue.mMutex);
+		if(Queue.mNb)
+		{
+			Job = Queue.mJobs[Queue.mFirst];
+			Queue.mFirst = (Queue.mFirst + 1) % SORT_WORKER_QUEUE_SIZE;
+			Queue.mNb--;
+		}
+	}
+
+	if(Job)
+		mNbPendingJobs--;
+	return Job;
+}
+
+void SortThreadPool::WorkerLoop(udword index)
+{
+	gCurrentPool = this;
+	gWorkerIndex = index;
+	if(mThreadInit)
+		(mThreadInit)(index, mThreadInitData);
+
+	for(;;)
+	{
+		SortJob* Job = PopJob(index);
+		if(!Job)
+		{
+			std::unique_lock<std::mutex> Lock(mMutex);
+			while(!mNbPendingJobs && !mQuit)
+				mCondition.wait(Lock);
+
+			if(!mNbPendingJobs)	return;	// Quit, and no pending job
+			continue;
+		}
+		// The job might be deleted as soon as it's done, don't touch it after that.
+		Job->Execute();
+	}
+}
+
+static std::mutex		gSortThreadPoolMutex;
+static SortThreadPool*	gSortThreadPool = null;
+
+SortThreadPool* IceCore::GetSortThreadPool()
+{
+	std::lock_guard<std::mutex> Lock(gSortThreadPoolMutex);
+	if(!gSortThreadPool)
+	{
+		const udword NbCores = std::thread::hardware_concurrency();
+		gSortThreadPool = ICE_NEW(SortThreadPool);
+		if(gSortThreadPool)
+			gSortThreadPool->Init(NbCores>2 ? NbCores-1 : 1);
+	}
+	return gSortThreadPool;
+}
+
+void IceCore::ReleaseSortThreadPool()
+{
+	std::lock_guard<std::mutex> Lock(gSortThreadPoolMutex);
+	DELETESINGLE(gSortThreadPool);
+}
+
+static std::atomic<SortExecutor*>	gSortExecutor(null);
+
+void IceCore::SetSortExecutor(SortExecutor* executor)
+{
+	gSortExecutor = executor;
+}
+
+SortExecutor* IceCore::GetSortExecutor()
+{
+	SortExecutor* Executor = gSortExecutor;
+	return Executor ? Executor : GetSortThreadPool();
+}
+
+void SerialSortExecutor::Submit(SortJob* job)
+{
+	if(job)
+		job->Execute();
+}
+
+void SerialSortExecutor::ParallelFor(udword nb, SortTaskFunction function, void* user_data)
+{
+	for(udword i=0;i<nb;i++)
+		(function)(i, user_data);
+}
+
+void SerialSortExecutor::Wait(const std::atomic<udword>& nb_pending)
+{
+	// Jobs ran when submitted, unless they've been submitted to another executor
+	while(nb_pending)
+		std::this_thread::yield();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortFuture::SortFuture() :
+	mFunction			(null),
+	mSorter				(null),
+	mInput				(null),
+	mNb					(0),
+	mRanks				(null),
+	mNbContinuations	(0),
+	mNbExecuted			(0),
+	mLaunched			(false),
+	mDone				(true)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor. Waits for the pending sort, if any.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+SortFuture::~SortFuture()
+{
+	Wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Checks whether the sort and all its continuations are done. This doesn't block.
+ *	\return		true if done
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SortFuture::IsDone() const
+{
+	std::lock_guard<std::mutex> Lock(mMutex);
+	return mDone;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Blocks until the sort and all its continuations are done.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SortFuture::Wait()
+{
+	std::unique_lock<std::mutex> Lock(mMutex);
+	while(!mDone)
+		mCondition.wait(Lock);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Chains a continuation. If the sort is already done, the continuation is queued on the pool on its own.
+ *	\param		callback	[in] function called with the sorted ranks
+ *	\param		user_data	[in] user-defined data passed to the callback
+ *	\return		true if success, false if no sort has been launched or too many continuations are pending
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SortFuture::Then(SortContinuation callback, void* user_data)
+{
+	if(!callback)	return false;
+
+	bool Resubmit = false;
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		if(!mLaunched || mNbContinuations==MAX_SORT_CONTINUATIONS)	return false;
+
+		mContinuations[mNbContinuations].mCallback = callback;
+		mContinuations[mNbContinuations].mUserData = user_data;
+		mNbContinuations++;
+
+		// The job is over, we have to queue it again just for the continuation
+		if(mDone)
+		{
+			mDone = false;
+			Resubmit = true;
+		}
+	}
+
+	if(Resubmit)
+		GetSortExecutor()->Submit(this);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Launches an asynchronous sort. Waits for the previous one first, if needed.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SortFuture::Launch(AsyncSortFunction function, void* sorter, const void* input, udword nb, const RadixHints& hints)
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> Lock(mMutex);
+		mFunction			= function;
+		mSorter				= sorter;
+		mInput				= input;
+		mNb					= nb;
+		mHints				= hints;
+		mRanks				= null;
+		mNbContinuations	= 0;
+		mNbExecuted			= 0;
+		mLaunched			= true;
+		mDone				= false;
+	}
+
+	GetSortExecutor()->Submit(this);
+}
+
+void SortFuture::Execute()
+{
+	if(mFunction)
+	{
+		mRanks = (mFunction)(mSorter, mInput, mNb, mHints);
+		mFunction = null;
+	}
+
+	for(;;)
+	{
+		Continuation Current;
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			if(mNbExecuted==mNbContinuations)
+			{
+				// We're done. Continuations are reset so that new ones can be chained.
+				mNbContinuations = mNbExecuted = 0;
+				mDone = true;
+				mCondition.notify_all();
+				return;
+			}
+			Current = mContinuations[mNbExecuted++];
+		}
+		(Current.mCallback)(mRanks, mNb, Current.mUserData);
+	}
+}
@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a worker pool for asynchronous sorts.
+ *	\file		IceSortThreadPool.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICESORTTHREADPOOL_H
+#define ICESORTTHREADPOOL_H
+
+	//! Base class for jobs running on the sort thread pool
+	class ICECORE_API SortJob
+	{
+		public:
+		inline_					SortJob() : mNextJob(null)	{}
+		virtual					~SortJob()					{}
+
+		virtual	void			Execute()					= 0;
+
+				SortJob*		mNextJob;			//!< Intrusive job queue
+	};
+
+	//! Called by SortExecutor::ParallelFor, once per item
+	typedef void	(*SortTaskFunction)(udword index, void* user_data);
+
+	//! Where the parallel sorters run their jobs. Implement it to run them on an existing job system, see SetSortExecutor().
+	class ICECORE_API SortExecutor
+	{
+		public:
+		virtual					~SortExecutor()		{}
+
+		// Runs a job, now or later, on any thread. The job must stay alive until it has been executed.
+		virtual	void			Submit(SortJob* job)												= 0;
+		// Calls function(i, user_data) for i in [0, nb), possibly in parallel. Returns when all calls are done.
+		virtual	void			ParallelFor(udword nb, SortTaskFunction function, void* user_data)	= 0;
+		// Returns when the counter reaches zero. Submitted jobs decrement their counter when done. This is called from
+		// jobs too, so it should run pending jobs while waiting, rather than block the thread.
+		virtual	void			Wait(const std::atomic<udword>& nb_pending)							= 0;
+		// Number of threads running jobs besides the calling one, used to split the work. 0 for serial executors.
+		virtual	udword			GetNbThreads()		const											= 0;
+	};
+
+	//! Runs everything on the calling thread
+	class ICECORE_API SerialSortExecutor : public SortExecutor
+	{
+		public:
+		virtual	void			Submit(SortJob* job);
+		virtual	void			ParallelFor(udword nb, SortTaskFunction function, void* user_data);
+		virtual	void			Wait(const std::atomic<udword>& nb_pending);
+		virtual	udword			GetNbThreads()		const	{ return 0;	}
+	};
+
+	#define SORT_WORKER_QUEUE_SIZE	256		// Jobs per worker deque, extra ones go to the shared queue
+
+	//! Per-worker job deque. The owner pushes & pops at the back, other threads steal from the front.
+	struct SortWorkerQueue
+	{
+		inline_					SortWorkerQueue() : mFirst(0), mNb(0)	{}
+
+				std::mutex		mMutex;
+				SortJob*		mJobs[SORT_WORKER_QUEUE_SIZE];	//!< Circular buffer
+				udword			mFirst;			//!< Oldest job
+				udword			mNb;			//!< Number of jobs
+	};
+
+	//! Built-in executor: a pool of worker threads
+	class ICECORE_API SortThreadPool : public SortExecutor, public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								SortThreadPool();
+								~SortThreadPool();
+
+				bool			Init(udword nb_threads, SortTaskFunction thread_init=null, void* user_data=null);
+				void			Release();
+
+		// Runs a job on a worker thread. Jobs run immediately on the calling thread when there is no worker.
+		virtual	void			Submit(SortJob* job);
+		// Runs one pending job on the calling thread, if any. Used to help the workers while waiting for them.
+				bool			RunPendingJob();
+		// Calls function(i, user_data) for i in [0, nb), on the workers and the calling thread. Returns when all calls are done.
+		virtual	void			ParallelFor(udword nb, SortTaskFunction function, void* user_data);
+		// Runs pending jobs until the counter reaches zero
+		virtual	void			Wait(const std::atomic<udword>& nb_pending);
+
+		virtual	udword			GetNbThreads()		const	{ return mNbThreads;	}
+		// Checks whether the calling thread is one of our workers
+				bool			IsWorkerThread()	const;
+
+								PREVENT_COPY(SortThreadPool)
+		private:
+				std::thread*	mThreads;			//!< Worker threads
+				udword			mNbThreads;			//!< Number of worker threads
+				std::mutex		mMutex;				//!< Protects the job queue
+				std::condition_variable	mCondition;	//!< Wakes up workers
+				SortJob*		mFirstJob;			//!< Shared job queue (FIFO), for jobs submitted from other threads
+				SortJob*		mLastJob;
+				SortWorkerQueue*	mQueues;		//!< One deque per worker, for jobs submitted by the workers themselves
+				std::atomic<udword>	mNbPendingJobs;	//!< Jobs in all queues
+				bool			mQuit;				//!< Tells workers to exit
+				SortTaskFunction	mThreadInit;	//!< Called by each worker when it starts, e.g. to set its affinity
+				void*			mThreadInitData;
+		// Internal methods
+				void			WorkerLoop(udword index);
+				SortJob*		PopJob(udword index);
+	};
+
+	// Shared pool used by all sorters. Created on first use, with one worker per hardware thread minus one.
+	ICECORE_API	SortThreadPool*	GetSortThreadPool();
+	ICECORE_API	void			ReleaseSortThreadPool();
+
+	// Executor used by default by all sorters, and by asynchronous sorts. Null (the default) selects the shared pool, which is
+	// then only created if needed. Set it before sorting, and keep it alive until sorts are done.
+	ICECORE_API	void			SetSortExecutor(SortExecutor* executor);
+	ICECORE_API	SortExecutor*	GetSortExecutor();
+
+	//! Called on a worker thread once the sort is done, e.g. to permute a payload with the ranks
+	typedef void	(*SortContinuation)(const udword* ranks, udword nb, void* user_data);
+
+	//! Sort function run by a SortFuture. Each sorter provides its own, returning the ranks.
+	typedef const udword*	(*AsyncSortFunction)(void* sorter, const void* input, udword nb, const RadixHints& hints);
+
+	#define MAX_SORT_CONTINUATIONS	8
+
+	//! Handle to an asynchronous sort. Each sorter owns one, so it can only run one asynchronous sort at a time.
+	class ICECORE_API SortFuture : public SortJob
+	{
+		public:
+		// Constructor/Destructor
+								SortFuture();
+		virtual					~SortFuture();
+
+		// Polling & waiting
+				bool			IsDone()			const;
+				void			Wait();
+		// Chains a continuation. It runs after the sort and previous continuations, on a worker thread.
+				bool			Then(SortContinuation callback, void* user_data);
+
+		//! Access to results. Only valid once the future is done.
+		inline_	const udword*	GetRanks()			const	{ return mRanks;	}
+		//! Returns the number of sorted values.
+		inline_	udword			GetNbValues()		const	{ return mNb;		}
+
+		// Internal, used by sorters
+				void			Launch(AsyncSortFunction function, void* sorter, const void* input, udword nb, const RadixHints& hints);
+
+								PREVENT_COPY(SortFuture)
+		protected:
+		virtual	void			Execute();
+		private:
+				AsyncSortFunction	mFunction;		//!< Sort function, or null if already done
+				void*			mSorter;			//!< Sorter running the sort
+				const void*		mInput;				//!< Input values
+				udword			mNb;				//!< Number of input values
+				RadixHints		mHints;				//!< Hints for the sort
+				const udword*	mRanks;				//!< Sorted ranks
+		// Continuations
+				struct Continuation
+				{
+					SortContinuation	mCallback;
+					void*				mUserData;
+				};
+				Continuation	mContinuations[MAX_SORT_CONTINUATIONS];
+				udword			mNbContinuations;	//!< Number of registered continuations
+				udword			mNbExecuted;		//!< Number of already executed continuations
+		// Sync
+		mutable	std::mutex		mMutex;
+				std::condition_variable	mCondition;
+				bool			mLaunched;			//!< Has a sort been launched at all?
+				bool			mDone;				//!< Sort & continuations are done
+	};
+
+#endif // ICESORTTHREADPOOL_H
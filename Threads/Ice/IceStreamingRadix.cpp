@@ -0,0 +1,513 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a streaming radix sort.
+ *	\file		IceStreamingRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	A radix sort for values coming in chunks, e.g. from a socket. Instead of buffering everything and then calling
+ *	RadixSort3::Sort(), chunks are pushed as they arrive. Each chunk is copied and its histograms are added to the
+ *	running ones right away, so when the last chunk comes in, Finish() only has the scatter passes left to do.
+ *	The histogram pass, i.e. one full read of the data, is moved off the critical path.
+ *
+ *	Pushed values are transformed on the fly so that they all sort as unsigned integers (flipped sign bit for
+ *	signed integers, flipped sign bit or all bits for floats). This is free since we copy them anyway, and it
+ *	gets rid of the negative-values special cases. It uses the same 11-bit radix as RadixSort3.
+ *
+ *	Memory-bounded version: when max_nb_in_memory is not zero, the buffer is sorted and spilled to a temporary
+ *	file as (key, index) pairs each time it's full. Finish() then sorts the last run in memory, and Pull() merges
+ *	all runs with a small heap. Equal keys come out in push order, as with the in-memory version.
+ *
+ *	\class		StreamingRadixSort
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#define	RADIX_NB_BITS		11
+#define	RADIX_SIZE			2048
+#define	MAX_NB_PASSES		3
+#define	RUN_BUFFER_SIZE		4096	// Number of (key, index) pairs read at once from a run
+
+// Buffered keys are already sortable, so the kernels see them as unsigned integers whatever the input type
+typedef RadixEngine<RadixKeyU32, RADIX_NB_BITS>	Engine;
+
+// Transform, copy & update histograms in one go
+template<class Traits>
+static void CopyKeys(const udword* input, udword nb, udword* dest, udword* histograms)
+{
+	for(udword i=0;i<nb;i++)
+	{
+		const udword Key = Traits::ToSortable(input[i]);
+		dest[i] = Key;
+		Engine::UpdateHistograms(histograms, Key);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+StreamingRadixSort::StreamingRadixSort() :
+	mKeys			(null),
+	mNbKeys			(0),
+	mMaxNbKeys		(0),
+	mFirstIndex		(0),
+	mNbTotal		(0),
+	mKeyType		(RADIX_KEY_U32),
+	mNbPasses		(MAX_NB_PASSES),
+	mMaxNbInMemory	(0),
+	mFloatKeys		(false),
+	mFinished		(false),
+	mFailed			(false),
+	mRanks			(null),
+	mRanks2			(null),
+	mRanksSize		(0),
+	mPullCursor		(0),
+	mRuns			(null),
+	mNbRuns			(0),
+	mMaxNbRuns		(0),
+	mHeap			(null),
+	mHeapSize		(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+StreamingRadixSort::~StreamingRadixSort()
+{
+	Reset();
+}
+
+void StreamingRadixSort::Reset()
+{
+	for(udword i=0;i<mNbRuns;i++)
+	{
+		if(mRuns[i].mFile)	fclose(mRuns[i].mFile);
+		ICE_FREE(mRuns[i].mBuffer);
+	}
+	ICE_FREE(mRuns);
+	ICE_FREE(mHeap);
+	ICE_FREE(mRanks2);
+	ICE_FREE(mRanks);
+	ICE_FREE(mKeys);
+
+	mNbKeys			= 0;
+	mMaxNbKeys		= 0;
+	mFirstIndex		= 0;
+	mNbTotal		= 0;
+	mFinished		= false;
+	mFailed			= false;
+	mRanksSize		= 0;
+	mPullCursor		= 0;
+	mNbRuns			= 0;
+	mMaxNbRuns		= 0;
+	mHeapSize		= 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Starts a new stream. Previous results are discarded.
+ *	\param		float_keys			[in] true to sort floating-point values, false for integers
+ *	\param		hints				[in] RADIX_SIGNED or RADIX_UNSIGNED, number of bits (integers only)
+ *	\param		max_nb_in_memory	[in] max number of values kept in memory before spilling a sorted run, 0 for unbounded
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StreamingRadixSort::Init(bool float_keys, const RadixHints& hints, udword max_nb_in_memory)
+{
+	Reset();
+
+	mFloatKeys		= float_keys;
+	mKeyType		= float_keys ? RADIX_KEY_F32 : hints.IsUnsigned() ? RADIX_KEY_U32 : RADIX_KEY_S32;
+	mNbPasses		= mKeyType!=RADIX_KEY_U32 ? MAX_NB_PASSES : hints.GetNbPasses(RADIX_NB_BITS, MAX_NB_PASSES);
+	mMaxNbInMemory	= max_nb_in_memory;
+	ZeroMemory(mHistogram, RADIX_SIZE*MAX_NB_PASSES*sizeof(udword));
+
+	if(max_nb_in_memory)
+		return GrowKeys(max_nb_in_memory);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Feeds the next chunk of integer values.
+ *	\param		input	[in] a list of integer values
+ *	\param		nb		[in] number of values
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StreamingRadixSort::Push(const udword* input, udword nb)
+{
+	ASSERT(!mFloatKeys);
+	return PushKeys(input, nb);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Feeds the next chunk of floating-point values.
+ *	\param		input	[in] a list of floating-point values
+ *	\param		nb		[in] number of values
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StreamingRadixSort::Push(const float* input, udword nb)
+{
+	ASSERT(mFloatKeys);
+	return PushKeys((const udword*)input, nb);
+}
+
+bool StreamingRadixSort::GrowKeys(udword nb)
+{
+	if(nb<=mMaxNbKeys)	return true;
+
+	udword NewSize = mMaxNbKeys*2;
+	if(NewSize<nb)		NewSize = nb;
+	if(NewSize<1024)	NewSize = 1024;
+
+	udword* NewKeys = (udword*)ICE_ALLOC(sizeof(udword)*NewSize);
+	CHECKALLOC(NewKeys);
+	if(mNbKeys)	CopyMemory(NewKeys, mKeys, mNbKeys*sizeof(udword));
+	ICE_FREE(mKeys);
+	mKeys		= NewKeys;
+	mMaxNbKeys	= NewSize;
+	return true;
+}
+
+bool StreamingRadixSort::PushKeys(const udword* input, udword nb)
+{
+	// Checkings
+	if(mFinished || (nb && !input))	return false;
+	if((mNbTotal + nb)&0x80000000)	return false;
+
+	while(nb)
+	{
+		udword Count = nb;
+		if(mMaxNbInMemory)
+		{
+			// Buffer is full, spill a sorted run
+			if(mNbKeys==mMaxNbInMemory && !SpillRun())	return false;
+			Count = MIN(nb, mMaxNbInMemory - mNbKeys);
+		}
+		else
+		{
+			if(!GrowKeys(mNbKeys + Count))	return false;
+		}
+
+		udword* Dest = mKeys + mNbKeys;
+		switch(mKeyType)
+		{
+			case RADIX_KEY_U32:	CopyKeys<RadixKeyU32>(input, Count, Dest, mHistogram);	break;
+			case RADIX_KEY_S32:	CopyKeys<RadixKeyS32>(input, Count, Dest, mHistogram);	break;
+			case RADIX_KEY_F32:	CopyKeys<RadixKeyF32>(input, Count, Dest, mHistogram);	break;
+		}
+		mNbKeys		+= Count;
+		mNbTotal	+= Count;
+		input		+= Count;
+		nb			-= Count;
+	}
+	return true;
+}
+
+bool StreamingRadixSort::SortBuffer()
+{
+	const udword nb = mNbKeys;
+	if(!nb)	return true;
+
+	if(nb>mRanksSize)
+	{
+		ICE_FREE(mRanks2);
+		ICE_FREE(mRanks);
+		mRanks	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks);
+		mRanks2	= (udword*)ICE_ALLOC(sizeof(udword)*nb);	CHECKALLOC(mRanks2);
+		mRanksSize = nb;
+	}
+
+	// Histograms are already there, we just have to run the passes. Counters are turned into offsets on the way.
+	bool ValidRanks = false;
+	for(udword j=0;j<mNbPasses;j++)
+	{
+		// If all values have the same digit, sorting is useless
+		if(!Engine::IsPassUseful(mKeys, nb, mHistogram, j))	continue;
+
+		udword* Offsets = &mHistogram[j*RADIX_SIZE];
+		Engine::CreateOffsets(Offsets, 0);
+		Engine::ScatterRange(mKeys, 0, nb, j, Offsets, ValidRanks ? mRanks : null, mRanks2);
+		ValidRanks = true;
+
+		// Swap pointers for next pass. Valid indices - the most recent ones - are in mRanks after the swap.
+		udword* Tmp = mRanks;
+		mRanks = mRanks2;
+		mRanks2 = Tmp;
+	}
+
+	if(!ValidRanks)
+	{
+		for(udword i=0;i<nb;i++)	mRanks[i] = i;
+	}
+	return true;
+}
+
+bool StreamingRadixSort::AddRun(FILE* file, udword nb)
+{
+	if(mNbRuns==mMaxNbRuns)
+	{
+		const udword NewSize = mMaxNbRuns ? mMaxNbRuns*2 : 8;
+		StreamingRun* NewRuns = (StreamingRun*)ICE_ALLOC(sizeof(StreamingRun)*NewSize);
+		CHECKALLOC(NewRuns);
+		if(mNbRuns)	CopyMemory(NewRuns, mRuns, mNbRuns*sizeof(StreamingRun));
+		ICE_FREE(mRuns);
+		mRuns		= NewRuns;
+		mMaxNbRuns	= NewSize;
+	}
+
+	StreamingRun& Run = mRuns[mNbRuns++];
+	Run.mFile		= file;
+	Run.mNb			= nb;
+	Run.mNbRead		= 0;
+	Run.mBuffer		= null;
+	Run.mBufferNb	= 0;
+	Run.mBufferPos	= 0;
+	return true;
+}
+
+bool StreamingRadixSort::SpillRun()
+{
+	if(!SortBuffer())	return false;
+
+	FILE* fp = tmpfile();
+	if(!fp)	return false;
+
+	// Write (key, index) pairs in sorted order
+	udword Block[RUN_BUFFER_SIZE*2];
+	udword Offset = 0;
+	for(udword i=0;i<mNbKeys;i++)
+	{
+		const udword id = mRanks[i];
+		Block[Offset++] = mKeys[id];
+		Block[Offset++] = mFirstIndex + id;
+		if(Offset==RUN_BUFFER_SIZE*2 || i==mNbKeys-1)
+		{
+			if(fwrite(Block, sizeof(udword)*2, Offset/2, fp)!=Offset/2)
+			{
+				fclose(fp);
+				return false;
+			}
+			Offset = 0;
+		}
+	}
+
+	if(!AddRun(fp, mNbKeys))
+	{
+		fclose(fp);
+		return false;
+	}
+
+	// Next run starts from scratch
+	mFirstIndex += mNbKeys;
+	mNbKeys = 0;
+	ZeroMemory(mHistogram, RADIX_SIZE*MAX_NB_PASSES*sizeof(udword));
+	return true;
+}
+
+bool StreamingRadixSort::ReadRun(StreamingRun& run)
+{
+	const udword Nb = MIN(udword(RUN_BUFFER_SIZE), run.mNb - run.mNbRead);
+	if(fread(run.mBuffer, sizeof(udword)*2, Nb, run.mFile)!=Nb)	return false;
+	run.mNbRead		+= Nb;
+	run.mBufferNb	= Nb;
+	run.mBufferPos	= 0;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Sorts the remaining values. After the call, results are available with GetRanks() or Pull().
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StreamingRadixSort::Finish()
+{
+	if(mFinished)	return !mFailed;
+	mFinished = true;
+	mPullCursor = 0;
+
+	// Everything fit in memory, this is just a regular sort minus the histograms. Else we prepare the merge.
+	mFailed = mNbRuns ? !PrepareMerge() : !SortBuffer();
+	return !mFailed;
+}
+
+bool StreamingRadixSort::PrepareMerge()
+{
+	// The last run stays in memory
+	if(mNbKeys)
+	{
+		if(!SortBuffer() || !AddRun(null, mNbKeys))	return false;
+		StreamingRun& Run = mRuns[mNbRuns-1];
+		Run.mNbRead		= mNbKeys;
+		Run.mBufferNb	= mNbKeys;
+	}
+
+	mHeap = (udword*)ICE_ALLOC(sizeof(udword)*mNbRuns);
+	CHECKALLOC(mHeap);
+	mHeapSize = 0;
+
+	for(udword i=0;i<mNbRuns;i++)
+	{
+		StreamingRun& Run = mRuns[i];
+		if(Run.mFile)
+		{
+			rewind(Run.mFile);
+			Run.mBuffer = (udword*)ICE_ALLOC(sizeof(udword)*2*RUN_BUFFER_SIZE);
+			CHECKALLOC(Run.mBuffer);
+			if(!ReadRun(Run))	return false;
+		}
+		mHeap[mHeapSize++] = i;
+	}
+
+	for(udword i=mHeapSize/2;i--;)
+		SiftDown(i);
+	return true;
+}
+
+inline_ udword StreamingRadixSort::GetRunKey(const StreamingRun& run) const
+{
+	if(run.mFile)	return run.mBuffer[run.mBufferPos*2];
+	return mKeys[mRanks[run.mBufferPos]];
+}
+
+inline_ udword StreamingRadixSort::GetRunIndex(const StreamingRun& run) const
+{
+	if(run.mFile)	return run.mBuffer[run.mBufferPos*2+1];
+	return mFirstIndex + mRanks[run.mBufferPos];
+}
+
+inline_ bool StreamingRadixSort::RunLess(udword a, udword b) const
+{
+	// Ties are broken with the run index, so that equal keys come out in push order
+	const udword KeyA = GetRunKey(mRuns[a]);
+	const udword KeyB = GetRunKey(mRuns[b]);
+	return KeyA<KeyB || (KeyA==KeyB && a<b);
+}
+
+void StreamingRadixSort::SiftDown(udword i)
+{
+	const udword Size = mHeapSize;
+	const udword Item = mHeap[i];
+	for(;;)
+	{
+		udword Child = i*2+1;
+		if(Child>=Size)	break;
+		if(Child+1<Size && RunLess(mHeap[Child+1], mHeap[Child]))	Child++;
+		if(!RunLess(mHeap[Child], Item))	break;
+		mHeap[i] = mHeap[Child];
+		i = Child;
+	}
+	mHeap[i] = Item;
+}
+
+inline_ udword StreamingRadixSort::UntransformKey(udword key) const
+{
+	// Inverse of the transform done in PushKeys()
+	switch(mKeyType)
+	{
+		case RADIX_KEY_S32:	return RadixKeyS32::FromSortable(key);
+		case RADIX_KEY_F32:	return RadixKeyF32::FromSortable(key);
+		default:			return RadixKeyU32::FromSortable(key);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the next sorted values.
+ *	\param		ranks	[out] indices of the values in the whole stream, in sorted order
+ *	\param		max_nb	[in] max number of values to write
+ *	\param		keys	[out] sorted values, or null if not needed
+ *	\return		number of values written, 0 when everything has been pulled or after a failure (see HasFailed())
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword StreamingRadixSort::Pull(udword* ranks, udword max_nb, udword* keys)
+{
+	if(!mFinished || mFailed || !ranks)	return 0;
+
+	if(!mNbRuns)
+	{
+		const udword Nb = MIN(max_nb, mNbTotal - mPullCursor);
+		const udword* Sorted = mRanks + mPullCursor;
+		for(udword i=0;i<Nb;i++)	ranks[i] = Sorted[i];
+		if(keys)
+		{
+			for(udword i=0;i<Nb;i++)	keys[i] = UntransformKey(mKeys[Sorted[i]]);
+		}
+		mPullCursor += Nb;
+		return Nb;
+	}
+
+	// Merge the runs
+	udword Nb = 0;
+	while(Nb<max_nb && mHeapSize)
+	{
+		StreamingRun& Run = mRuns[mHeap[0]];
+		ranks[Nb] = GetRunIndex(Run);
+		if(keys)	keys[Nb] = UntransformKey(GetRunKey(Run));
+		Nb++;
+
+		// Move to next entry, refill the buffer or remove the run from the heap when needed
+		bool Exhausted = false;
+		if(++Run.mBufferPos==Run.mBufferNb)
+		{
+			if(Run.mFile && Run.mNbRead<Run.mNb)
+			{
+				// A read error isn't the end of the run, the remaining values would be silently lost
+				if(!ReadRun(Run))
+				{
+					mFailed = true;
+					break;
+				}
+			}
+			else
+				Exhausted = true;
+		}
+
+		if(Exhausted)
+			mHeap[0] = mHeap[--mHeapSize];
+		if(mHeapSize)
+			SiftDown(0);
+	}
+	return Nb;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword StreamingRadixSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(StreamingRadixSort);
+	UsedRam += mMaxNbKeys*sizeof(udword);			// Key buffer
+	UsedRam += 2*mRanksSize*sizeof(udword);			// 2 lists of indices
+	UsedRam += mMaxNbRuns*sizeof(StreamingRun);		// Runs
+	for(udword i=0;i<mNbRuns;i++)
+	{
+		if(mRuns[i].mBuffer)	UsedRam += sizeof(udword)*2*RUN_BUFFER_SIZE;
+	}
+	if(mHeap)	UsedRam += mNbRuns*sizeof(udword);
+	return UsedRam;
+}
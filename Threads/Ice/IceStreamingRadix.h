@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains a streaming radix sort.
+ *	\file		IceStreamingRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICESTREAMINGRADIX_H
+#define ICESTREAMINGRADIX_H
+
+	//! A sorted run spilled to disk, or the last one kept in memory
+	struct StreamingRun
+	{
+				FILE*			mFile;				//!< Temporary file, or null for the in-memory run
+				udword			mNb;				//!< Number of entries in the run
+				udword			mNbRead;			//!< Number of entries already read from the run
+				udword*			mBuffer;			//!< Read buffer, (key, index) pairs
+				udword			mBufferNb;			//!< Number of entries in the read buffer
+				udword			mBufferPos;			//!< Current entry in the read buffer
+	};
+
+	class ICECORE_API StreamingRadixSort : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								StreamingRadixSort();
+								~StreamingRadixSort();
+
+		// Starts a new stream. With max_nb_in_memory!=0, sorted runs of that size are spilled to temporary files.
+				bool			Init(bool float_keys, const RadixHints& hints=RADIX_SIGNED, udword max_nb_in_memory=0);
+		// Feeds the next chunk of values. Values are copied, the chunk can be recycled right after the call.
+				bool			Push(const udword* input, udword nb);
+				bool			Push(const float* input, udword nb);
+		// Sorts what's left. No more values can be pushed after this call.
+				bool			Finish();
+		// Gets the next sorted ranks (and keys if needed). Returns the number of values written, 0 when over or after a failure.
+				udword			Pull(udword* ranks, udword max_nb, udword* keys=null);
+		//! Returns true if Finish() failed or a spilled run couldn't be read back. Pulled values are then incomplete.
+		inline_	bool			HasFailed()			const	{ return mFailed;		}
+
+		//! Access to results. Only available after Finish(), when nothing has been spilled.
+		inline_	const udword*	GetRanks()			const	{ return (mFinished && !mFailed && !mNbRuns) ? mRanks : null;	}
+
+		// Stats
+		//! Returns the total number of pushed values.
+		inline_	udword			GetNbValues()		const	{ return mNbTotal;		}
+		//! Returns the number of sorted runs to merge, 0 when everything fit in memory.
+		inline_	udword			GetNbRuns()			const	{ return mNbRuns;		}
+				udword			GetUsedRam()		const;
+
+								PREVENT_COPY(StreamingRadixSort)
+		private:
+		// Key buffer
+				udword*			mKeys;				//!< Pushed keys, transformed so that they sort as unsigned integers
+				udword			mNbKeys;			//!< Number of keys in the buffer
+				udword			mMaxNbKeys;			//!< Capacity of the key buffer
+				udword			mFirstIndex;		//!< Index of the first buffered key in the whole stream
+				udword			mNbTotal;			//!< Total number of pushed keys
+				RadixKeyType	mKeyType;			//!< Key traits used to transform pushed values
+				udword			mNbPasses;			//!< Number of planned passes
+				udword			mMaxNbInMemory;		//!< Spill threshold, 0 for unbounded
+				bool			mFloatKeys;			//!< Sorting floats
+				bool			mFinished;			//!< Finish() has been called
+				bool			mFailed;			//!< Finish() or a read failed, nothing more can be pulled
+		// Ranks
+				udword*			mRanks;				//!< Two lists, swapped each pass
+				udword*			mRanks2;
+				udword			mRanksSize;			//!< Capacity of the rank lists
+				udword			mPullCursor;		//!< Next rank to pull (in-memory case)
+		// Runs
+				StreamingRun*	mRuns;				//!< Sorted runs, the last one might be in memory
+				udword			mNbRuns;			//!< Number of runs
+				udword			mMaxNbRuns;			//!< Capacity of the runs array
+				udword*			mHeap;				//!< Min-heap of run indices, for the final merge
+				udword			mHeapSize;			//!< Current number of runs in the heap
+		// Histograms for the 3 passes, updated as values come in
+				udword			mHistogram[2048*3];
+		// Internal methods
+				void			Reset();
+				bool			GrowKeys(udword nb);
+				bool			PushKeys(const udword* input, udword nb);
+				bool			SortBuffer();
+				bool			PrepareMerge();
+				bool			SpillRun();
+				bool			AddRun(FILE* file, udword nb);
+				bool			ReadRun(StreamingRun& run);
+				bool			RunLess(udword a, udword b)	const;
+				udword			GetRunKey(const StreamingRun& run)		const;
+				udword			GetRunIndex(const StreamingRun& run)	const;
+				void			SiftDown(udword i);
+				udword			UntransformKey(udword key)	const;
+	};
+
+#endif // ICESTREAMINGRADIX_H
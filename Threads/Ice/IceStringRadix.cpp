@@ -0,0 +1,321 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains an MSD radix sort for byte strings.
+ *	\file		IceStringRadix.cpp
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	An MSD radix sort for strings of any length, e.g. paths or symbol names.
+ *
+ *	Strings are sorted in byte order, like memcmp: shorter strings come first when they're a prefix of longer ones.
+ *	Each bucket of strings sharing the same prefix is partitioned on its next character, in two passes:
+ *	- the characters are read once, stored in a cache (as character+1, or 0 for strings that ended) and counted,
+ *	- the strings are scattered to their sub-buckets with the cached characters, without touching the strings again.
+ *	The string data is read in random order, so reading each character only once matters more than anything else.
+ *
+ *	Buckets of STRING_RADIX_INSERTION_SORT strings or less are finished with an insertion sort, comparing the strings
+ *	from the end of their known common prefix. When all the strings of a bucket have the same next character, the
+ *	bucket's whole common prefix is found with a single scan instead, and skipped without partitioning anything.
+ *	Strings that ended are all equal, they're done.
+ *
+ *	Buckets are kept on an explicit stack, so long shared prefixes don't recurse. Strings move back & forth between two
+ *	lists, and each finished bucket writes its ranks directly, so there's no copy back. The sort is stable: equal
+ *	strings keep their input order. Memory: 2 lists of nb (pointer, length, index) entries, plus nb ranks & characters.
+ *
+ *	\class		StringRadixSort
+ *	\author		agent
+ *	\version	1.0
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Precompiled Header
+#include "StdAfx.h"
+
+using namespace IceCore;
+
+#define	STRING_RADIX_SIZE	257		// Ended strings, then 256 characters
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Constructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+StringRadixSort::StringRadixSort() : mCurrentSize(0), mRanks(null), mCache(null), mStack(null), mTotalCalls(0), mNbPasses(0), mNbSkipped(0)
+{
+	mEntries[0] = mEntries[1] = null;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Destructor.
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+StringRadixSort::~StringRadixSort()
+{
+	ICE_FREE(mStack);
+	ICE_FREE(mCache);
+	ICE_FREE(mEntries[1]);
+	ICE_FREE(mEntries[0]);
+	ICE_FREE(mRanks);
+}
+
+bool StringRadixSort::CheckResize(udword nb)
+{
+	if(nb<=mCurrentSize)	return true;
+
+	ICE_FREE(mStack);
+	ICE_FREE(mCache);
+	ICE_FREE(mEntries[1]);
+	ICE_FREE(mEntries[0]);
+	ICE_FREE(mRanks);
+	mCurrentSize = 0;
+
+	// Buckets on the stack are disjoint & larger than STRING_RADIX_INSERTION_SORT
+	const udword MaxNbBuckets = nb/(STRING_RADIX_INSERTION_SORT+1) + 1;
+
+	mRanks		= (udword*)ICE_ALLOC(sizeof(udword)*nb);			CHECKALLOC(mRanks);
+	mEntries[0]	= (Entry*)ICE_ALLOC(sizeof(Entry)*nb);				CHECKALLOC(mEntries[0]);
+	mEntries[1]	= (Entry*)ICE_ALLOC(sizeof(Entry)*nb);				CHECKALLOC(mEntries[1]);
+	mCache		= (uword*)ICE_ALLOC(sizeof(uword)*nb);				CHECKALLOC(mCache);
+	mStack		= (Bucket*)ICE_ALLOC(sizeof(Bucket)*MaxNbBuckets);	CHECKALLOC(mStack);
+	mCurrentSize = nb;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	After the call, mRanks contains a list of indices in sorted order, i.e. in the order you may process your data.
+ *	\param		strings	[in] a list of strings to sort
+ *	\param		nb		[in] number of strings to sort
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+StringRadixSort& StringRadixSort::Sort(const RadixString* strings, udword nb)
+{
+	// Checkings
+	if(!strings || !nb)		return *this;
+
+	// Stats
+	mTotalCalls++;
+
+	// Resize lists if needed
+	if(!CheckResize(nb))	return *this;
+
+	Entry* Entries = mEntries[0];
+	for(udword i=0;i<nb;i++)
+	{
+		Entries[i].mString	= reinterpret_cast<const ubyte*>(strings[i].mString);
+		Entries[i].mLength	= strings[i].mLength;
+		Entries[i].mIndex	= i;
+	}
+	return SortEntries(nb);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Main sort routine.
+ *	This one takes the strings & their lengths in two lists.
+ *	\param		strings	[in] a list of strings to sort
+ *	\param		lengths	[in] their lengths
+ *	\param		nb		[in] number of strings to sort
+ *	\return		Self-Reference
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+StringRadixSort& StringRadixSort::Sort(const char* const* strings, const udword* lengths, udword nb)
+{
+	// Checkings
+	if(!strings || !lengths || !nb)	return *this;
+
+	// Stats
+	mTotalCalls++;
+
+	// Resize lists if needed
+	if(!CheckResize(nb))			return *this;
+
+	Entry* Entries = mEntries[0];
+	for(udword i=0;i<nb;i++)
+	{
+		Entries[i].mString	= reinterpret_cast<const ubyte*>(strings[i]);
+		Entries[i].mLength	= lengths[i];
+		Entries[i].mIndex	= i;
+	}
+	return SortEntries(nb);
+}
+
+// Compares two strings after their first 'depth' characters, which are the same
+static inline_ int CompareSuffixes(const ubyte* a, udword length_a, const ubyte* b, udword length_b, udword depth)
+{
+	const udword Length = length_a<length_b ? length_a : length_b;
+	if(Length>depth)
+	{
+		const int Result = memcmp(a + depth, b + depth, Length - depth);
+		if(Result)
+			return Result;
+	}
+	return length_a<length_b ? -1 : (length_a>length_b ? 1 : 0);
+}
+
+void StringRadixSort::InsertionSort(Entry* entries, udword nb, udword depth)
+{
+	for(udword i=1;i<nb;i++)
+	{
+		const Entry Current = entries[i];
+		udword j = i;
+		// Strictly greater only, to keep equal strings in input order
+		while(j && CompareSuffixes(entries[j-1].mString, entries[j-1].mLength, Current.mString, Current.mLength, depth)>0)
+		{
+			entries[j] = entries[j-1];
+			j--;
+		}
+		entries[j] = Current;
+	}
+}
+
+void StringRadixSort::OutputRanks(const Entry* entries, udword start, udword nb)
+{
+	udword* Ranks = mRanks + start;
+	for(udword i=0;i<nb;i++)
+		Ranks[i] = entries[i].mIndex;
+}
+
+StringRadixSort& StringRadixSort::SortEntries(udword nb)
+{
+	mNbPasses = 0;
+	mNbSkipped = 0;
+
+	udword NbBuckets = 0;
+	{
+		Bucket& First = mStack[NbBuckets++];
+		First.mStart	= 0;
+		First.mNb		= nb;
+		First.mDepth	= 0;
+		First.mBuffer	= 0;
+	}
+
+	udword Counters[STRING_RADIX_SIZE];
+	while(NbBuckets)
+	{
+		const Bucket Current = mStack[--NbBuckets];
+		Entry* Entries = mEntries[Current.mBuffer] + Current.mStart;
+		const udword Nb = Current.mNb;
+		udword Depth = Current.mDepth;
+
+		if(Nb<=STRING_RADIX_INSERTION_SORT)
+		{
+			InsertionSort(Entries, Nb, Depth);
+			OutputRanks(Entries, Current.mStart, Nb);
+			continue;
+		}
+
+		// Read & count the next character of each string
+		uword* Cache = mCache + Current.mStart;
+		bool Done = false;
+		while(1)
+		{
+			ZeroMemory(Counters, sizeof(Counters));
+			for(udword i=0;i<Nb;i++)
+			{
+				const udword c = Entries[i].mLength>Depth ? udword(Entries[i].mString[Depth])+1 : 0;
+				Cache[i] = uword(c);
+				Counters[c]++;
+			}
+
+			const udword c = Cache[0];
+			if(Counters[c]!=Nb)
+				break;
+
+			// All strings ended: they're equal, the bucket is done
+			if(!c)
+			{
+				OutputRanks(Entries, Current.mStart, Nb);
+				Done = true;
+				break;
+			}
+
+			// Same next character for all strings: skip the whole common prefix, then partition on the next character
+			const ubyte* First = Entries[0].mString;
+			udword Prefix = Entries[0].mLength;
+			for(udword i=1;i<Nb && Prefix>Depth+1;i++)
+			{
+				const ubyte* String = Entries[i].mString;
+				const udword Length = Entries[i].mLength<Prefix ? Entries[i].mLength : Prefix;
+				udword j = Depth+1;
+				while(j<Length && String[j]==First[j])
+					j++;
+				Prefix = j;
+			}
+			mNbSkipped += Prefix - Depth;
+			Depth = Prefix;
+		}
+		if(Done)
+			continue;
+
+		mNbPasses++;
+
+		// Scatter to the other list, with the cached characters
+		udword Offsets[STRING_RADIX_SIZE];
+		udword Offset = 0;
+		for(udword i=0;i<STRING_RADIX_SIZE;i++)
+		{
+			Offsets[i] = Offset;
+			Offset += Counters[i];
+		}
+
+		const udword DstBuffer = 1 - Current.mBuffer;
+		Entry* Dst = mEntries[DstBuffer] + Current.mStart;
+		for(udword i=0;i<Nb;i++)
+			Dst[Offsets[Cache[i]]++] = Entries[i];
+
+		// Ended strings are equal & stay in input order, the other buckets are sorted on the next character
+		udword Start = 0;
+		for(udword i=0;i<STRING_RADIX_SIZE;i++)
+		{
+			const udword Count = Counters[i];
+			if(!Count)
+				continue;
+
+			if(!i || Count==1)
+			{
+				OutputRanks(Dst + Start, Current.mStart + Start, Count);
+			}
+			else if(Count<=STRING_RADIX_INSERTION_SORT)
+			{
+				InsertionSort(Dst + Start, Count, Depth+1);
+				OutputRanks(Dst + Start, Current.mStart + Start, Count);
+			}
+			else
+			{
+				Bucket& Sub = mStack[NbBuckets++];
+				Sub.mStart	= Current.mStart + Start;
+				Sub.mNb		= Count;
+				Sub.mDepth	= Depth+1;
+				Sub.mBuffer	= DstBuffer;
+			}
+			Start += Count;
+		}
+	}
+	return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Gets the ram used.
+ *	\return		memory used in bytes
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+udword StringRadixSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(StringRadixSort);
+	UsedRam += mCurrentSize*sizeof(udword);						// Ranks
+	UsedRam += 2*mCurrentSize*sizeof(Entry);					// Entries
+	UsedRam += mCurrentSize*sizeof(uword);						// Cache
+	UsedRam += (mCurrentSize/(STRING_RADIX_INSERTION_SORT+1) + 1)*sizeof(Bucket);	// Stack
+	return UsedRam;
+}
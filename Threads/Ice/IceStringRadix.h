@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Contains an MSD radix sort for byte strings.
+ *	\file		IceStringRadix.h
+ *	\author		agent
+ *	\date		October, 19, 2026
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Include Guard
+#ifndef ICESTRINGRADIX_H
+#define ICESTRINGRADIX_H
+
+	#define STRING_RADIX_INSERTION_SORT	32	// Smaller buckets are sorted with an insertion sort
+
+	//! A string to sort. It doesn't have to be null-terminated, and can contain any byte.
+	struct RadixString
+	{
+		const char*		mString;
+		udword			mLength;
+	};
+
+	class ICECORE_API StringRadixSort : public Allocateable
+	{
+		public:
+		// Constructor/Destructor
+								StringRadixSort();
+								~StringRadixSort();
+		// Sorting methods
+				StringRadixSort&	Sort(const RadixString* strings, udword nb);
+				StringRadixSort&	Sort(const char* const* strings, const udword* lengths, udword nb);
+
+		//! Access to results. mRanks is a list of indices in sorted order, i.e. in the order you may further process your data
+		inline_	const udword*	GetRanks()			const	{ return mRanks;		}
+
+		// Stats
+				udword			GetUsedRam()		const;
+		//! Returns the total number of calls to the radix sorter.
+		inline_	udword			GetNbTotalCalls()	const	{ return mTotalCalls;	}
+		//! Returns the number of radix passes of the last call, i.e. of buckets partitioned on one character.
+		inline_	udword			GetNbPasses()		const	{ return mNbPasses;		}
+		//! Returns the number of characters skipped as common prefixes during the last call, summed over the buckets.
+		inline_	udword			GetNbSkipped()		const	{ return mNbSkipped;	}
+
+								PREVENT_COPY(StringRadixSort)
+		private:
+		struct Entry
+		{
+			const ubyte*	mString;
+			udword			mLength;
+			udword			mIndex;
+		};
+		struct Bucket
+		{
+			udword			mStart;
+			udword			mNb;
+			udword			mDepth;			//!< Length of the prefix shared by the bucket's strings
+			udword			mBuffer;		//!< Entry buffer holding the bucket
+		};
+				udword			mCurrentSize;		//!< Current size of the lists
+				udword*			mRanks;				//!< Sorted ranks
+				Entry*			mEntries[2];		//!< Strings, partitioned back and forth
+				uword*			mCache;				//!< Current character of each string plus one, 0 for ended strings
+				Bucket*			mStack;				//!< Buckets left to sort
+		// Stats
+				udword			mTotalCalls;		//!< Total number of calls to the sort routine
+				udword			mNbPasses;
+				udword			mNbSkipped;
+		// Internal methods
+				bool			CheckResize(udword nb);
+				StringRadixSort&	SortEntries(udword nb);
+				void			OutputRanks(const Entry* entries, udword start, udword nb);
+		static	void			InsertionSort(Entry* entries, udword nb, udword depth);
+	};
+
+#endif // ICESTRINGRADIX_H
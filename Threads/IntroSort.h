@@ -22,33 +22,115 @@
 // Just plain annoying ...  Restored at end of this file.
 #pragma warning (disable : 4244)
 
+#include <utility>
+
 
 #define MIN_LENGTH_FOR_QUICKSORT	64
 #define MAX_DEPTH_BEFORE_HEAPSORT	256
+#define BLOCK_PARTITION_SIZE		64	// Number of comparisons buffered per block, must fit in a byte offset
+
+// pattern-defeating quicksort settings (adaptive mode)
+#define ADAPTIVE_INSERTION_SORT		24	// Insertion sort below this length
+#define ADAPTIVE_NINTHER			128	// Pseudo-median of nine above this length
+#define ADAPTIVE_INSERTION_LIMIT	8	// Max number of moves before a partial insertion sort bails out
+
+
+
+
+//=====================================================================
+// Partitioning modes, shared by all IntroSort instances.
+//=====================================================================
+
+enum IntroSortPartition
+{
+	TERNARY_PARTITION,	// three way partitioning, best with many duplicates
+	BLOCK_PARTITION,	// branchless BlockQuicksort partitioning, best with random keys
+	ADAPTIVE_PARTITION	// pattern-defeating quicksort on top of block partitioning, linear on sorted input
+};
+
+
+
+
+//=====================================================================
+// Default comparator and projection.
+// The comparator is a strict weak ordering, it's the only comparison
+// used by the sort.  The projection extracts the key from a value, so
+// that records can be sorted by one of their fields without a custom
+// comparator.  Both are inlined at compile time.
+//=====================================================================
+
+struct IntroSortLess
+{
+	template <class K>
+	inline bool operator()(const K & a, const K & b) const { return a < b; }
+};
+
+struct IntroSortIdentity
+{
+	template <class K>
+	inline const K & operator()(const K & value) const { return value; }
+};
+
+template <class T, class K, K T::*Field>
+struct IntroSortField
+{
+	inline const K & operator()(const T & value) const { return value.*Field; }
+};
 
 
 
 
 //=====================================================================
 // IntroSort class declaration 
-// Notes: Any object used with this class must implement the following
-// the operators:   <=, >=, ==
+// Notes: Values are only compared through Compare(Projection(a),
+// Projection(b)), and moved rather than copied when possible.  By
+// default any object used with this class must implement operator <.
 //=====================================================================
 
-template <class T>
+template <class T, class Compare = IntroSortLess, class Projection = IntroSortIdentity>
 class IntroSort
 {
 public:
-	IntroSort();
+	typedef IntroSortPartition PartitionMode;
+
+	IntroSort(PartitionMode mode = TERNARY_PARTITION, const Compare & compare = Compare(), const Projection & projection = Projection());
 
 	virtual ~IntroSort();
 
 	void Sort(T * array, unsigned int count);
 
+protected:
+	// sorts a sub-partition.  In adaptive mode the depth is the number of bad partitions still allowed.
+	void SortPartition(T * array, unsigned int count, unsigned int depth, bool leftmost);
+
+	// parallel sorting hook: returns true if the sub-partition has been handed over to another thread.
+	virtual bool SpawnPartition(T * array, unsigned int count, unsigned int depth, bool leftmost);
+
+	// smallest sub-partition passed to SpawnPartition.
+	unsigned int spawnThreshold;
+
 private:
+	bool Spawn(T * array, unsigned int count, unsigned int depth, bool leftmost);
+
 	void Partition(T * left, unsigned int count, unsigned int depth = 1);
+
+	void BlockPartition(T * array, unsigned int count, unsigned int depth, bool leftmost);
+
+	void AdaptivePartition(T * begin, T * end, int badAllowed, bool leftmost);
+
+	T * PartitionRightBranchless(T * begin, T * end, bool & alreadyPartitioned);
+
+	T * PartitionLeft(T * begin, T * end);
+
+	bool PartialInsertionSort(T * begin, T * end);
+
+	void Sort3(T * a, T * b, T * c);
+
+	void SwapOffsets(T * left, T * right, const unsigned char * offsetsLeft, const unsigned char * offsetsRight, unsigned int num, bool useSwaps);
 	
-	T SelectPivot(T value1, T value2, T value3);
+	const T & SelectPivot(const T & value1, const T & value2, const T & value3) const;
+
+	bool Less(const T & valueA, const T & valueB) const;
 
 	void Swap(T * valueA, T * valueB);
 
@@ -60,6 +142,9 @@ private:
 
 	void HeapSort(T * array, int k, int N);
 
+	PartitionMode mode;
+	Compare compare;
+	Projection projection;
 };
 
 
@@ -68,16 +153,17 @@ private:
 // Begin IntroSort methods:
 //=====================================================================
 
-template <class T>
-IntroSort<T>::IntroSort()
+template <class T, class Compare, class Projection>
+IntroSort<T, Compare, Projection>::IntroSort(PartitionMode mode, const Compare & compare, const Projection & projection) :
+	spawnThreshold(~0u), mode(mode), compare(compare), projection(projection)
 {
 	// constructor
 }
 
 
 
-template <class T>
-IntroSort<T>::~IntroSort()
+template <class T, class Compare, class Projection>
+IntroSort<T, Compare, Projection>::~IntroSort()
 {
 	// destructor
 }
@@ -85,8 +171,8 @@ IntroSort<T>::~IntroSort()
 	
 
 
-template <class T>
-inline void IntroSort<T>::Sort(T * array, unsigned int count)
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::Sort(T * array, unsigned int count)
 {
 	// Public method used to invoke the sort.
 
@@ -94,7 +180,17 @@ inline void IntroSort<T>::Sort(T * array, unsigned int count)
 	// Call quick sort partition method if there are enough
 	// elements to warrant it or insertion sort otherwise.
 	if (count >= MIN_LENGTH_FOR_QUICKSORT)
-		Partition(array, count);
+	{
+		unsigned int depth = 1;
+		if (mode == ADAPTIVE_PARTITION)
+		{
+			// the number of bad partitions allowed before heap sort makes the worst case O(n log n).
+			depth = 0;
+			for (unsigned int n = count; n > 1; n >>= 1)
+				depth++;
+		}
+		SortPartition(array, count, depth, true);
+	}
 	else
 		InsertionSort(array, count);
 }
@@ -102,34 +198,80 @@ inline void IntroSort<T>::Sort(T * array, unsigned int count)
 
 
 
-template <class T> 
-inline void IntroSort<T>::Swap(T * valueA, T * valueB)
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::SortPartition(T * array, unsigned int count, unsigned int depth, bool leftmost)
+{
+	// leftmost is only used by the adaptive & block modes.
+	if (mode == ADAPTIVE_PARTITION)
+		AdaptivePartition(array, array + count, depth, leftmost);
+	else if (mode == BLOCK_PARTITION)
+		BlockPartition(array, count, depth, leftmost);
+	else
+		Partition(array, count, depth);
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+bool IntroSort<T, Compare, Projection>::SpawnPartition(T * array, unsigned int count, unsigned int depth, bool leftmost)
+{
+	// serial sorting, the caller handles the sub-partition itself.
+	return false;
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+inline bool IntroSort<T, Compare, Projection>::Spawn(T * array, unsigned int count, unsigned int depth, bool leftmost)
+{
+	// the virtual call is skipped for small sub-partitions, and always in serial mode.
+	return (count >= spawnThreshold) && SpawnPartition(array, count, depth, leftmost);
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::Swap(T * valueA, T * valueB)
 {
 	// do the ol' "switch-a-me-do" on two values.
-	T temp = *valueA; 
-	*valueA = *valueB; 
-	*valueB = temp;
+	T temp = std::move(*valueA); 
+	*valueA = std::move(*valueB); 
+	*valueB = std::move(temp);
 }
 
 
 
 
 
-template <class T> 
-inline T IntroSort<T>::SelectPivot(T value1, T value2, T value3)
+template <class T, class Compare, class Projection>
+inline const T & IntroSort<T, Compare, Projection>::SelectPivot(const T & value1, const T & value2, const T & value3) const
 {
 	// middle of three method.
-	if (value1 < value2)
-		return ((value2 < value3) ? value2 : (value1 < value3) ? value3 : value1);
-	return ((value1 < value3) ? value1 : (value2 < value3) ? value3 : value2); 
+	if (Less(value1, value2))
+		return (Less(value2, value3) ? value2 : Less(value1, value3) ? value3 : value1);
+	return (Less(value1, value3) ? value1 : Less(value2, value3) ? value3 : value2); 
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline bool IntroSort<T, Compare, Projection>::Less(const T & valueA, const T & valueB) const
+{
+	// the only comparison used by the sort.
+	return compare(projection(valueA), projection(valueB));
 }
 
 
 
 
 
-template <class T> 
-inline void IntroSort<T>::Partition(T * left, unsigned int count, unsigned int depth)
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::Partition(T * left, unsigned int count, unsigned int depth)
 {
 	if (depth > MAX_DEPTH_BEFORE_HEAPSORT)
 	{
@@ -146,21 +288,22 @@ inline void IntroSort<T>::Partition(T * left, unsigned int count, unsigned int d
 	T * equalLeft = left;
 	T * equalRight = right;
 
-	// select the pivot value.
+	// select the pivot value.  Chosen by reference, and copied once since values
+	// are moved around during partitioning.
 	T pivot = SelectPivot(left[0], right[0], left[((right - left) >> 1)]);
 
 	// do three way partitioning.
 	do
 	{
-		while ((left < right) && (*left <= pivot))
-			if (*(left++) == pivot)
+		while ((left < right) && !Less(pivot, *left))
+			if (!Less(*(left++), pivot))
 			{
 				// equal to pivot value.  move to far left.
 				Swap(equalLeft++, left - 1);
 			}
 		
-		while ((left < right) && (*right >= pivot))
-			if (*(right--) == pivot)
+		while ((left < right) && !Less(*right, pivot))
+			if (!Less(pivot, *(right--)))
 			{
 				// equal to pivot value.  move to far right.
 				Swap(equalRight--, right + 1);
@@ -170,9 +313,9 @@ inline void IntroSort<T>::Partition(T * left, unsigned int count, unsigned int d
 		{
 			if (left == right)
 			{
-				if (*left >= pivot)
+				if (!Less(*left, pivot))
 					left--;
-				if (*right <= pivot)
+				if (!Less(pivot, *right))
 					right++;
 			}
 			else
@@ -219,7 +362,10 @@ inline void IntroSort<T>::Partition(T * left, unsigned int count, unsigned int d
 	// Partition left (less than pivot) if there are enough values to warrant it
 	// otherwise do insertion sort on the values.
 	if (leftSize >= MIN_LENGTH_FOR_QUICKSORT)
-		Partition(startingLeft, leftSize, depth + 1);
+	{
+		if (!Spawn(startingLeft, leftSize, depth + 1, true))
+			Partition(startingLeft, leftSize, depth + 1);
+	}
 	else
 		InsertionSort(startingLeft, leftSize);
 
@@ -237,57 +383,407 @@ inline void IntroSort<T>::Partition(T * left, unsigned int count, unsigned int d
 
 
 
-template <class T> 
-inline void IntroSort<T>::InsertionSort(T * array, unsigned int count)
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::SwapOffsets(T * left, T * right, const unsigned char * offsetsLeft, const unsigned char * offsetsRight, unsigned int num, bool useSwaps)
 {
-	// A basic insertion sort.
-	if (count < 3)
+	// Exchange the misplaced values found on both sides.  When there are as many on
+	// both sides we must swap, otherwise a cyclic permutation saves one copy per value.
+	if (useSwaps)
 	{
-		if (count == 2)
-			if (array[0] > array[1])
+		for (unsigned int i = 0; i < num; i++)
+			Swap(left + offsetsLeft[i], right - offsetsRight[i]);
+	}
+	else if (num > 0)
+	{
+		T * l = left + offsetsLeft[0];
+		T * r = right - offsetsRight[0];
+		T temp = std::move(*l);
+		*l = std::move(*r);
+		for (unsigned int i = 1; i < num; i++)
+		{
+			l = left + offsetsLeft[i];
+			*r = std::move(*l);
+			r = right - offsetsRight[i];
+			*l = std::move(*r);
+		}
+		*r = std::move(temp);
+	}
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::Sort3(T * a, T * b, T * c)
+{
+	// sorts three values in place.
+	if (Less(*b, *a))
+		Swap(a, b);
+	if (Less(*c, *b))
+	{
+		Swap(b, c);
+		if (Less(*b, *a))
+			Swap(a, b);
+	}
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline T * IntroSort<T, Compare, Projection>::PartitionRightBranchless(T * begin, T * end, bool & alreadyPartitioned)
+{
+	// BlockQuicksort (Edelkamp & Weiss). Comparisons are not used in branches: their results
+	// are written as offsets in small buffers, one for each side, and values are swapped in
+	// batches once both buffers have some.  Random keys don't cause branch mispredictions.
+	// The pivot is *begin, and a value >= pivot must be somewhere after it to stop the scan
+	// from the left.  Values equal to the pivot go to the right.
+	T pivot = std::move(*begin);
+
+	// skip values already on the right side.
+	T * first = begin;
+	T * last = end;
+	while (Less(*++first, pivot));
+	if (first - 1 == begin)
+		while ((first < last) && !Less(*--last, pivot));
+	else
+		while (!Less(*--last, pivot));
+
+	alreadyPartitioned = first >= last;
+	if (!alreadyPartitioned)
+	{
+		Swap(first++, last);
+
+		unsigned char offsetsLeft[BLOCK_PARTITION_SIZE];
+		unsigned char offsetsRight[BLOCK_PARTITION_SIZE];
+		T * baseLeft = first;
+		T * baseRight = last;
+		unsigned int numLeft = 0, numRight = 0, startLeft = 0, startRight = 0;
+
+		while (first < last)
+		{
+			// fill the empty buffers.  If both are empty the remaining values are split between them.
+			unsigned int numUnknown = last - first;
+			unsigned int leftSplit = numLeft == 0 ? (numRight == 0 ? numUnknown / 2 : numUnknown) : 0;
+			unsigned int rightSplit = numRight == 0 ? (numUnknown - leftSplit) : 0;
+			if (leftSplit > BLOCK_PARTITION_SIZE)
+				leftSplit = BLOCK_PARTITION_SIZE;
+			if (rightSplit > BLOCK_PARTITION_SIZE)
+				rightSplit = BLOCK_PARTITION_SIZE;
+
+			// values >= pivot on the left side, and values < pivot on the right side, are misplaced.
+			for (unsigned int i = 0; i < leftSplit; i++)
+			{
+				offsetsLeft[numLeft] = (unsigned char)i;
+				numLeft += !Less(*first++, pivot);
+			}
+			for (unsigned int i = 0; i < rightSplit; )
+			{
+				offsetsRight[numRight] = (unsigned char)++i;
+				numRight += Less(*--last, pivot);
+			}
+
+			unsigned int num = numLeft < numRight ? numLeft : numRight;
+			SwapOffsets(baseLeft, baseRight, offsetsLeft + startLeft, offsetsRight + startRight, num, numLeft == numRight);
+			numLeft -= num;
+			numRight -= num;
+			startLeft += num;
+			startRight += num;
+
+			if (numLeft == 0)
+			{
+				startLeft = 0;
+				baseLeft = first;
+			}
+			if (numRight == 0)
 			{
-				T temp = array[0];
-				array[0] = array[1];
-				array[1] = temp;
+				startRight = 0;
+				baseRight = last;
 			}
+		}
+
+		// one buffer may still have misplaced values, move them next to the boundary.
+		if (numLeft)
+		{
+			while (numLeft--)
+				Swap(baseLeft + offsetsLeft[startLeft + numLeft], --last);
+			first = last;
+		}
+		if (numRight)
+		{
+			while (numRight--)
+				Swap(baseRight - offsetsRight[startRight + numRight], first++);
+			last = first;
+		}
+	}
+
+	// put the pivot in its final sorted position.
+	T * pivotPosition = first - 1;
+	*begin = std::move(*pivotPosition);
+	*pivotPosition = std::move(pivot);
+	return pivotPosition;
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::BlockPartition(T * array, unsigned int count, unsigned int depth, bool leftmost)
+{
+	if (depth > MAX_DEPTH_BEFORE_HEAPSORT)
+	{
+		// Same fallback as the ternary quicksort.
+		HeapSort(array, count);
 		return;
 	}
 
-	T * ptr2, * ptr3 = array + 1, * ptr4 = array + count;
+	// median of three, moved to the first position.  The smallest one takes its place in
+	// the middle, and the largest one is moved to the last position.
+	T * middle = array + (count >> 1);
+	Sort3(middle, array, array + count - 1);
+
+	// values equal to the pivot go right, so a run of duplicates would only lose one value per
+	// partition and end in heap sort.  As in the adaptive mode, a pivot equal to the previous one
+	// (array[-1]) puts them all on the left, where they're done.
+	if (!leftmost && !Less(array[-1], *array))
+	{
+		T * equalEnd = PartitionLeft(array, array + count) + 1;
+		unsigned int rightSize = count - (equalEnd - array);
+		if (rightSize >= MIN_LENGTH_FOR_QUICKSORT)
+			BlockPartition(equalEnd, rightSize, depth + 1, false);
+		else
+			InsertionSort(equalEnd, rightSize);
+		return;
+	}
+
+	bool alreadyPartitioned;
+	T * pivotPosition = PartitionRightBranchless(array, array + count, alreadyPartitioned);
+
+	unsigned int leftSize = pivotPosition - array;
+	unsigned int rightSize = count - leftSize - 1;
+
+	if (leftSize >= MIN_LENGTH_FOR_QUICKSORT)
+	{
+		if (!Spawn(array, leftSize, depth + 1, leftmost))
+			BlockPartition(array, leftSize, depth + 1, leftmost);
+	}
+	else
+		InsertionSort(array, leftSize);
+
+	if (rightSize >= MIN_LENGTH_FOR_QUICKSORT)
+		BlockPartition(pivotPosition + 1, rightSize, depth + 1, false);
+	else
+		InsertionSort(pivotPosition + 1, rightSize);
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline T * IntroSort<T, Compare, Projection>::PartitionLeft(T * begin, T * end)
+{
+	// Same as PartitionRightBranchless but values equal to the pivot go to the left.  Only
+	// used when there are many of them, so branches are predictable enough.
+	T pivot = std::move(*begin);
+	T * first = begin;
+	T * last = end;
+
+	while (Less(pivot, *--last));
+	if (last + 1 == end)
+		while ((first < last) && !Less(pivot, *++first));
+	else
+		while (!Less(pivot, *++first));
+
+	while (first < last)
+	{
+		Swap(first, last);
+		while (Less(pivot, *--last));
+		while (!Less(pivot, *++first));
+	}
+
+	T * pivotPosition = last;
+	*begin = std::move(*pivotPosition);
+	*pivotPosition = std::move(pivot);
+	return pivotPosition;
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline bool IntroSort<T, Compare, Projection>::PartialInsertionSort(T * begin, T * end)
+{
+	// insertion sort that gives up after a few moves.  Returns true if the range got sorted.
+	if (begin == end)
+		return true;
+
+	unsigned int limit = 0;
+	for (T * cur = begin + 1; cur != end; cur++)
+	{
+		T * sift = cur;
+		T * sift1 = cur - 1;
+		if (Less(*sift, *sift1))
+		{
+			T temp = std::move(*sift);
+			do
+			{
+				*sift-- = std::move(*sift1);
+			} while ((sift != begin) && Less(temp, *--sift1));
+			*sift = std::move(temp);
+			limit += cur - sift;
+		}
+		if (limit > ADAPTIVE_INSERTION_LIMIT)
+			return false;
+	}
+	return true;
+}
+
+
+
+
+
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::AdaptivePartition(T * begin, T * end, int badAllowed, bool leftmost)
+{
+	// pattern-defeating quicksort (Orson Peters).  On top of block partitioning:
+	// - ranges that are already partitioned get a partial insertion sort, so sorted input is linear,
+	// - runs of values equal to a previous pivot are put aside in one pass,
+	// - unbalanced partitions shuffle a few values to break adversarial patterns, and too many of
+	//   them switch to heap sort, like the depth limit of the ternary version.
+	while (true)
+	{
+		unsigned int size = end - begin;
+		if (size < ADAPTIVE_INSERTION_SORT)
+		{
+			InsertionSort(begin, size);
+			return;
+		}
+
+		// pivot is the median of three, or the pseudo-median of nine for large ranges.
+		unsigned int half = size / 2;
+		if (size > ADAPTIVE_NINTHER)
+		{
+			Sort3(begin, begin + half, end - 1);
+			Sort3(begin + 1, begin + (half - 1), end - 2);
+			Sort3(begin + 2, begin + (half + 1), end - 3);
+			Sort3(begin + (half - 1), begin + half, begin + (half + 1));
+			Swap(begin, begin + half);
+		}
+		else
+			Sort3(begin + half, begin, end - 1);
+
+		// begin[-1] is the pivot of a previous partition, and nothing in this range is smaller.
+		// If the new pivot is equal, all the values equal to it go left and they're done.
+		if (!leftmost && !Less(begin[-1], *begin))
+		{
+			begin = PartitionLeft(begin, end) + 1;
+			continue;
+		}
+
+		bool alreadyPartitioned;
+		T * pivotPosition = PartitionRightBranchless(begin, end, alreadyPartitioned);
+
+		unsigned int leftSize = pivotPosition - begin;
+		unsigned int rightSize = end - (pivotPosition + 1);
+		if ((leftSize < size / 8) || (rightSize < size / 8))
+		{
+			// highly unbalanced: we're probably experiencing a bad pattern.
+			if (--badAllowed == 0)
+			{
+				HeapSort(begin, size);
+				return;
+			}
+
+			if (leftSize >= ADAPTIVE_INSERTION_SORT)
+			{
+				Swap(begin, begin + leftSize / 4);
+				Swap(pivotPosition - 1, pivotPosition - leftSize / 4);
+				if (leftSize > ADAPTIVE_NINTHER)
+				{
+					Swap(begin + 1, begin + (leftSize / 4 + 1));
+					Swap(begin + 2, begin + (leftSize / 4 + 2));
+					Swap(pivotPosition - 2, pivotPosition - (leftSize / 4 + 1));
+					Swap(pivotPosition - 3, pivotPosition - (leftSize / 4 + 2));
+				}
+			}
+
+			if (rightSize >= ADAPTIVE_INSERTION_SORT)
+			{
+				Swap(pivotPosition + 1, pivotPosition + (1 + rightSize / 4));
+				Swap(end - 1, end - rightSize / 4);
+				if (rightSize > ADAPTIVE_NINTHER)
+				{
+					Swap(pivotPosition + 2, pivotPosition + (2 + rightSize / 4));
+					Swap(pivotPosition + 3, pivotPosition + (3 + rightSize / 4));
+					Swap(end - 2, end - (1 + rightSize / 4));
+					Swap(end - 3, end - (2 + rightSize / 4));
+				}
+			}
+		}
+		else if (alreadyPartitioned && PartialInsertionSort(begin, pivotPosition) && PartialInsertionSort(pivotPosition + 1, end))
+		{
+			// both sides were (nearly) sorted already.
+			return;
+		}
+
+		// recurse on the left side, loop on the right side.
+		if (!Spawn(begin, leftSize, badAllowed, leftmost))
+			AdaptivePartition(begin, pivotPosition, badAllowed, leftmost);
+		begin = pivotPosition + 1;
+		leftmost = false;
+	}
+}
+
+
+
 
-	if (array[0] > array[1])
+
+
+
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::InsertionSort(T * array, unsigned int count)
+{
+	// A basic insertion sort.
+	if (count < 3)
 	{
-		T temp = array[0];
-		array[0] = array[1];
-		array[1] = temp;
+		if (count == 2)
+			if (Less(array[1], array[0]))
+				Swap(array, array + 1);
+		return;
 	}
 
+	T * ptr2, * ptr3 = array + 1, * ptr4 = array + count;
+
+	if (Less(array[1], array[0]))
+		Swap(array, array + 1);
+
 
 	while (true)
 	{
-		while ((++ptr3 < ptr4) && (*ptr3 >= ptr3[-1]));
+		while ((++ptr3 < ptr4) && !Less(*ptr3, ptr3[-1]));
 		if (ptr3 >= ptr4)
 			break;
 
-		if (ptr3[-2] <= *ptr3)
+		if (!Less(*ptr3, ptr3[-2]))
 		{ 
-			if (ptr3[-1] > *ptr3)
-			{
-				T temp = *ptr3;
-				*ptr3 = ptr3[-1];
-				ptr3[-1] = temp;
-			}
+			if (Less(*ptr3, ptr3[-1]))
+				Swap(ptr3, ptr3 - 1);
 			continue;
 		}
 
 		ptr2 = ptr3 - 1;
-		T v = *ptr3;
-		while ((ptr2 >= array) && (*ptr2 > v))
+		T v = std::move(*ptr3);
+		while ((ptr2 >= array) && Less(v, *ptr2))
 		{
-			ptr2[1] = ptr2[0];
+			ptr2[1] = std::move(ptr2[0]);
 			ptr2--;
 		}
-		ptr2[1] = v;
+		ptr2[1] = std::move(v);
 	}
 }
 
@@ -295,8 +791,8 @@ inline void IntroSort<T>::InsertionSort(T * array, unsigned int count)
 
 
 
-template <class T> 
-inline void IntroSort<T>::HeapSort(T * array, int length)
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::HeapSort(T * array, int length)
 {
 	// A basic heapsort.
 	for (int k = length >> 1; k > 0; k--)
@@ -304,9 +800,8 @@ inline void IntroSort<T>::HeapSort(T * array, int length)
 
 	do
 	{
-		T temp = array[0];
-		array[0] = array[--length];
-		array[length] = temp;
+		length--;
+		Swap(array, array + length);
         HeapSort(array, 1, length);
 	} while (length > 1);
 }
@@ -315,28 +810,28 @@ inline void IntroSort<T>::HeapSort(T * array, int length)
 
 
 
-template <class T> 
-inline void IntroSort<T>::HeapSort(T * array, int k, int N)
+template <class T, class Compare, class Projection>
+inline void IntroSort<T, Compare, Projection>::HeapSort(T * array, int k, int N)
 {
 	// A basic heapsort.
-	T temp = array[k - 1];
+	T temp = std::move(array[k - 1]);
 	int n = N >> 1;
 
 	while (k <= n)
 	{
 		int j = (k << 1);
-        if ((j < N) && (array[j - 1] < array[j]))
+        if ((j < N) && Less(array[j - 1], array[j]))
 	        j++;
-	    if (temp >= array[j - 1])
+	    if (!Less(temp, array[j - 1]))
 			break;
 	    else 
 		{
-			array[k - 1] = array[j - 1];
+			array[k - 1] = std::move(array[j - 1]);
 			k = j;
         }
 	}
 
-    array[k - 1] = temp;
+    array[k - 1] = std::move(temp);
 }
 
 
@@ -0,0 +1,237 @@
+#include "stdafx.h"
+#include "MergeSort.h"
+
+// SIMD merge kernels.
+// Two sorted blocks of 4 values are merged with a bitonic network: the second block is reversed, a min/max between
+// both gives two bitonic blocks (the 4 smallest values and the 4 largest ones), which are sorted with 2 more min/max
+// steps each. The merge streams through the inputs: the 4 smallest values are written out, the 4 largest ones are
+// merged again with the next block, taken from the input whose next value is the smallest. There's no branch on the
+// values, except for picking the next block.
+//
+// SSE2 has no unsigned compare, so keys are flipped to signed when loaded and flipped back when stored.
+// Pairs are compared on (key, id), which is a total order: the result doesn't depend on the network.
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define MERGE_SORT_SSE2
+#endif
+
+#ifdef MERGE_SORT_SSE2
+
+namespace
+{
+	inline_ __m128i Select(const __m128i& mask, const __m128i& a, const __m128i& b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// 4 udword keys
+	struct KeyBlock
+	{
+		typedef udword	Value;
+
+		__m128i	mKeys;
+
+		static inline_ bool		Less(const Value& a, const Value& b)	{ return a<b;	}
+
+		inline_ void	Load(const Value* p)
+		{
+			mKeys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi32(0x80000000));
+		}
+
+		inline_ void	Store(Value* p)	const
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_xor_si128(mKeys, _mm_set1_epi32(0x80000000)));
+		}
+
+		// Mask of the lanes where this > b
+		inline_ __m128i	Greater(const KeyBlock& b)	const	{ return _mm_cmpgt_epi32(mKeys, b.mKeys);	}
+
+		inline_ void	Select(const __m128i& mask, const KeyBlock& a, const KeyBlock& b)	{ mKeys = ::Select(mask, a.mKeys, b.mKeys);	}
+
+		template<int Imm>
+		inline_ void	Shuffle(const KeyBlock& b)	{ mKeys = _mm_shuffle_epi32(b.mKeys, Imm);	}
+
+		inline_ void	UnpackLo64(const KeyBlock& a, const KeyBlock& b)	{ mKeys = _mm_unpacklo_epi64(a.mKeys, b.mKeys);	}
+	};
+
+	// 4 key/id pairs, deinterleaved
+	struct PairBlock
+	{
+		typedef MergePair	Value;
+
+		__m128i	mKeys;
+		__m128i	mIDs;
+
+		static inline_ bool		Less(const Value& a, const Value& b)	{ return a<b;	}
+
+		inline_ void	Load(const Value* p)
+		{
+			const __m128i* Src = reinterpret_cast<const __m128i*>(p);
+			// k0 i0 k1 i1 / k2 i2 k3 i3 => k0 k1 i0 i1 / k2 k3 i2 i3
+			const __m128i P0 = _mm_shuffle_epi32(_mm_loadu_si128(Src), _MM_SHUFFLE(3,1,2,0));
+			const __m128i P1 = _mm_shuffle_epi32(_mm_loadu_si128(Src+1), _MM_SHUFFLE(3,1,2,0));
+			const __m128i SignBit = _mm_set1_epi32(0x80000000);
+			mKeys	= _mm_xor_si128(_mm_unpacklo_epi64(P0, P1), SignBit);
+			mIDs	= _mm_xor_si128(_mm_unpackhi_epi64(P0, P1), SignBit);
+		}
+
+		inline_ void	Store(Value* p)	const
+		{
+			const __m128i SignBit = _mm_set1_epi32(0x80000000);
+			const __m128i Keys = _mm_xor_si128(mKeys, SignBit);
+			const __m128i IDs = _mm_xor_si128(mIDs, SignBit);
+			__m128i* Dst = reinterpret_cast<__m128i*>(p);
+			_mm_storeu_si128(Dst, _mm_unpacklo_epi32(Keys, IDs));
+			_mm_storeu_si128(Dst+1, _mm_unpackhi_epi32(Keys, IDs));
+		}
+
+		inline_ __m128i	Greater(const PairBlock& b)	const
+		{
+			const __m128i KeyGreater = _mm_cmpgt_epi32(mKeys, b.mKeys);
+			const __m128i KeyEqual = _mm_cmpeq_epi32(mKeys, b.mKeys);
+			return _mm_or_si128(KeyGreater, _mm_and_si128(KeyEqual, _mm_cmpgt_epi32(mIDs, b.mIDs)));
+		}
+
+		inline_ void	Select(const __m128i& mask, const PairBlock& a, const PairBlock& b)
+		{
+			mKeys	= ::Select(mask, a.mKeys, b.mKeys);
+			mIDs	= ::Select(mask, a.mIDs, b.mIDs);
+		}
+
+		template<int Imm>
+		inline_ void	Shuffle(const PairBlock& b)
+		{
+			mKeys	= _mm_shuffle_epi32(b.mKeys, Imm);
+			mIDs	= _mm_shuffle_epi32(b.mIDs, Imm);
+		}
+
+		inline_ void	UnpackLo64(const PairBlock& a, const PairBlock& b)
+		{
+			mKeys	= _mm_unpacklo_epi64(a.mKeys, b.mKeys);
+			mIDs	= _mm_unpacklo_epi64(a.mIDs, b.mIDs);
+		}
+	};
+
+	template<class Block>
+	inline_ void MinMax(Block& a, Block& b)
+	{
+		const __m128i Mask = a.Greater(b);
+		const Block A = a;
+		a.Select(Mask, b, A);
+		b.Select(Mask, A, b);
+	}
+
+	// Sorts a bitonic block
+	template<class Block>
+	inline_ void BitonicSort4(Block& v)
+	{
+		// Distance 2: (0,2) and (1,3)
+		Block Mins = v;
+		Block Maxs;
+		Maxs.template Shuffle<_MM_SHUFFLE(1,0,3,2)>(v);
+		MinMax(Mins, Maxs);
+		v.UnpackLo64(Mins, Maxs);
+
+		// Distance 1: (0,1) and (2,3)
+		Mins = v;
+		Maxs.template Shuffle<_MM_SHUFFLE(2,3,0,1)>(v);
+		MinMax(Mins, Maxs);
+		v.Select(_mm_set_epi32(-1, 0, -1, 0), Maxs, Mins);
+	}
+
+	// Merges two sorted blocks: lo gets the 4 smallest values, hi the 4 largest ones
+	template<class Block>
+	inline_ void Merge8(Block& lo, Block& hi)
+	{
+		Block Reversed;
+		Reversed.template Shuffle<_MM_SHUFFLE(0,1,2,3)>(hi);
+		hi = Reversed;
+		MinMax(lo, hi);
+		BitonicSort4(lo);
+		BitonicSort4(hi);
+	}
+
+	template<class Block>
+	void MergeSIMD(const typename Block::Value* a, udword na, const typename Block::Value* b, udword nb, typename Block::Value* dst)
+	{
+		typedef typename Block::Value Value;
+
+		if(na<4 || nb<4)
+		{
+			StableMerge(a, na, b, nb, dst, Block::Less);
+			return;
+		}
+
+		const Value* EndA = a + na;
+		const Value* EndB = b + nb;
+
+		Block Lo, Hi;
+		Lo.Load(a);	a += 4;
+		Hi.Load(b);	b += 4;
+		for(;;)
+		{
+			Merge8(Lo, Hi);
+			Lo.Store(dst);
+			dst += 4;
+
+			// Next block from the input with the smallest next value. We stop when it doesn't have a full block.
+			const Value* Next;
+			if(a==EndA)					Next = b;
+			else if(b==EndB)			Next = a;
+			else						Next = Block::Less(*b, *a) ? b : a;
+
+			if(Next==a)
+			{
+				if(EndA - a < 4)	break;
+				Lo.Load(a);	a += 4;
+			}
+			else
+			{
+				if(EndB - b < 4)	break;
+				Lo.Load(b);	b += 4;
+			}
+		}
+
+		// What's left is larger than what's been written: merge the remaining inputs after the last block, then the last
+		// block with them. The output never catches up with the second input of the final merge.
+		Value Last[4];
+		Hi.Store(Last);
+		Value* Rest = dst + 4;
+		const udword NbRest = udword((EndA - a) + (EndB - b));
+		StableMerge(a, udword(EndA - a), b, udword(EndB - b), Rest, Block::Less);
+
+		udword i = 0;
+		udword j = 0;
+		while(i<4 && j<NbRest)
+		{
+			if(Block::Less(Rest[j], Last[i]))	*dst++ = Rest[j++];
+			else								*dst++ = Last[i++];
+		}
+		while(i<4)	*dst++ = Last[i++];
+	}
+}
+
+void MergeKeys(const udword* a, udword na, const udword* b, udword nb, udword* dst)
+{
+	MergeSIMD<KeyBlock>(a, na, b, nb, dst);
+}
+
+void MergePairs(const MergePair* a, udword na, const MergePair* b, udword nb, MergePair* dst)
+{
+	MergeSIMD<PairBlock>(a, na, b, nb, dst);
+}
+
+#else
+
+void MergeKeys(const udword* a, udword na, const udword* b, udword nb, udword* dst)
+{
+	StableMerge(a, na, b, nb, dst, IntroSortLess());
+}
+
+void MergePairs(const MergePair* a, udword na, const MergePair* b, udword nb, MergePair* dst)
+{
+	StableMerge(a, na, b, nb, dst, IntroSortLess());
+}
+
+#endif
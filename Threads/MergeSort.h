@@ -0,0 +1,449 @@
+#ifndef MERGE_SORT_H
+#define MERGE_SORT_H
+
+#include "IntroSort.h"
+
+	// Stable merge sort, for keys that can't be radix sorted. IntroSort and std::sort are not stable.
+	// - runs of MERGE_SORT_RUN values are insertion sorted, then merged bottom-up, ping-ponging with a scratch buffer,
+	// - in parallel, each thread sorts one chunk, then the chunks are merged in rounds. Each merge is split in equal
+	//   slices with merge path (binary search on the diagonals of the merge matrix), so all threads stay busy even
+	//   when only two runs are left,
+	// - udword keys and MergePair values use SIMD (bitonic network) merge kernels, see MergeSort.cpp.
+
+	#define MERGE_SORT_RUN			32		// Insertion sorted runs
+	#define MERGE_SORT_MIN_SLICE	8192	// Smallest piece of merge given to a thread
+
+	//! Key & id, e.g. a key and its rank. Ordered by key, then by id: when ids are the original indices, that's the stable order.
+	struct MergePair
+	{
+		udword	mKey;
+		udword	mID;
+	};
+
+	inline_ bool operator<(const MergePair& a, const MergePair& b)
+	{
+		return a.mKey<b.mKey || (a.mKey==b.mKey && a.mID<b.mID);
+	}
+
+	// SIMD merge kernels, falling back to scalar code when SSE2 isn't available. dst can't overlap the inputs.
+	void	MergeKeys(const udword* a, udword na, const udword* b, udword nb, udword* dst);
+	void	MergePairs(const MergePair* a, udword na, const MergePair* b, udword nb, MergePair* dst);
+
+	//! Comparator & projection, as in IntroSort
+	template<class T, class Compare, class Projection>
+	struct MergeSortLess
+	{
+		inline_			MergeSortLess(const Compare& compare, const Projection& projection) : mCompare(compare), mProjection(projection)	{}
+
+		inline_	bool	operator()(const T& a, const T& b)	const	{ return mCompare(mProjection(a), mProjection(b));	}
+
+		Compare			mCompare;
+		Projection		mProjection;
+	};
+
+	//! Stable merge of two sorted arrays. Equal values from a come first.
+	template<class T, class Less>
+	void StableMerge(const T* a, udword na, const T* b, udword nb, T* dst, const Less& less)
+	{
+		const T* EndA = a + na;
+		const T* EndB = b + nb;
+		while(a!=EndA && b!=EndB)
+		{
+			if(less(*b, *a))	*dst++ = *b++;
+			else				*dst++ = *a++;
+		}
+		while(a!=EndA)	*dst++ = *a++;
+		while(b!=EndB)	*dst++ = *b++;
+	}
+
+	//! Merge path: returns how many values of a are in the first 'diagonal' values of StableMerge(a, b).
+	template<class T, class Less>
+	udword MergePath(const T* a, udword na, const T* b, udword nb, udword diagonal, const Less& less)
+	{
+		udword Min = diagonal>nb ? diagonal-nb : 0;
+		udword Max = diagonal<na ? diagonal : na;
+		while(Min<Max)
+		{
+			const udword i = (Min + Max)>>1;
+			if(less(b[diagonal - i - 1], a[i]))	Max = i;
+			else								Min = i + 1;
+		}
+		return Min;
+	}
+
+	// Merge kernel used by MergeSort, SIMD for the types that have one
+	template<class T, class Less>
+	struct MergeKernel
+	{
+		static inline_ void	Merge(const T* a, udword na, const T* b, udword nb, T* dst, const Less& less)	{ StableMerge(a, na, b, nb, dst, less);	}
+	};
+
+	template<>
+	struct MergeKernel<udword, MergeSortLess<udword, IntroSortLess, IntroSortIdentity> >
+	{
+		template<class Less>
+		static inline_ void	Merge(const udword* a, udword na, const udword* b, udword nb, udword* dst, const Less&)	{ MergeKeys(a, na, b, nb, dst);	}
+	};
+
+	template<>
+	struct MergeKernel<MergePair, MergeSortLess<MergePair, IntroSortLess, IntroSortIdentity> >
+	{
+		template<class Less>
+		static inline_ void	Merge(const MergePair* a, udword na, const MergePair* b, udword nb, MergePair* dst, const Less&)	{ MergePairs(a, na, b, nb, dst);	}
+	};
+
+	template<class T, class Compare = IntroSortLess, class Projection = IntroSortIdentity>
+	class MergeSort
+	{
+		public:
+		typedef MergeSortLess<T, Compare, Projection>	Less;
+		typedef MergeKernel<T, Less>					Kernel;
+
+										MergeSort(const Compare& compare = Compare(), const Projection& projection = Projection());
+										~MergeSort();
+
+		// Stable sort, in place. Returns false if the scratch buffer can't be allocated.
+						bool			Sort(T* array, udword nb, SortExecutor* executor = GetSortExecutor());
+		// Stable merge of two sorted arrays into dst, which can't overlap them. Equal values from a come first.
+						void			Merge(const T* a, udword na, const T* b, udword nb, T* dst, SortExecutor* executor = GetSortExecutor())	const;
+		// Merges adjacent sorted runs in place, e.g. the buckets of another sort. Returns false if the scratch buffer can't be allocated.
+						bool			MergeRuns(T* array, const udword* run_sizes, udword nb_runs, SortExecutor* executor = GetSortExecutor());
+
+		inline_			udword			GetUsedRam()	const	{ return sizeof(MergeSort) + mBufferSize*sizeof(T);	}
+
+										PREVENT_COPY(MergeSort)
+		private:
+						Less			mLess;
+						T*				mBuffer;		//!< Scratch buffer, as large as the largest array
+						udword			mBufferSize;
+
+						bool			CheckResize(udword nb);
+						void			InsertionSort(T* array, udword nb)	const;
+						void			SortChunk(T* array, T* buffer, udword nb)	const;
+						void			MergeRound(const T* src, T* dst, const udword* offsets, udword nb_runs, SortExecutor* executor)	const;
+						bool			MergeAll(T* array, udword* offsets, udword nb_runs, SortExecutor* executor);
+
+		// Parallel jobs
+		struct ChunkContext
+		{
+			const MergeSort*	mSorter;
+			T*					mArray;
+			T*					mBuffer;
+			const udword*		mOffsets;
+		};
+
+		struct SliceContext
+		{
+			const MergeSort*	mSorter;
+			const T*			mSrc;
+			T*					mDst;
+			const udword*		mOffsets;		//!< Offsets of the runs
+			const udword*		mFirstSlice;	//!< First slice of each pair of runs
+			udword				mNbPairs;
+			udword				mNbRuns;
+			udword				mSliceSize;
+		};
+
+		static			void			SortChunkJob(udword index, void* user_data);
+		static			void			MergeSliceJob(udword index, void* user_data);
+	};
+
+	template<class T, class Compare, class Projection>
+	MergeSort<T, Compare, Projection>::MergeSort(const Compare& compare, const Projection& projection) :
+		mLess		(compare, projection),
+		mBuffer		(null),
+		mBufferSize	(0)
+	{
+	}
+
+	template<class T, class Compare, class Projection>
+	MergeSort<T, Compare, Projection>::~MergeSort()
+	{
+		DELETEARRAY(mBuffer);
+	}
+
+	template<class T, class Compare, class Projection>
+	bool MergeSort<T, Compare, Projection>::CheckResize(udword nb)
+	{
+		if(nb<=mBufferSize)	return true;
+
+		DELETEARRAY(mBuffer);
+		mBufferSize = 0;
+		mBuffer = new T[nb];
+		CHECKALLOC(mBuffer);
+		mBufferSize = nb;
+		return true;
+	}
+
+	template<class T, class Compare, class Projection>
+	void MergeSort<T, Compare, Projection>::InsertionSort(T* array, udword nb) const
+	{
+		// Stable: a value only moves past strictly greater ones
+		for(udword i=1;i<nb;i++)
+		{
+			if(!mLess(array[i], array[i-1]))
+				continue;
+
+			T Value = std::move(array[i]);
+			udword j = i;
+			do
+			{
+				array[j] = std::move(array[j-1]);
+				j--;
+			}while(j && mLess(Value, array[j-1]));
+			array[j] = std::move(Value);
+		}
+	}
+
+	// Serial bottom-up merge sort. The result ends up in array.
+	template<class T, class Compare, class Projection>
+	void MergeSort<T, Compare, Projection>::SortChunk(T* array, T* buffer, udword nb) const
+	{
+		udword NbPasses = 0;
+		for(udword Width=MERGE_SORT_RUN;Width<nb;Width*=2)
+			NbPasses++;
+
+		// With an odd number of passes we start in the buffer, so that the last pass writes to the array
+		T* Src = array;
+		T* Dst = buffer;
+		if(NbPasses&1)
+		{
+			for(udword i=0;i<nb;i++)
+				buffer[i] = std::move(array[i]);
+			Src = buffer;
+			Dst = array;
+		}
+
+		for(udword i=0;i<nb;i+=MERGE_SORT_RUN)
+			InsertionSort(Src + i, nb - i < MERGE_SORT_RUN ? nb - i : MERGE_SORT_RUN);
+
+		for(udword Width=MERGE_SORT_RUN;Width<nb;Width*=2)
+		{
+			for(udword i=0;i<nb;i+=Width*2)
+			{
+				const udword NbA = nb - i < Width ? nb - i : Width;
+				const udword NbB = nb - i - NbA < Width ? nb - i - NbA : Width;
+				Kernel::Merge(Src + i, NbA, Src + i + NbA, NbB, Dst + i, mLess);
+			}
+			T* Tmp = Src;	Src = Dst;	Dst = Tmp;
+		}
+	}
+
+	template<class T, class Compare, class Projection>
+	void MergeSort<T, Compare, Projection>::SortChunkJob(udword index, void* user_data)
+	{
+		const ChunkContext* Context = reinterpret_cast<const ChunkContext*>(user_data);
+		const udword Start = Context->mOffsets[index];
+		const udword Nb = Context->mOffsets[index+1] - Start;
+		Context->mSorter->SortChunk(Context->mArray + Start, Context->mBuffer + Start, Nb);
+	}
+
+	template<class T, class Compare, class Projection>
+	void MergeSort<T, Compare, Projection>::MergeSliceJob(udword index, void* user_data)
+	{
+		const SliceContext* Context = reinterpret_cast<const SliceContext*>(user_data);
+
+		// Find the pair of runs this slice belongs to, i.e. the last one starting before it. Empty pairs have no slice,
+		// they start where the next pair starts.
+		udword Pair = 0;
+		udword Max = Context->mNbPairs;
+		while(Max-Pair>1)
+		{
+			const udword Mid = (Pair + Max)>>1;
+			if(Context->mFirstSlice[Mid]<=index)	Pair = Mid;
+			else									Max = Mid;
+		}
+
+		const udword Start = Context->mOffsets[Pair*2];
+		const udword Middle = Context->mOffsets[Pair*2+1];
+		// An odd run out is just copied
+		const udword End = Pair*2+2<=Context->mNbRuns ? Context->mOffsets[Pair*2+2] : Middle;
+
+		const T* A = Context->mSrc + Start;
+		const T* B = Context->mSrc + Middle;
+		const udword NbA = Middle - Start;
+		const udword NbB = End - Middle;
+
+		// Slice of the output, and the matching input ranges
+		const udword First = (index - Context->mFirstSlice[Pair]) * Context->mSliceSize;
+		const udword Total = NbA + NbB;
+		const udword Last = First + Context->mSliceSize < Total ? First + Context->mSliceSize : Total;
+
+		const Less& L = Context->mSorter->mLess;
+		const udword A0 = MergePath(A, NbA, B, NbB, First, L);
+		const udword A1 = MergePath(A, NbA, B, NbB, Last, L);
+		const udword B0 = First - A0;
+		const udword B1 = Last - A1;
+		Kernel::Merge(A + A0, A1 - A0, B + B0, B1 - B0, Context->mDst + Start + First, L);
+	}
+
+	// Merges pairs of runs from src to dst, in parallel slices
+	template<class T, class Compare, class Projection>
+	void MergeSort<T, Compare, Projection>::MergeRound(const T* src, T* dst, const udword* offsets, udword nb_runs, SortExecutor* executor) const
+	{
+		const udword NbPairs = (nb_runs+1)/2;
+		const udword Nb = offsets[nb_runs];
+
+		// Slices of about the same size, at least one per thread
+		const udword NbThreads = (executor ? executor->GetNbThreads() : 0) + 1;
+		udword SliceSize = Nb/(NbThreads*2) + 1;
+		if(SliceSize<MERGE_SORT_MIN_SLICE)
+			SliceSize = MERGE_SORT_MIN_SLICE;
+
+		udword* FirstSlice = reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*NbPairs));
+		udword NbSlices = 0;
+		for(udword i=0;i<NbPairs;i++)
+		{
+			const udword End = i*2+2<=nb_runs ? offsets[i*2+2] : offsets[nb_runs];
+			const udword Size = End - offsets[i*2];
+			if(FirstSlice)
+				FirstSlice[i] = NbSlices;
+			NbSlices += Size ? (Size + SliceSize - 1)/SliceSize : 0;
+		}
+
+		if(!FirstSlice || !executor)
+		{
+			for(udword i=0;i<NbPairs;i++)
+			{
+				const udword Start = offsets[i*2];
+				const udword Middle = offsets[i*2+1];
+				const udword End = i*2+2<=nb_runs ? offsets[i*2+2] : Middle;
+				Kernel::Merge(src + Start, Middle - Start, src + Middle, End - Middle, dst + Start, mLess);
+			}
+		}
+		else
+		{
+			SliceContext Context;
+			Context.mSorter		= this;
+			Context.mSrc		= src;
+			Context.mDst		= dst;
+			Context.mOffsets	= offsets;
+			Context.mFirstSlice	= FirstSlice;
+			Context.mNbPairs	= NbPairs;
+			Context.mNbRuns		= nb_runs;
+			Context.mSliceSize	= SliceSize;
+			executor->ParallelFor(NbSlices, MergeSliceJob, &Context);
+		}
+		ICE_FREE(FirstSlice);
+	}
+
+	// Merges sorted runs until there's only one left. offsets has nb_runs+1 entries and is overwritten.
+	template<class T, class Compare, class Projection>
+	bool MergeSort<T, Compare, Projection>::MergeAll(T* array, udword* offsets, udword nb_runs, SortExecutor* executor)
+	{
+		const udword Nb = offsets[nb_runs];
+		if(!CheckResize(Nb))	return false;
+
+		T* Src = array;
+		T* Dst = mBuffer;
+		while(nb_runs>1)
+		{
+			MergeRound(Src, Dst, offsets, nb_runs, executor);
+
+			// Runs 2i and 2i+1 are now run i
+			for(udword i=1;i<=nb_runs/2;i++)
+				offsets[i] = offsets[i*2];
+			nb_runs = (nb_runs+1)/2;
+			offsets[nb_runs] = Nb;
+
+			T* Tmp = Src;	Src = Dst;	Dst = Tmp;
+		}
+
+		if(Src!=array)
+		{
+			for(udword i=0;i<Nb;i++)
+				array[i] = std::move(Src[i]);
+		}
+		return true;
+	}
+
+	template<class T, class Compare, class Projection>
+	bool MergeSort<T, Compare, Projection>::Sort(T* array, udword nb, SortExecutor* executor)
+	{
+		if(!array || nb<2)	return true;
+		if(!CheckResize(nb))	return false;
+
+		// One chunk per thread at least. A power of 4 gives an even number of merge rounds, so the
+		// result ends up in the array without a final copy.
+		const udword NbThreads = (executor ? executor->GetNbThreads() : 0) + 1;
+		udword NbChunks = 1;
+		while(NbChunks<NbThreads && nb/(NbChunks*4)>=MERGE_SORT_MIN_SLICE)
+			NbChunks *= 4;
+
+		if(NbChunks==1)
+		{
+			SortChunk(array, mBuffer, nb);
+			return true;
+		}
+
+		udword* Offsets = reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*(NbChunks+1)));
+		if(!Offsets)
+		{
+			SortChunk(array, mBuffer, nb);
+			return true;
+		}
+		for(udword i=0;i<=NbChunks;i++)
+			Offsets[i] = udword((uqword(nb)*i)/NbChunks);
+
+		ChunkContext Context;
+		Context.mSorter		= this;
+		Context.mArray		= array;
+		Context.mBuffer		= mBuffer;
+		Context.mOffsets	= Offsets;
+		executor->ParallelFor(NbChunks, SortChunkJob, &Context);
+
+		const bool Status = MergeAll(array, Offsets, NbChunks, executor);
+		ICE_FREE(Offsets);
+		return Status;
+	}
+
+	template<class T, class Compare, class Projection>
+	void MergeSort<T, Compare, Projection>::Merge(const T* a, udword na, const T* b, udword nb, T* dst, SortExecutor* executor) const
+	{
+		// Both inputs can live anywhere, so they're treated as two runs of a virtual array
+		if(!na || !nb || !executor || !executor->GetNbThreads() || na+nb<2*MERGE_SORT_MIN_SLICE)
+		{
+			Kernel::Merge(a, na, b, nb, dst, mLess);
+			return;
+		}
+
+		const udword Nb = na + nb;
+		const udword NbSlices = (executor->GetNbThreads() + 1)*2;
+		const udword SliceSize = (Nb + NbSlices - 1)/NbSlices;
+
+		struct Context
+		{
+			const T* mA; udword mNbA; const T* mB; udword mNbB; T* mDst; udword mSliceSize; udword mNb; const Less* mLess;
+
+			static void Job(udword index, void* user_data)
+			{
+				const Context* C = reinterpret_cast<const Context*>(user_data);
+				const udword First = index * C->mSliceSize;
+				if(First>=C->mNb)	return;
+				const udword Last = First + C->mSliceSize < C->mNb ? First + C->mSliceSize : C->mNb;
+				const udword A0 = MergePath(C->mA, C->mNbA, C->mB, C->mNbB, First, *C->mLess);
+				const udword A1 = MergePath(C->mA, C->mNbA, C->mB, C->mNbB, Last, *C->mLess);
+				Kernel::Merge(C->mA + A0, A1 - A0, C->mB + First - A0, (Last - A1) - (First - A0), C->mDst + First, *C->mLess);
+			}
+		};
+		Context C = { a, na, b, nb, dst, SliceSize, Nb, &mLess };
+		executor->ParallelFor(NbSlices, Context::Job, &C);
+	}
+
+	template<class T, class Compare, class Projection>
+	bool MergeSort<T, Compare, Projection>::MergeRuns(T* array, const udword* run_sizes, udword nb_runs, SortExecutor* executor)
+	{
+		if(!array || !run_sizes || nb_runs<2)	return true;
+
+		udword* Offsets = reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*(nb_runs+1)));
+		CHECKALLOC(Offsets);
+		Offsets[0] = 0;
+		for(udword i=0;i<nb_runs;i++)
+			Offsets[i+1] = Offsets[i] + run_sizes[i];
+
+		const bool Status = MergeAll(array, Offsets, nb_runs, executor);
+		ICE_FREE(Offsets);
+		return Status;
+	}
+
+#endif // MERGE_SORT_H
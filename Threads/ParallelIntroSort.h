@@ -0,0 +1,155 @@
+#ifndef PARALLEL_INTRO_SORT_H
+#define PARALLEL_INTRO_SORT_H
+
+#include "IntroSort.h"
+
+
+//======================================================================//
+// Class: ParallelIntroSort												//
+//																		//
+// IntroSort running on a SortExecutor.  Sub-partitions above a size	//
+// threshold become jobs, which idle workers steal.  Each job			//
+// carries its own recursion depth, so the heap sort fallback works as	//
+// in the serial version.												//
+//																		//
+// Partitioning only depends on the values being partitioned, not on	//
+// which thread does it, so the result is the same as IntroSort's for	//
+// the same mode, including the order of equal keys.					//
+//======================================================================//
+
+
+#define PARALLEL_INTROSORT_MIN_TASK		16384	// Smallest sub-partition sent to another thread
+
+
+
+
+template <class T, class Compare = IntroSortLess, class Projection = IntroSortIdentity>
+class ParallelIntroSort : public IntroSort<T, Compare, Projection>
+{
+public:
+	typedef IntroSort<T, Compare, Projection> Base;
+	typedef typename Base::PartitionMode PartitionMode;
+
+	ParallelIntroSort(PartitionMode mode = ADAPTIVE_PARTITION, unsigned int minTaskSize = PARALLEL_INTROSORT_MIN_TASK,
+						const Compare & compare = Compare(), const Projection & projection = Projection());
+
+	virtual ~ParallelIntroSort();
+
+	// sorts on the default executor (see SetSortExecutor), the calling thread takes part.  Returns when the array is sorted.
+	void Sort(T * array, unsigned int count);
+
+	// sorts on a given executor instead of the default one.
+	void Sort(T * array, unsigned int count, SortExecutor * executor);
+
+protected:
+	virtual bool SpawnPartition(T * array, unsigned int count, unsigned int depth, bool leftmost);
+
+private:
+	// one sub-partition.  Allocated when spawned, deleted once done.
+	class Task : public SortJob
+	{
+	public:
+		Task(ParallelIntroSort * sorter, T * array, unsigned int count, unsigned int depth, bool leftmost) :
+			sorter(sorter), array(array), count(count), depth(depth), leftmost(leftmost) {}
+
+		virtual void Execute();
+
+	private:
+		ParallelIntroSort * sorter;
+		T * array;
+		unsigned int count;
+		unsigned int depth;
+		bool leftmost;
+	};
+
+	SortExecutor * executor;
+	unsigned int minTaskSize;
+	std::atomic<unsigned int> pendingTasks;
+
+	PREVENT_COPY(ParallelIntroSort)
+};
+
+
+
+//=====================================================================
+// Begin ParallelIntroSort methods:
+//=====================================================================
+
+template <class T, class Compare, class Projection>
+ParallelIntroSort<T, Compare, Projection>::ParallelIntroSort(PartitionMode mode, unsigned int minTaskSize, const Compare & compare, const Projection & projection) :
+	Base(mode, compare, projection), executor(null), minTaskSize(minTaskSize), pendingTasks(0)
+{
+	// constructor
+}
+
+
+
+template <class T, class Compare, class Projection>
+ParallelIntroSort<T, Compare, Projection>::~ParallelIntroSort()
+{
+	// destructor
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+inline void ParallelIntroSort<T, Compare, Projection>::Sort(T * array, unsigned int count)
+{
+	Sort(array, count, GetSortExecutor());
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+void ParallelIntroSort<T, Compare, Projection>::Sort(T * array, unsigned int count, SortExecutor * executor)
+{
+	// not worth it without at least two sub-partitions, or without workers.
+	if (!executor || !executor->GetNbThreads() || (count < 2 * minTaskSize))
+	{
+		Base::Sort(array, count);
+		return;
+	}
+
+	this->executor = executor;
+	this->spawnThreshold = minTaskSize < MIN_LENGTH_FOR_QUICKSORT ? MIN_LENGTH_FOR_QUICKSORT : minTaskSize;
+	pendingTasks = 0;
+
+	// the calling thread sorts the root partition, spawning the others as it goes.
+	Base::Sort(array, count);
+
+	// then waits until all spawned partitions are done.  The built-in pool helps the workers meanwhile.
+	executor->Wait(pendingTasks);
+
+	this->spawnThreshold = ~0u;
+	this->executor = null;
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+bool ParallelIntroSort<T, Compare, Projection>::SpawnPartition(T * array, unsigned int count, unsigned int depth, bool leftmost)
+{
+	// new throws when out of memory, so the sub-partition is always handed over.
+	Task * task = new Task(this, array, count, depth, leftmost);
+	pendingTasks++;
+	executor->Submit(task);
+	return true;
+}
+
+
+
+
+template <class T, class Compare, class Projection>
+void ParallelIntroSort<T, Compare, Projection>::Task::Execute()
+{
+	// the sorter might be gone as soon as the counter is decremented, so this is the last thing we do.
+	ParallelIntroSort * owner = sorter;
+	owner->SortPartition(array, count, depth, leftmost);
+	delete this;
+	owner->pendingTasks--;
+}
+
+#endif
@@ -2,8 +2,34 @@
 
 void TestRadix();
 void TestRadix2();
+void TestRadixBits();
+void TestLazyRadix();
+void TestParallelRadix();
+void TestSampleSort();
+void TestParallelRadixStability();
+void TestSampleSortStability();
+void TestMergeSortStability();
+void TestCustomExecutor();
+void TestDispatcherScratchMemory();
+void TestDispatcherPresorted();
+void TestSortProfile();
+void TestPermutation();
+void TestPermutationKernels();
+void TestRecordSort();
+void TestRecordSortModes();
+void TestStringSort();
+void TestStringSortStability();
 void TestIntroSort();
+void TestIntroSortDuplicates();
 void TestStdSort();
+void TestSignedHints();
+void TestHalfFloats();
+void TestNaNPolicies();
+void TestLazySort();
+void TestStreamingSort();
+void TestSortAsync();
+void TestNumaOutOfMemory();
+void TestLargeRadix();
 void InitSortValues();
 void ReleaseSortValues();
 
@@ -12,8 +38,34 @@ int _tmain(int argc, _TCHAR* argv[])
 	InitSortValues();
 	TestRadix();
 	TestRadix2();
+	TestRadixBits();
+	TestLazyRadix();
+	TestParallelRadix();
+	TestSampleSort();
+	TestParallelRadixStability();
+	TestSampleSortStability();
+	TestMergeSortStability();
+	TestCustomExecutor();
+	TestDispatcherScratchMemory();
+	TestDispatcherPresorted();
+	TestSortProfile();
+	TestPermutation();
+	TestPermutationKernels();
+	TestRecordSort();
+	TestRecordSortModes();
+	TestStringSort();
+	TestStringSortStability();
 	TestIntroSort();
+	TestIntroSortDuplicates();
 	TestStdSort();
+	TestSignedHints();
+	TestHalfFloats();
+	TestNaNPolicies();
+	TestLazySort();
+	TestStreamingSort();
+	TestSortAsync();
+	TestNumaOutOfMemory();
+	TestLargeRadix();
 	ReleaseSortValues();
 	return 0;
 }
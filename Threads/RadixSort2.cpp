@@ -4,44 +4,14 @@
 // Radix sort revisited again
 // -> Pierre Terdiman 2018
 
-// For little-endian machines
-	#define H0_OFFSET	0
-	#define H1_OFFSET	256
-	#define H2_OFFSET	512
-	#define H3_OFFSET	768
-	#define BYTES_INC	j
-
-static void createHist(udword* histogram1024, const udword* input, udword nb)
+// Keys known to fit in 16 bits only need the first two histograms
+struct RadixKeyU32Low16 : RadixKeyU32
 {
-	ZeroMemory(histogram1024, 256*4*sizeof(udword));
+	enum { NbBits = 16 };
+};
 
-	const ubyte* p = reinterpret_cast<const ubyte*>(input);
-	const ubyte* pe = &p[nb*4];
-	udword* h0 = &histogram1024[H0_OFFSET];
-	udword* h1 = &histogram1024[H1_OFFSET];
-	udword* h2 = &histogram1024[H2_OFFSET];
-	udword* h3 = &histogram1024[H3_OFFSET];
-
-	while(p!=pe)
-	{
-		h0[*p++]++;
-		h1[*p++]++;
-		h2[*p++]++;
-		h3[*p++]++;
-	}
-}
-
-static inline_ const udword* CheckPassValidity(udword pass, const udword* mHistogram1024, udword nb, const void* input)
-{
-	const udword* CurCount = &mHistogram1024[pass<<8];
-
-	const ubyte UniqueVal = *((reinterpret_cast<const ubyte*>(input))+pass);
-
-	if(CurCount[UniqueVal]==nb)
-		return null;
-
-	return CurCount;
-}
+typedef RadixEngine<RadixKeyU32, 8>			Engine;
+typedef RadixEngine<RadixKeyU32Low16, 8>	Engine16;
 
 RadixSort2::RadixSort2() : mCurrentSize(0)
 {
@@ -50,6 +20,7 @@ RadixSort2::RadixSort2() : mCurrentSize(0)
 
 RadixSort2::~RadixSort2()
 {
+	mFuture.Wait();
 	ICE_FREE(mSortedCombo2);
 	ICE_FREE(mSortedCombo);
 }
@@ -63,52 +34,50 @@ bool RadixSort2::Resize(udword nb)
 	return true;
 }
 
-template<udword j>
-static void sortLoop(const Combo* Indices, const Combo* IndicesEnd, const ubyte* InputBytes2, Combo* sortedCombo2, udword* offsets)
+// One radix pass. The first pass reads keys from the input, the next ones read (rank, value) combos sequentially.
+// The last pass doesn't output the final sorted value since we don't need it.
+template<udword j, bool firstPass, bool lastPass>
+static void sortLoop(const udword* input, const Combo* combos, udword nb, Combo* sortedCombo2, const udword* counts)
 {
-	Combo* links[256];
-	for(udword i=0;i<256;i++)
-		links[i] = sortedCombo2 + offsets[i];
+	udword offsets[256];
+	offsets[0] = 0;
+	for(udword i=1;i<256;i++)
+		offsets[i] = offsets[i-1] + counts[i-1];
 
-	while(Indices!=IndicesEnd)
+	udword* base = reinterpret_cast<udword*>(sortedCombo2);
+	for(udword i=0;i<nb;i++)
 	{
-		const udword sortedValue = *reinterpret_cast<const udword*>(InputBytes2);
-		const ubyte id = *(InputBytes2 + BYTES_INC);
-		Combo* dest = links[id]++;
-		const udword index = Indices->mRank;
-		Indices++;
-		InputBytes2 += sizeof(Combo);
-		dest->mRank = index;
-		dest->mValue = sortedValue;
+		const udword sortedValue = firstPass ? input[i] : combos[i].mValue;
+		const udword index = firstPass ? i : combos[i].mRank;
+		const udword id = Engine::GetDigit<j>(sortedValue);
+		if(lastPass)
+		{
+			base[offsets[id]++] = index;
+		}
+		else
+		{
+			Combo* dest = sortedCombo2 + offsets[id]++;
+			ASSERT(dest<sortedCombo2+nb);
+			dest->mRank = index;
+			dest->mValue = sortedValue;
+		}
 	}
 }
 
-// This special version doesn't output the final sorted value since we don't need it
-template<udword j>
-static void sortLoop2(const Combo* Indices, const Combo* IndicesEnd, const ubyte* InputBytes2, Combo* sortedCombo2, udword* offsets)
-{
-	udword* links[256];
-	udword* base = reinterpret_cast<udword*>(sortedCombo2);
-	for(udword i=0;i<256;i++)
-		links[i] = base + offsets[i];
+typedef void (*SortLoop)(const udword* input, const Combo* combos, udword nb, Combo* sortedCombo2, const udword* counts);
 
-	while(Indices!=IndicesEnd)
-	{
-		const ubyte id = *(InputBytes2 + BYTES_INC);
-		udword* dest = links[id]++;
-		const udword index = Indices->mRank;
-		Indices++;
-		InputBytes2 += sizeof(Combo);
-		*dest = index;
-	}
-}
+// Indexed by pass number, first pass, last pass
+#define SORT_LOOPS(j)	{ { sortLoop<j, false, false>, sortLoop<j, false, true> }, { sortLoop<j, true, false>, sortLoop<j, true, true> } }
+static const SortLoop gSortLoops[4][2][2] = { SORT_LOOPS(0), SORT_LOOPS(1), SORT_LOOPS(2), SORT_LOOPS(3) };
+#undef SORT_LOOPS
 
 // This version is only for positive integers and doesn't support "temporal coherence".
 // Main improvements are:
 // - output put both rank and sorted value for each pass. Then the next pass reads the new values sequentially.
 // - output both rank/value together as a combo structure instead of writing to separate arrays
 // - skip the value output in the last pass
-udword* RadixSort2::Sort(const udword* input, udword nb)
+// Hints: mNbBits limits the number of histograms & passes, RADIX_PRESORTED checks for already sorted input first.
+udword* RadixSort2::Sort(const udword* input, udword nb, const RadixHints& hints)
 {
 	if(!input || !nb)
 		return null;
@@ -123,99 +92,62 @@ udword* RadixSort2::Sort(const udword* input, udword nb)
 		}
 	}
 
-	udword histogram[1024];
-	createHist(histogram, input, nb);
+	udword* ranks = reinterpret_cast<udword*>(mSortedCombo);
+
+	// Cheap early exit for presorted input. The combo buffer is large enough to hold the ranks.
+	if(hints.mFlags & RADIX_PRESORTED)
+	{
+		udword i=1;
+		while(i<nb && input[i-1]<=input[i])
+			i++;
+		if(i==nb)
+		{
+			for(udword i=0;i<nb;i++)
+				ranks[i] = i;
+			return ranks;
+		}
+	}
+
+	const udword NbPasses = hints.GetNbPasses(8, 4);
+
+	udword histogram[Engine::HistogramSize];
+	if(NbPasses<=2)
+		Engine16::CreateHistograms(input, nb, histogram);
+	else
+		Engine::CreateHistograms(input, nb, histogram);
 
 	// We need to know ahead of time which one will be the final pass
-	const udword* PassValidity[4];
+	const bool PassValidity[4] =
+	{
+		Engine::IsPassUseful<0>(input, nb, histogram),
+		NbPasses>1 && Engine::IsPassUseful<1>(input, nb, histogram),
+		NbPasses>2 && Engine::IsPassUseful<2>(input, nb, histogram),
+		NbPasses>3 && Engine::IsPassUseful<3>(input, nb, histogram),
+	};
 	udword LastPass = 0xffffffff;
-	for(udword j=0;j<4;j++)
+	for(udword j=0;j<NbPasses;j++)
 	{
-		const udword* ValidPass = CheckPassValidity(j, histogram, nb, input);
-		PassValidity[j] = ValidPass;
-		if(ValidPass)
+		if(PassValidity[j])
 			LastPass = j;
 	}
 
+	// All values are the same
+	if(LastPass==0xffffffff)
+	{
+		for(udword i=0;i<nb;i++)
+			ranks[i] = i;
+		return ranks;
+	}
+
 	bool invalidRanks = true;
-	for(udword j=0;j<4;j++)
+	for(udword j=0;j<=LastPass;j++)
 	{
-		const udword* CurCount = PassValidity[j];
-		if(!CurCount)
+		if(!PassValidity[j])
 			continue;
 
-		const ubyte* InputBytes = reinterpret_cast<const ubyte*>(input);
-        InputBytes += BYTES_INC;
-
-		if(invalidRanks)
-		{
-			invalidRanks = false;
-
-			// Create links
-			Combo* links[256];
-			{
-				links[0] = mSortedCombo2;
-				for(udword i=1;i<256;i++)
-					links[i] = links[i-1] + CurCount[i-1];
-			}
-
-			// Radix Sort
-			if(j!=LastPass)
-			{
-				for(udword i=0;i<nb;i++)
-				{
-					const ubyte id = InputBytes[i<<2];
-					Combo* dest = links[id]++;
-					ASSERT(dest<mSortedCombo2+nb);
-					const udword sortedValue = input[i];
-					dest->mRank = i;
-					dest->mValue = sortedValue;
-				}
-			}
-			else
-			{
-				ASSERT(0);
-			}
-		}
-		else
-		{
-			// Create offsets
-			udword offsets[256];
-			{
-				offsets[0] = 0;
-				for(udword i=1;i<256;i++)
-					offsets[i] = offsets[i-1] + CurCount[i-1];
-			}
-
-			// Radix Sort
-			const Combo* Indices	= mSortedCombo;
-			const Combo* IndicesEnd	= mSortedCombo + nb;
-
-			const ubyte* InputBytes2 = reinterpret_cast<const ubyte*>(mSortedCombo);
-			InputBytes2 += 4;
-			if(j!=LastPass)
-			{
-				if(j==0)
-					sortLoop<0>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-				else if(j==1)
-					sortLoop<1>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-				else if(j==2)
-					sortLoop<2>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-				else if(j==3)
-					sortLoop<3>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-			}
-			else
-			{
-				if(j==0)
-					sortLoop2<0>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-				else if(j==1)
-					sortLoop2<1>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-				else if(j==2)
-					sortLoop2<2>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-				else if(j==3)
-					sortLoop2<3>(Indices, IndicesEnd, InputBytes2, mSortedCombo2, offsets);
-			}
-		}
+		// Radix Sort
+		gSortLoops[j][invalidRanks][j==LastPass](input, mSortedCombo, nb, mSortedCombo2, &histogram[j<<8]);
+		invalidRanks = false;
 
 		Combo* Tmp	= mSortedCombo;
 		mSortedCombo = mSortedCombo2;
@@ -224,3 +156,13 @@ udword* RadixSort2::Sort(const udword* input, udword nb)
 	return reinterpret_cast<udword*>(mSortedCombo);
 }
 
+static const udword* sortAsync(void* sorter, const void* input, udword nb, const RadixHints& hints)
+{
+	return static_cast<RadixSort2*>(sorter)->Sort(reinterpret_cast<const udword*>(input), nb, hints);
+}
+
+SortFuture& RadixSort2::SortAsync(const udword* input, udword nb, const RadixHints& hints)
+{
+	mFuture.Launch(sortAsync, this, input, nb, hints);
+	return mFuture;
+}
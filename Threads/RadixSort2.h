@@ -13,11 +13,14 @@
 						RadixSort2();
 						~RadixSort2();
 
-				udword*	Sort(const udword* input, udword nb);
+				udword*	Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_UNSIGNED);
+				// Runs on the shared sort thread pool. Don't call Sort() while an asynchronous sort is pending.
+				SortFuture&	SortAsync(const udword* input, udword nb, const RadixHints& hints=RADIX_UNSIGNED);
 
 				udword	mCurrentSize;
 				Combo*	mSortedCombo;
 				Combo*	mSortedCombo2;
+				SortFuture	mFuture;
 		private:
 				void	CheckResize(udword nb);
 				bool	Resize(udword nb);
@@ -1,5 +1,10 @@
 #include "stdafx.h"
 #include "RadixSort2.h"
+#include "SampleSort.h"
+#include "RecordSort.h"
+#include "SortCalibration.h"
+#include "MergeSort.h"
+#include "ParallelIntroSort.h"
 #include <windows.h>
 
 // Companion code for "Radix Redux" article.
@@ -60,6 +65,44 @@ void ReleaseSortValues()
 #define START_PROFILE	udword Time = timeGetTime();
 #define END_PROFILE(x)	printf(x, timeGetTime() - Time);
 
+#include <algorithm>
+
+	// Orders indices by value, for std::stable_sort
+	template<class T, class Less>
+	struct IndexLess
+	{
+		const T*	mValues;
+		Less		mLess;
+		inline_	bool	operator()(udword a, udword b)	const	{ return mLess(mValues[a], mValues[b]);	}
+	};
+
+// Sorted & stable: ranks must be the ones of std::stable_sort. A sortedness check alone misses wrongly ordered ties.
+template<class T, class Less>
+static void CheckRanks(const char* name, const T* values, udword nb, const udword* ranks, const Less& less)
+{
+	udword* Expected = new udword[nb];
+	for(udword i=0;i<nb;i++)
+		Expected[i] = i;
+	const IndexLess<T, Less> Order = { values, less };
+	std::stable_sort(Expected, Expected+nb, Order);
+
+	for(udword i=0;i<nb;i++)
+	{
+		if(!ranks || ranks[i]!=Expected[i])
+		{
+			printf("ERROR! (%s)\n", name);
+			break;
+		}
+	}
+	DELETEARRAY(Expected);
+}
+
+template<class T>
+static void CheckRanks(const char* name, const T* values, udword nb, const udword* ranks)
+{
+	CheckRanks(name, values, nb, ranks, IntroSortLess());
+}
+
 
 void TestRadix2()
 {
@@ -85,6 +128,718 @@ void TestRadix()
 			printf("ERROR!\n");
 }
 
+template<udword NbBits>
+static void TimeRadixBits(const char* format, const char* name)
+{
+	START_PROFILE
+		RadixSortBits<NbBits> RS;
+		const udword* Sorted = RS.Sort(gValues, NB_TO_SORT, RADIX_UNSIGNED).GetRanks();
+	END_PROFILE(format)
+
+	CheckRanks(name, gValues, NB_TO_SORT, Sorted);
+}
+
+// Same as TestRadix for each digit width
+void TestRadixBits()
+{
+	TimeRadixBits<8>("%d (RadixSort8Bits)\n", "RadixSort8Bits");
+	TimeRadixBits<10>("%d (RadixSort10Bits)\n", "RadixSort10Bits");
+	TimeRadixBits<11>("%d (RadixSort11Bits)\n", "RadixSort11Bits");
+	TimeRadixBits<12>("%d (RadixSort12Bits)\n", "RadixSort12Bits");
+	TimeRadixBits<16>("%d (RadixSort16Bits)\n", "RadixSort16Bits");
+}
+
+// Full traversal of the lazy sorted view, i.e. all buckets get sorted
+void TestLazyRadix()
+{
+	START_PROFILE
+		LazyRadixSort LRS;
+		LRS.Init(gValues, NB_TO_SORT, RADIX_UNSIGNED);
+		udword Checksum = 0;
+		for(LazyRadixIterator it=LRS.Begin();it!=LRS.End();++it)
+			Checksum += *it;
+	END_PROFILE("%d (LazyRadix)\n")
+
+	CheckRanks("LazyRadixSort, full traversal", gValues, NB_TO_SORT, LRS.GetNbSorted()==NB_TO_SORT ? LRS.GetRanks(NB_TO_SORT) : null);
+	if(Checksum!=udword(uqword(NB_TO_SORT)*(NB_TO_SORT-1)/2))
+		printf("ERROR! (LazyRadixSort, traversal)\n");
+}
+
+void TestParallelRadix()
+{
+	START_PROFILE
+		ParallelRadixSort RS;
+		const udword* Sorted = RS.Sort(gValues, NB_TO_SORT, RADIX_UNSIGNED).GetRanks();
+	END_PROFILE("%d (ParallelRadix)\n")
+
+	for(udword i=0;i<NB_TO_SORT-1;i++)
+		if(gValues[Sorted[i]]>gValues[Sorted[i+1]])
+			printf("ERROR!\n");
+}
+
+void TestSampleSort()
+{
+	START_PROFILE
+		SampleSort SS;
+		const udword* Sorted = SS.Sort(gValues, NB_TO_SORT, RADIX_UNSIGNED);
+	END_PROFILE("%d (SampleSort)\n")
+
+	for(udword i=0;i<NB_TO_SORT-1;i++)
+		if(gValues[Sorted[i]]>gValues[Sorted[i+1]])
+			printf("ERROR!\n");
+}
+
+	// Key & original index, to check the order of equal keys
+	template<class T>
+	struct IndexedKey
+	{
+		T		mKey;
+		udword	mIndex;
+	};
+
+// Merge sort: equal keys keep the input order, with signed & float keys, on one thread or on the pool. The SIMD kernel of
+// MergePair must agree.
+void TestMergeSortStability()
+{
+	typedef IndexedKey<sdword>	IntKey;
+	typedef IndexedKey<float>	FloatKey;
+
+	const udword Nb = 200000;
+	sdword* Values = new sdword[Nb];
+	float* Floats = new float[Nb];
+	udword* Ranks = new udword[Nb];
+	IntKey* Ints = new IntKey[Nb];
+	FloatKey* FloatKeys = new FloatKey[Nb];
+	MergePair* Pairs = new MergePair[Nb];
+	for(udword i=0;i<Nb;i++)
+	{
+		Values[i] = sdword(gValues[i] % 97) - 48;
+		Floats[i] = float(Values[i])*0.5f;
+	}
+
+	SerialSortExecutor Serial;
+	SortExecutor* Executors[] = { &Serial, GetSortExecutor() };
+	for(udword j=0;j<2;j++)
+	{
+		for(udword i=0;i<Nb;i++)
+		{
+			Ints[i].mKey = Values[i];
+			Ints[i].mIndex = i;
+			FloatKeys[i].mKey = Floats[i];
+			FloatKeys[i].mIndex = i;
+			Pairs[i].mKey = RadixKeyS32::ToSortable(udword(Values[i]));
+			Pairs[i].mID = i;
+		}
+
+		MergeSort<IntKey, IntroSortLess, IntroSortField<IntKey, sdword, &IntKey::mKey> > IntSorter;
+		bool Status = IntSorter.Sort(Ints, Nb, Executors[j]);
+		for(udword i=0;i<Nb;i++)
+			Ranks[i] = Ints[i].mIndex;
+		CheckRanks("MergeSort", Values, Nb, Status ? Ranks : null);
+
+		MergeSort<FloatKey, IntroSortLess, IntroSortField<FloatKey, float, &FloatKey::mKey> > FloatSorter;
+		Status = FloatSorter.Sort(FloatKeys, Nb, Executors[j]);
+		for(udword i=0;i<Nb;i++)
+			Ranks[i] = FloatKeys[i].mIndex;
+		CheckRanks("MergeSort, floats", Floats, Nb, Status ? Ranks : null);
+
+		MergeSort<MergePair> PairSorter;
+		Status = PairSorter.Sort(Pairs, Nb, Executors[j]);
+		for(udword i=0;i<Nb;i++)
+			Ranks[i] = Pairs[i].mID;
+		CheckRanks("MergeSort, MergePair", Values, Nb, Status ? Ranks : null);
+	}
+	DELETEARRAY(Pairs);
+	DELETEARRAY(FloatKeys);
+	DELETEARRAY(Ints);
+	DELETEARRAY(Ranks);
+	DELETEARRAY(Floats);
+	DELETEARRAY(Values);
+}
+
+// Parallel radix sort: stable with duplicates, skewed buckets (partitioned again in parallel), signed & float keys, on the
+// calling thread and on executors of different sizes
+void TestParallelRadixStability()
+{
+	SerialSortExecutor Serial;
+	SortThreadPool Pool;
+	Pool.Init(2);
+	SortExecutor* Executors[] = { &Serial, &Pool, GetSortExecutor() };
+
+	const udword Sizes[] = { 1000, 300000 };
+	for(udword j=0;j<2;j++)
+	{
+		const udword Nb = Sizes[j];
+		udword* Skewed = new udword[Nb];
+		sdword* Values = new sdword[Nb];
+		float* Floats = new float[Nb];
+		for(udword i=0;i<Nb;i++)
+		{
+			// 90% of the values in one bucket
+			Skewed[i] = gValues[i]%10 ? 7 : gValues[i]%1000;
+			Values[i] = sdword(gValues[i] % 201) - 100;
+			Floats[i] = float(Values[i])*0.125f;
+		}
+
+		for(udword k=0;k<3;k++)
+		{
+			ParallelRadixSort PRS;
+			PRS.SetExecutor(Executors[k]);
+			CheckRanks("ParallelRadixSort, skewed", Skewed, Nb, PRS.Sort(Skewed, Nb, RADIX_UNSIGNED).GetRanks());
+			CheckRanks("ParallelRadixSort, signed", Values, Nb, PRS.Sort((const udword*)Values, Nb, RADIX_SIGNED).GetRanks());
+			CheckRanks("ParallelRadixSort, floats", Floats, Nb, PRS.Sort(Floats, Nb).GetRanks());
+		}
+		DELETEARRAY(Floats);
+		DELETEARRAY(Values);
+		DELETEARRAY(Skewed);
+	}
+}
+
+	// Stands for the job system of an application. It claims 3 threads so that the sorters split their work, but runs
+	// the items of ParallelFor backwards on the calling thread, and keeps submitted jobs until Wait(), newest first.
+	class ReversedExecutor : public SortExecutor
+	{
+		public:
+						ReversedExecutor() : mJobs(null), mNbCalls(0)	{}
+
+		virtual	void	Submit(SortJob* job)
+						{
+							mNbCalls++;
+							job->mNextJob = mJobs;
+							mJobs = job;
+						}
+		virtual	void	ParallelFor(udword nb, SortTaskFunction function, void* user_data)
+						{
+							mNbCalls++;
+							for(udword i=nb;i--;)
+								(function)(i, user_data);
+						}
+		virtual	void	Wait(const std::atomic<udword>& nb_pending)
+						{
+							while(nb_pending && mJobs)
+							{
+								SortJob* Job = mJobs;
+								mJobs = Job->mNextJob;
+								Job->Execute();
+							}
+							if(nb_pending)
+								printf("ERROR! (ReversedExecutor, waiting for jobs never submitted)\n");
+						}
+		virtual	udword	GetNbThreads()	const	{ return 3;	}
+
+				SortJob*	mJobs;
+				udword		mNbCalls;
+	};
+
+// The executor must have been called since the last check
+static void CheckExecutor(const char* name, const ReversedExecutor& executor, udword& nb_calls)
+{
+	if(executor.mNbCalls==nb_calls)
+		printf("ERROR! (%s, executor not used)\n", name);
+	nb_calls = executor.mNbCalls;
+}
+
+// Pluggable executors: the parallel sorters must give the same results on any executor, whatever the order it runs the
+// work in, and actually use it, whether it's passed to them or installed with SetSortExecutor()
+void TestCustomExecutor()
+{
+	typedef IndexedKey<sdword>	IntKey;
+
+	const udword Nb = 300000;
+	sdword* Values = new sdword[Nb];
+	sdword* Sorted = new sdword[Nb];
+	IntKey* Keys = new IntKey[Nb];
+	udword* Ranks = new udword[Nb];
+	for(udword i=0;i<Nb;i++)
+		Values[i] = sdword(gValues[i] % 1001) - 500;
+
+	ReversedExecutor Executor;
+	udword NbCalls = 0;
+
+	{
+		ParallelRadixSort PRS;
+		PRS.SetExecutor(&Executor);
+		CheckRanks("ParallelRadixSort, custom executor", Values, Nb, PRS.Sort((const udword*)Values, Nb).GetRanks());
+		CheckExecutor("ParallelRadixSort", Executor, NbCalls);
+	}
+	{
+		SampleSort SS;
+		SS.SetExecutor(&Executor);
+		CheckRanks("SampleSort, custom executor", Values, Nb, SS.Sort((const udword*)Values, Nb));
+		CheckExecutor("SampleSort", Executor, NbCalls);
+
+		if(!ApplyPermutation(SS.GetRanks(), Nb, Values, Sorted, sizeof(sdword), &Executor))
+			printf("ERROR! (ApplyPermutation, custom executor)\n");
+		for(udword i=0;i<Nb;i++)
+		{
+			if(Sorted[i]!=Values[SS.GetRanks()[i]])
+			{
+				printf("ERROR! (ApplyPermutation, custom executor)\n");
+				break;
+			}
+		}
+		CheckExecutor("ApplyPermutation", Executor, NbCalls);
+	}
+	{
+		for(udword i=0;i<Nb;i++)
+		{
+			Keys[i].mKey = Values[i];
+			Keys[i].mIndex = i;
+		}
+		MergeSort<IntKey, IntroSortLess, IntroSortField<IntKey, sdword, &IntKey::mKey> > MS;
+		const bool Status = MS.Sort(Keys, Nb, &Executor);
+		for(udword i=0;i<Nb;i++)
+			Ranks[i] = Keys[i].mIndex;
+		CheckRanks("MergeSort, custom executor", Values, Nb, Status ? Ranks : null);
+		CheckExecutor("MergeSort", Executor, NbCalls);
+	}
+	{
+		CopyMemory(Sorted, Values, Nb*sizeof(sdword));
+		ParallelIntroSort<sdword> PIS(ADAPTIVE_PARTITION, 4096);
+		PIS.Sort(Sorted, Nb, &Executor);
+		for(udword i=0;i<Nb-1;i++)
+		{
+			if(Sorted[i]>Sorted[i+1])
+			{
+				printf("ERROR! (ParallelIntroSort, custom executor)\n");
+				break;
+			}
+		}
+		CheckExecutor("ParallelIntroSort", Executor, NbCalls);
+	}
+	{
+		// Default executor of all sorters
+		SetSortExecutor(&Executor);
+		ParallelRadixSort PRS;
+		CheckRanks("ParallelRadixSort, SetSortExecutor", Values, Nb, PRS.Sort((const udword*)Values, Nb).GetRanks());
+		SetSortExecutor(null);
+		CheckExecutor("SetSortExecutor", Executor, NbCalls);
+	}
+
+	DELETEARRAY(Ranks);
+	DELETEARRAY(Keys);
+	DELETEARRAY(Sorted);
+	DELETEARRAY(Values);
+}
+
+// Sample sort: stable whatever the previous call sorted, on the calling thread (RadixSort & RadixSort3) and with buckets.
+// NaN policies must give the same ranks as RadixSort on both paths.
+void TestSampleSortStability()
+{
+	const udword Sizes[] = { 5000, 20000, 200000 };
+	const udword NaNs[] = { 0x7fc00000, 0xffc00000, 0x7f800001 };
+	const udword Policies[] = { RADIX_NANS_FIRST, RADIX_NANS_LAST, RADIX_TOTAL_ORDER, RADIX_NANS_LAST|RADIX_POSITIVE };
+	for(udword j=0;j<3;j++)
+	{
+		const udword Nb = Sizes[j];
+		sdword* Values = new sdword[Nb];
+		float* Floats = new float[Nb];
+		for(udword i=0;i<Nb;i++)
+		{
+			Values[i] = sdword(gValues[Nb+i] % 17) - 8;
+			Floats[i] = float(Values[i])*0.5f;
+		}
+
+		SampleSort SS;
+		SS.Sort(gValues, Nb, RADIX_UNSIGNED);
+		CheckRanks("SampleSort, duplicates", Values, Nb, SS.Sort((const udword*)Values, Nb));
+		CheckRanks("SampleSort, floats", Floats, Nb, SS.Sort(Floats, Nb));
+
+		for(udword i=0;i<Nb;i+=7)
+			reinterpret_cast<udword*>(Floats)[i] = NaNs[i%3];
+		for(udword k=0;k<4;k++)
+		{
+			const RadixHints Hints(RADIX_SIGNED, Policies[k]);
+			RadixSort RS;
+			const udword* Expected = RS.Sort(Floats, Nb, Hints).GetRanks();
+			const udword* Ranks = SS.Sort(Floats, Nb, Hints);
+			if(!Ranks || memcmp(Ranks, Expected, Nb*sizeof(udword)))
+				printf("ERROR! (SampleSort, NaN policy %d, %d values)\n", Policies[k], Nb);
+		}
+		DELETEARRAY(Floats);
+		DELETEARRAY(Values);
+	}
+}
+
+// Scratch memory budget: every engine is checked, sorts needing more than the budget fail instead of going over it
+void TestDispatcherScratchMemory()
+{
+	const udword Sizes[] = { 100, 1000, 100000 };	// IntroSort, RadixSort, RadixSort3
+	for(udword j=0;j<3;j++)
+	{
+		const udword Nb = Sizes[j];
+		const float* Floats = reinterpret_cast<const float*>(gValues);
+		SortDispatcher SD;
+		SD.SetMaxScratchMemory(Nb*sizeof(udword));
+		if(SD.Sort(gValues, Nb, RADIX_SIGNED) || SD.GetLastEngine()!=SORT_ENGINE_NONE)
+			printf("ERROR! (SortDispatcher, over budget, %d values)\n", Nb);
+		if(SD.Sort(Floats, Nb, RadixHints(RADIX_SIGNED, RADIX_NANS_LAST)))
+			printf("ERROR! (SortDispatcher, NaN policy over budget, %d values)\n", Nb);
+
+		// Enough for the radix engines, not for IntroSort
+		SD.SetMaxScratchMemory(Nb*sizeof(udword)*2);
+		CheckRanks("SortDispatcher, radix budget", (const sdword*)gValues, Nb, SD.Sort(gValues, Nb, RADIX_SIGNED));
+		if(SD.GetLastEngine()==SORT_ENGINE_INTROSORT)
+			printf("ERROR! (SortDispatcher, IntroSort over budget)\n");
+	}
+}
+
+// Presorted input: small ones go to IntroSort, unless the previous radix engine can reuse its ranks
+void TestDispatcherPresorted()
+{
+	const udword Nb = 200;
+	udword Sorted[Nb];
+	for(udword i=0;i<Nb;i++)
+		Sorted[i] = i*3;
+
+	const RadixHints Presorted(RADIX_UNSIGNED, RADIX_PRESORTED);
+	SortDispatcher SD;
+	CheckRanks("SortDispatcher, presorted", Sorted, Nb, SD.Sort(Sorted, Nb, Presorted));
+	if(SD.GetLastEngine()!=SORT_ENGINE_INTROSORT)
+		printf("ERROR! (SortDispatcher, small presorted input not sent to IntroSort)\n");
+
+	SortThresholds Thresholds;
+	Thresholds.mIntroSortMax = 0;
+	SD.SetThresholds(Thresholds);
+	CheckRanks("SortDispatcher, radix", gValues, Nb, SD.Sort(gValues, Nb, RADIX_UNSIGNED));
+	SD.SetThresholds(SortThresholds());
+	CheckRanks("SortDispatcher, presorted after radix", Sorted, Nb, SD.Sort(Sorted, Nb, Presorted));
+	if(SD.GetLastEngine()!=SORT_ENGINE_RADIX)
+		printf("ERROR! (SortDispatcher, radix ranks not reused for presorted input)\n");
+}
+
+// Saved profiles load back & their digit width drives the dispatcher, invalid ones are rejected & give the default thresholds
+void TestSortProfile()
+{
+	const char* Filename = "SortProfileTest.txt";
+	const SortThresholds Defaults;
+
+	SortProfile Saved;
+	Saved.mThresholds.mIntroSortMax = 128;
+	Saved.mThresholds.mRadix3Min = 4096;
+	Saved.mThresholds.mRadix2Min = 0xffffffff;
+	Saved.mThresholds.mDigitBits = 12;
+	SortProfile Loaded;
+	if(!SaveSortProfile(Filename, Saved) || !LoadSortProfile(Filename, Loaded) || memcmp(&Loaded.mThresholds, &Saved.mThresholds, sizeof(SortThresholds)))
+		printf("ERROR! (SortProfile, valid)\n");
+
+	SortDispatcher SD;
+	SD.SetThresholds(Loaded.mThresholds);
+	CheckRanks("SortDispatcher, 12-bit digits", gValues, NB_TO_SORT, SD.Sort(gValues, NB_TO_SORT, RADIX_UNSIGNED));
+	if(SD.GetLastEngine()!=SORT_ENGINE_RADIX_BITS)
+		printf("ERROR! (SortDispatcher, digit width ignored)\n");
+
+	const char* Invalid[] =
+	{
+		"SortProfile 3\nIntroSortMax 20000\nRadix3Min 10000\n",		// IntroSort after RadixSort3
+		"SortProfile 3\nIntroSortMax 256\nRadix2Min 256\n",			// Same crossover
+		"SortProfile 3\nIntroSortMax 128\nDigitBits 9\n",				// No sorter for that width
+		"SortProfile 2\nIntroSortMax 128\nRadix3Min 4096\n",			// Old version
+	};
+	for(udword i=0;i<sizeof(Invalid)/sizeof(Invalid[0]);i++)
+	{
+		FILE* fp = fopen(Filename, "w");
+		fputs(Invalid[i], fp);
+		fclose(fp);
+
+		SortProfile Profile = Saved;
+		if(LoadSortProfile(Filename, Profile) || memcmp(&Profile.mThresholds, &Defaults, sizeof(SortThresholds)))
+			printf("ERROR! (SortProfile, invalid %d)\n", i);
+	}
+	remove(Filename);
+}
+
+	struct Position
+	{
+		float	x, y, z;
+	};
+
+void TestPermutation()
+{
+	RadixSort RS;
+	const udword* Ranks = RS.Sort(gValues, NB_TO_SORT, RADIX_UNSIGNED).GetRanks();
+
+	udword* SortedValues = new udword[NB_TO_SORT];
+	Position* Positions = new Position[NB_TO_SORT];
+	Position* SortedPositions = new Position[NB_TO_SORT];
+	for(udword i=0;i<NB_TO_SORT;i++)
+	{
+		Positions[i].x = float(i);
+		Positions[i].y = Positions[i].z = 0.0f;
+	}
+
+	START_PROFILE
+		const PermutationStream Streams[] = {
+			PermutationStream(gValues, SortedValues, sizeof(udword)),
+			PermutationStream(Positions, SortedPositions, sizeof(Position))
+		};
+		ApplyPermutation(Ranks, NB_TO_SORT, Streams, 2);
+	END_PROFILE("%d (Permutation)\n")
+
+	for(udword i=0;i<NB_TO_SORT-1;i++)
+		if(SortedValues[i]>SortedValues[i+1] || SortedPositions[i].x!=float(Ranks[i]))
+			printf("ERROR!\n");
+
+	DELETEARRAY(SortedPositions);
+	DELETEARRAY(Positions);
+	DELETEARRAY(SortedValues);
+}
+
+	struct Record
+	{
+		udword	mKey;
+		float	mData[7];
+	};
+
+// Permutation kernels on stable ranks of duplicate-heavy keys: all element sizes, inverse, and composition of two sorts,
+// on one thread or on the pool
+void TestPermutationKernels()
+{
+	const udword Nb = 300000;
+	const udword ElementSizes[] = { 1, 2, 4, 8, 12, 16, 20 };	// 20 has no dedicated kernel
+	const udword NbStreams = sizeof(ElementSizes)/sizeof(ElementSizes[0]);
+
+	sdword* Values = new sdword[Nb];
+	float* Floats = new float[Nb];
+	float* SortedFloats = new float[Nb];
+	udword* Inverse = new udword[Nb];
+	udword* Composed = new udword[Nb];
+	for(udword i=0;i<Nb;i++)
+	{
+		Values[i] = sdword(gValues[i] % 301) - 150;
+		Floats[i] = float(sdword(gValues[Nb+i] % 9) - 4);
+	}
+
+	PermutationStream Streams[NbStreams];
+	for(udword j=0;j<NbStreams;j++)
+	{
+		ubyte* Src = new ubyte[Nb*ElementSizes[j]];
+		for(udword i=0;i<Nb*ElementSizes[j];i++)
+			Src[i] = ubyte(i*7 + j);
+		Streams[j] = PermutationStream(Src, new ubyte[Nb*ElementSizes[j]], ElementSizes[j]);
+	}
+
+	RadixSort RS;
+	const udword* Ranks = RS.Sort((const udword*)Values, Nb).GetRanks();
+	CheckRanks("RadixSort", Values, Nb, Ranks);
+
+	SerialSortExecutor Serial;
+	SortExecutor* Executors[] = { &Serial, GetSortExecutor() };
+	for(udword k=0;k<2;k++)
+	{
+		if(!ApplyPermutation(Ranks, Nb, Streams, NbStreams, Executors[k]))
+			printf("ERROR! (ApplyPermutation)\n");
+		for(udword j=0;j<NbStreams;j++)
+		{
+			const udword Size = Streams[j].mSize;
+			const ubyte* Src = reinterpret_cast<const ubyte*>(Streams[j].mSrc);
+			const ubyte* Dst = reinterpret_cast<const ubyte*>(Streams[j].mDst);
+			for(udword i=0;i<Nb;i++)
+			{
+				if(memcmp(Dst + i*Size, Src + Ranks[i]*Size, Size))
+				{
+					printf("ERROR! (ApplyPermutation, %d bytes)\n", Size);
+					break;
+				}
+			}
+		}
+
+		if(!InvertPermutation(Ranks, Nb, Inverse, Executors[k]))
+			printf("ERROR! (InvertPermutation)\n");
+		for(udword i=0;i<Nb;i++)
+		{
+			if(Inverse[Ranks[i]]!=i)
+			{
+				printf("ERROR! (InvertPermutation)\n");
+				break;
+			}
+		}
+
+		// Sorted by Values, then stable sort by Floats: composed ranks order by Floats, then Values, then index
+		ApplyPermutation(Ranks, Nb, Floats, SortedFloats, sizeof(float), Executors[k]);
+		RadixSort RS2;
+		const udword* Second = RS2.Sort(SortedFloats, Nb).GetRanks();
+		if(!ComposePermutations(Ranks, Second, Nb, Composed, Executors[k]))
+			printf("ERROR! (ComposePermutations)\n");
+		for(udword i=0;i<Nb-1;i++)
+		{
+			const udword a = Composed[i];
+			const udword b = Composed[i+1];
+			const bool Ordered = Floats[a]<Floats[b] || (Floats[a]==Floats[b] && (Values[a]<Values[b] || (Values[a]==Values[b] && a<b)));
+			if(!Ordered)
+			{
+				printf("ERROR! (ComposePermutations)\n");
+				break;
+			}
+		}
+	}
+
+	for(udword j=0;j<NbStreams;j++)
+	{
+		ubyte* Dst = reinterpret_cast<ubyte*>(Streams[j].mDst);
+		ubyte* Src = const_cast<ubyte*>(reinterpret_cast<const ubyte*>(Streams[j].mSrc));
+		DELETEARRAY(Dst);
+		DELETEARRAY(Src);
+	}
+	DELETEARRAY(Composed);
+	DELETEARRAY(Inverse);
+	DELETEARRAY(SortedFloats);
+	DELETEARRAY(Floats);
+	DELETEARRAY(Values);
+}
+
+void TestRecordSort()
+{
+	Record* Records = new Record[NB_TO_SORT];
+	for(udword i=0;i<NB_TO_SORT;i++)
+	{
+		Records[i].mKey = gValues[i];
+		Records[i].mData[0] = float(i);
+	}
+
+	START_PROFILE
+		RecordSort RS;
+		RS.Sort(Records, NB_TO_SORT, sizeof(Record), 0, RADIX_UNSIGNED);
+	END_PROFILE("%d (RecordSort)\n")
+
+	for(udword i=0;i<NB_TO_SORT-1;i++)
+		if(Records[i].mKey>Records[i+1].mKey || gValues[udword(Records[i].mData[0])]!=Records[i].mKey)
+			printf("ERROR!\n");
+
+	DELETEARRAY(Records);
+}
+
+	// Large enough for the automatic mode to pick the indirect sort
+	struct LargeRecord
+	{
+		udword	mKey;
+		float	mData[31];
+	};
+
+// Records must come out in std::stable_sort's order, in all modes, with signed & float keys. Forcing RECORD_SORT_NONE
+// is the same as RECORD_SORT_AUTO.
+void TestRecordSortModes()
+{
+	const RecordSortMode Modes[] = { RECORD_SORT_AUTO, RECORD_SORT_DIRECT, RECORD_SORT_INDIRECT, RECORD_SORT_NONE };
+	const udword Nb = 100000;
+	sdword* Values = new sdword[Nb];
+	float* Floats = new float[Nb];
+	udword* Ranks = new udword[Nb];
+	LargeRecord* Records = new LargeRecord[Nb];
+	for(udword i=0;i<Nb;i++)
+	{
+		Values[i] = sdword(gValues[i] % 1001) - 500;
+		Floats[i] = float(Values[i])*0.25f;
+	}
+
+	for(udword j=0;j<4;j++)
+	{
+		for(udword k=0;k<2;k++)
+		{
+			for(udword i=0;i<Nb;i++)
+			{
+				Records[i].mKey = k ? reinterpret_cast<const udword*>(Floats)[i] : udword(Values[i]);
+				Records[i].mData[0] = float(i);
+			}
+
+			RecordSort RS;
+			RS.SetMode(Modes[j]);
+			const bool Status = k ? RS.SortFloats(Records, Nb, sizeof(LargeRecord), 0) : RS.Sort(Records, Nb, sizeof(LargeRecord), 0, RADIX_SIGNED);
+			for(udword i=0;i<Nb;i++)
+				Ranks[i] = udword(Records[i].mData[0]);
+
+			if(k)	CheckRanks("RecordSort, floats", Floats, Nb, Status ? Ranks : null);
+			else	CheckRanks("RecordSort", Values, Nb, Status ? Ranks : null);
+
+			const RecordSortMode Expected = Modes[j]==RECORD_SORT_AUTO || Modes[j]==RECORD_SORT_NONE ? RecordSort::SelectMode(sizeof(LargeRecord), RS.GetNbPasses()) : Modes[j];
+			if(RS.GetLastMode()!=Expected)
+				printf("ERROR! (RecordSort, mode %d)\n", Modes[j]);
+		}
+	}
+	DELETEARRAY(Records);
+	DELETEARRAY(Ranks);
+	DELETEARRAY(Floats);
+	DELETEARRAY(Values);
+}
+
+	// Byte order, like StringRadixSort: a prefix comes first
+	struct RadixStringLess
+	{
+		inline_	bool	operator()(const RadixString& a, const RadixString& b)	const
+						{
+							const int Cmp = memcmp(a.mString, b.mString, a.mLength<b.mLength ? a.mLength : b.mLength);
+							return Cmp<0 || (Cmp==0 && a.mLength<b.mLength);
+						}
+	};
+
+// String sort: ranks of std::stable_sort for many duplicates, long shared prefixes, empty strings, zeros & bytes above
+// 127, with both input formats. The small array only goes through the insertion sort.
+void TestStringSortStability()
+{
+	const char* Prefixes[] = { "", "/usr/share/icons/hicolor/", "\0\xff", "a" };
+	const udword PrefixLengths[] = { 0, 25, 2, 1 };
+	const char Alphabet[] = { '\0', 'a', 'b', '\xff' };
+	const udword SlotSize = 32;
+
+	const udword Sizes[] = { 20, 100000 };
+	for(udword j=0;j<2;j++)
+	{
+		const udword Nb = Sizes[j];
+		char* Buffer = new char[Nb*SlotSize];
+		RadixString* Strings = new RadixString[Nb];
+		const char** Pointers = new const char*[Nb];
+		udword* Lengths = new udword[Nb];
+		for(udword i=0;i<Nb;i++)
+		{
+			const udword Random = gValues[i];
+			const udword Prefix = Random & 3;
+			const udword SuffixLength = (Random>>2) % 6;
+			char* String = Buffer + i*SlotSize;
+			CopyMemory(String, Prefixes[Prefix], PrefixLengths[Prefix]);
+			for(udword k=0;k<SuffixLength;k++)
+				String[PrefixLengths[Prefix]+k] = Alphabet[(Random>>(8+k*2)) & 3];
+
+			Strings[i].mString = String;
+			Strings[i].mLength = PrefixLengths[Prefix] + SuffixLength;
+			Pointers[i] = String;
+			Lengths[i] = Strings[i].mLength;
+		}
+
+		StringRadixSort SRS;
+		CheckRanks("StringRadixSort", Strings, Nb, SRS.Sort(Strings, Nb).GetRanks(), RadixStringLess());
+		CheckRanks("StringRadixSort, pointers", Strings, Nb, SRS.Sort(Pointers, Lengths, Nb).GetRanks(), RadixStringLess());
+
+		DELETEARRAY(Lengths);
+		DELETEARRAY(Pointers);
+		DELETEARRAY(Strings);
+		DELETEARRAY(Buffer);
+	}
+}
+
+void TestStringSort()
+{
+	// Fixed-size slots, strings of varying lengths
+	char* Buffer = new char[NB_TO_SORT*16];
+	RadixString* Strings = new RadixString[NB_TO_SORT];
+	for(udword i=0;i<NB_TO_SORT;i++)
+	{
+		Strings[i].mString = Buffer + i*16;
+		Strings[i].mLength = sprintf(Buffer + i*16, "item_%u", gValues[i]>>(gValues[i]&15));
+	}
+
+	START_PROFILE
+		StringRadixSort SRS;
+		const udword* Sorted = SRS.Sort(Strings, NB_TO_SORT).GetRanks();
+	END_PROFILE("%d (StringRadix)\n")
+
+	for(udword i=0;i<NB_TO_SORT-1;i++)
+		if(strcmp(Strings[Sorted[i]].mString, Strings[Sorted[i+1]].mString)>0)
+			printf("ERROR!\n");
+
+	DELETEARRAY(Strings);
+	DELETEARRAY(Buffer);
+}
+
 	struct Key
 	{
 		udword	mValue;
@@ -97,7 +852,6 @@ void TestRadix()
 		inline_	bool	operator>(const Key& p)		const	{ return mValue > p.mValue;		}
 	};
 
-#include <algorithm>
 void TestStdSort()
 {
 	Key* Values = new Key[NB_TO_SORT];
@@ -139,3 +893,455 @@ void TestIntroSort()
 
 	DELETEARRAY(Values);
 }
+
+// Many duplicates: all equal, then 16 distinct values. All partition modes must stay fast.
+void TestIntroSortDuplicates()
+{
+	const char* ModeNames[] = { "Ternary", "Block", "Adaptive" };
+	const IntroSortPartition Modes[] = { TERNARY_PARTITION, BLOCK_PARTITION, ADAPTIVE_PARTITION };
+
+	udword* Values = new udword[NB_TO_SORT];
+	for(udword NbDistinct=1;NbDistinct<=16;NbDistinct+=15)
+	{
+		for(udword j=0;j<3;j++)
+		{
+			for(udword i=0;i<NB_TO_SORT;i++)
+				Values[i] = gValues[i] % NbDistinct;
+
+			START_PROFILE
+				IntroSort<udword> introSorter(Modes[j]);
+				introSorter.Sort(Values, NB_TO_SORT);
+			END_PROFILE("%d (IntroSort, ")
+			printf("%s, %d distinct)\n", ModeNames[j], NbDistinct);
+
+			for(udword i=0;i<NB_TO_SORT-1;i++)
+			{
+				if(Values[i]>Values[i+1])
+				{
+					printf("ERROR!\n");
+					break;
+				}
+			}
+		}
+	}
+	DELETEARRAY(Values);
+}
+
+// Signed values with a number of bits: the sign bit is in the last pass
+void TestSignedHints()
+{
+	const sdword Small[] = { 5, -3, 100, -200, 0, 7, -1 };
+	const udword NbSmall = sizeof(Small)/sizeof(Small[0]);
+	{
+		RadixSort RS;
+		CheckRanks("RadixSort, 16 bits", Small, NbSmall, RS.Sort((const udword*)Small, NbSmall, RadixHints(RADIX_SIGNED, 0, 16)).GetRanks());
+	}
+
+	const udword Nb = 100000;
+	sdword* Values = new sdword[Nb];
+	for(udword i=0;i<Nb;i++)
+		Values[i] = sdword(gValues[i] % 4001) - 2000;
+
+	for(udword NbBits=12;NbBits<=24;NbBits+=4)
+	{
+		const RadixHints Hints(RADIX_SIGNED, 0, NbBits);
+		RadixSort RS;
+		CheckRanks("RadixSort", Values, Nb, RS.Sort((const udword*)Values, Nb, Hints).GetRanks());
+		RadixSort3 RS3;
+		CheckRanks("RadixSort3", Values, Nb, RS3.Sort((const udword*)Values, Nb, Hints).GetRanks());
+		RadixSort11Bits RS11;
+		CheckRanks("RadixSort11Bits", Values, Nb, RS11.Sort((const udword*)Values, Nb, Hints).GetRanks());
+		IncrementalRadixSort IRS;
+		IRS.Start((const udword*)Values, Nb, Hints);
+		IRS.Finish();
+		CheckRanks("IncrementalRadixSort", Values, Nb, IRS.GetRanks());
+		ParallelRadixSort PRS;
+		CheckRanks("ParallelRadixSort", Values, Nb, PRS.Sort((const udword*)Values, Nb, Hints).GetRanks());
+		SampleSort SS;
+		CheckRanks("SampleSort", Values, Nb, SS.Sort((const udword*)Values, Nb, Hints));
+	}
+
+	// Same for 16-bit keys
+	sword* Words = new sword[Nb];
+	for(udword i=0;i<Nb;i++)
+		Words[i] = sword(sdword(gValues[i] % 255) - 127);
+	for(udword NbBits=8;NbBits<=16;NbBits+=8)
+	{
+		RadixSort RS;
+		CheckRanks("RadixSort, sword", Words, Nb, RS.Sort(Words, Nb, RadixHints(RADIX_SIGNED, 0, NbBits)).GetRanks());
+	}
+	{
+		RadixSort RS;
+		CheckRanks("RadixSort, sword", Words, Nb, RS.Sort(Words, Nb).GetRanks());
+	}
+	DELETEARRAY(Words);
+
+	// Floats with many equal negative values must keep their order. All negative values share the same last byte.
+	float* Floats = new float[Nb];
+	for(udword i=0;i<Nb;i++)
+		Floats[i] = float(sdword(gValues[i] % 200) - 100) + 0.5f;
+	for(udword j=0;j<2;j++)
+	{
+		IncrementalRadixSort IRS;
+		IRS.Start(Floats, Nb);
+		IRS.Finish();
+		CheckRanks("IncrementalRadixSort, float", Floats, Nb, IRS.GetRanks());
+
+		for(udword i=0;i<Nb;i++)
+			Floats[i] = -1.0f - float(gValues[i] % 100);
+	}
+	DELETEARRAY(Floats);
+	DELETEARRAY(Values);
+}
+
+	// IEEE totalOrder for non-NaN floats & NaNs alike: -0 goes before +0. Bits are compared as sign-magnitude integers.
+	struct TotalOrderLess
+	{
+		static	inline_	sdword	GetKey(float f)						{ const sdword i = sdword(IR(f));	return i ^ ((i>>31) & 0x7fffffff);	}
+				inline_	bool	operator()(float a, float b)	const	{ return GetKey(a)<GetKey(b);		}
+	};
+
+static float HalfToFloat(uword h)
+{
+	const udword Exponent = (h>>10) & 31;
+	const udword Mantissa = h & 1023;
+	// Denormals have no implicit leading one and the exponent of the smallest normal value
+	const float Magnitude = Exponent ? ldexpf(float(1024 + Mantissa), sdword(Exponent) - 25) : ldexpf(float(Mantissa), -24);
+	return (h & 0x8000) ? -Magnitude : Magnitude;
+}
+
+// Half floats: negative values, both zeros, denormals & duplicates, in the order of the same values as floats
+void TestHalfFloats()
+{
+	const udword Nb = 100000;
+	uword* Halves = new uword[Nb];
+	float* Floats = new float[Nb];
+	const uword Special[] = { 0x0000, 0x8000, 0x0001, 0x8001, 0x03ff, 0x83ff, 0x0400, 0x8400, 0x7bff, 0xfbff };
+	const udword NbSpecial = sizeof(Special)/sizeof(Special[0]);
+	for(udword i=0;i<Nb;i++)
+	{
+		// Finite values only, NaNs & infinities are the 0x7c00 exponent. Few distinct values so that there are duplicates.
+		const udword Random = gValues[i];
+		Halves[i] = (i%5) ? uword(((Random>>16)&0x8000) | ((Random%500)*61 % 0x7c00)) : Special[(i/5)%NbSpecial];
+		Floats[i] = HalfToFloat(Halves[i]);
+	}
+
+	RadixSort RS;
+	CheckRanks("RadixSort, half floats", Floats, Nb, RS.SortHalfFloats(Halves, Nb).GetRanks(), TotalOrderLess());
+	CheckRanks("RadixSort, half floats, coherence", Floats, Nb, RS.SortHalfFloats(Halves, Nb).GetRanks(), TotalOrderLess());
+
+	// Positive values sort as unsigned integers. Ties would keep the order of the previous ranks, so we start from scratch.
+	for(udword i=0;i<Nb;i++)
+	{
+		Halves[i] &= 0x7fff;
+		Floats[i] = HalfToFloat(Halves[i]);
+	}
+	RS.ResetRanks();
+	CheckRanks("RadixSort, positive half floats", Floats, Nb, RS.SortHalfFloats(Halves, Nb, RadixHints(RADIX_SIGNED, RADIX_POSITIVE)).GetRanks(), TotalOrderLess());
+
+	DELETEARRAY(Floats);
+	DELETEARRAY(Halves);
+}
+
+	// Order of RADIX_NANS_FIRST & RADIX_NANS_LAST: NaNs compare equal to each other, so they keep the input order
+	struct NaNPolicyLess
+	{
+		bool	mNaNsFirst;
+		static	inline_	bool	IsNaN(float f)						{ return (IR(f) & 0x7fffffff) > 0x7f800000;	}
+				inline_	bool	operator()(float a, float b)	const
+								{
+									const bool NaNA = IsNaN(a);
+									const bool NaNB = IsNaN(b);
+									if(NaNA || NaNB)
+										return mNaNsFirst ? NaNA && !NaNB : NaNB && !NaNA;
+									return TotalOrderLess()(a, b);
+								}
+	};
+
+// NaN policies: NaNs go first or last, or in totalOrder, and are counted
+void TestNaNPolicies()
+{
+	const udword Nb = 100000;
+	float* Floats = new float[Nb];
+	udword* Bits = reinterpret_cast<udword*>(Floats);
+	const udword Special[] = { 0x7fc00000, 0xffc00000, 0x7f800001, 0xff800123, 0x7fffffff, 0x7f800000, 0xff800000, 0x80000000 };
+	udword NbNaNs = 0;
+	for(udword i=0;i<Nb;i++)
+	{
+		if(i%9)
+			Floats[i] = float(sdword(gValues[i] % 201) - 100)*0.25f;
+		else
+			Bits[i] = Special[(i/9)%8];
+		if(NaNPolicyLess::IsNaN(Floats[i]))
+			NbNaNs++;
+	}
+
+	const udword Policies[] = { RADIX_NANS_FIRST, RADIX_NANS_LAST, RADIX_TOTAL_ORDER };
+	for(udword j=0;j<3;j++)
+	{
+		const udword Policy = Policies[j];
+		RadixSort RS;
+		const udword* Ranks = RS.Sort(Floats, Nb, RadixHints(RADIX_SIGNED, Policy)).GetRanks();
+		if(RS.GetNbNaNs()!=NbNaNs)
+			printf("ERROR! (RadixSort, %d NaNs counted instead of %d)\n", RS.GetNbNaNs(), NbNaNs);
+
+		if(Policy==RADIX_TOTAL_ORDER)
+		{
+			CheckRanks("RadixSort, RADIX_TOTAL_ORDER", Floats, Nb, Ranks, TotalOrderLess());
+			continue;
+		}
+
+		const NaNPolicyLess Less = { Policy==RADIX_NANS_FIRST };
+		const udword FirstNaN = Less.mNaNsFirst ? 0 : Nb - NbNaNs;
+		for(udword i=FirstNaN;i<FirstNaN+NbNaNs;i++)
+		{
+			if(!NaNPolicyLess::IsNaN(Floats[Ranks[i]]))
+			{
+				printf("ERROR! (RadixSort, NaNs not %s)\n", Less.mNaNsFirst ? "first" : "last");
+				break;
+			}
+		}
+		CheckRanks(Less.mNaNsFirst ? "RadixSort, RADIX_NANS_FIRST" : "RadixSort, RADIX_NANS_LAST", Floats, Nb, Ranks, Less);
+	}
+
+	// NaNs are only counted with a policy
+	RadixSort RS;
+	RS.Sort(Floats, Nb);
+	if(RS.GetNbNaNs())
+		printf("ERROR! (RadixSort, NaNs counted without a policy)\n");
+
+	DELETEARRAY(Floats);
+}
+
+// Lazy sort: buckets of the same size must not inherit each other's ranks
+void TestLazySort()
+{
+	const udword Nb = 600;
+	udword Values[Nb];
+	for(udword i=0;i<Nb;i++)
+		Values[i] = ((i&1)<<(32-LAZY_RADIX_NB_BITS)) | (gValues[i]%3);
+
+	LazyRadixSort LRS;
+	LRS.Init(Values, Nb, RADIX_UNSIGNED);
+	CheckRanks("LazyRadixSort", Values, Nb, LRS.GetRanks(Nb));
+}
+
+// Streaming sort: uneven chunks, in memory then with a memory bound that spills sorted runs. Ranks come out of the merge
+// in pushed order for equal keys, so they must be the same as a regular stable sort.
+void TestStreamingSort()
+{
+	const udword Nb = 100000;
+	const udword* Values = gValues;
+	udword* Ranks = new udword[Nb];
+
+	for(udword j=0;j<2;j++)
+	{
+		const udword MaxNbInMemory = j ? 7000 : 0;
+
+		StreamingRadixSort SRS;
+		SRS.Init(false, RADIX_UNSIGNED, MaxNbInMemory);
+		udword Offset = 0;
+		udword ChunkSize = 1;
+		while(Offset<Nb)
+		{
+			const udword Count = MIN(ChunkSize, Nb - Offset);
+			SRS.Push(Values + Offset, Count);
+			Offset += Count;
+			ChunkSize = ChunkSize*3 + 7;
+			if(ChunkSize>20000)	ChunkSize = 13;
+		}
+		if(!SRS.Finish() || (MaxNbInMemory && !SRS.GetNbRuns()))
+			printf("ERROR! (StreamingRadixSort, finish)\n");
+
+		udword NbPulled = 0;
+		while(udword NbNew = SRS.Pull(Ranks + NbPulled, MIN(udword(1000), Nb - NbPulled)))
+			NbPulled += NbNew;
+		if(NbPulled!=Nb || SRS.HasFailed())
+			printf("ERROR! (StreamingRadixSort, pull)\n");
+		CheckRanks(MaxNbInMemory ? "StreamingRadixSort, spilled" : "StreamingRadixSort", Values, Nb, Ranks);
+	}
+	DELETEARRAY(Ranks);
+}
+
+	// Payload permuted by a SortFuture continuation
+	struct AsyncPayload
+	{
+		const udword*	mSource;
+		udword*			mDest;
+	};
+
+static void PermutePayload(const udword* ranks, udword nb, void* user_data)
+{
+	const AsyncPayload* Payload = reinterpret_cast<const AsyncPayload*>(user_data);
+	for(udword i=0;ranks && i<nb;i++)
+		Payload->mDest[i] = Payload->mSource[ranks[i]];
+}
+
+// Chains a continuation to a running sort, then another one once it's done (queued again on its own)
+template<class SorterT>
+static void CheckSortAsync(const char* name, SorterT& sorter, const udword* values, udword nb, const udword* payload, udword* dest0, udword* dest1)
+{
+	ZeroMemory(dest0, nb*sizeof(udword));
+	ZeroMemory(dest1, nb*sizeof(udword));
+	AsyncPayload Running = { payload, dest0 };
+	AsyncPayload Done = { payload, dest1 };
+
+	SortFuture& Future = sorter.SortAsync(values, nb, RADIX_UNSIGNED);
+	if(!Future.Then(PermutePayload, &Running))
+		printf("ERROR! (%s, Then)\n", name);
+	Future.Wait();
+
+	if(!Future.IsDone() || !Future.Then(PermutePayload, &Done))
+		printf("ERROR! (%s, Then when done)\n", name);
+	Future.Wait();
+
+	const udword* Ranks = Future.GetRanks();
+	CheckRanks(name, values, nb, Ranks);
+	for(udword i=0;i<nb;i++)
+	{
+		if(!Ranks || dest0[i]!=payload[Ranks[i]] || dest1[i]!=payload[Ranks[i]])
+		{
+			printf("ERROR! (%s, payload)\n", name);
+			break;
+		}
+	}
+}
+
+// Asynchronous sorts: ranks & payloads permuted by continuations
+void TestSortAsync()
+{
+	const udword Nb = 100000;
+	const udword* Values = gValues;
+	udword* Payload = new udword[Nb];
+	udword* Dest0 = new udword[Nb];
+	udword* Dest1 = new udword[Nb];
+	for(udword i=0;i<Nb;i++)
+		Payload[i] = i*7 + 1;
+
+	RadixSort RS;
+	CheckSortAsync("RadixSort, async", RS, Values, Nb, Payload, Dest0, Dest1);
+	RadixSort3 RS3;
+	CheckSortAsync("RadixSort3, async", RS3, Values, Nb, Payload, Dest0, Dest1);
+	RadixSort2 RS2;
+	CheckSortAsync("RadixSort2, async", RS2, Values, Nb, Payload, Dest0, Dest1);
+
+	DELETEARRAY(Dest1);
+	DELETEARRAY(Dest0);
+	DELETEARRAY(Payload);
+}
+
+	// Fails one allocation, to test the error paths
+	class FailingAllocator : public Allocator
+	{
+		public:
+						FailingAllocator(Allocator& allocator, udword fail_index) : mAllocator(allocator), mFailIndex(fail_index), mNbAllocs(0)	{}
+
+		virtual void*	malloc(size_t size, MemoryType type)
+						{
+							return Fail() ? null : mAllocator.malloc(size, type);
+						}
+		virtual void*	mallocDebug(size_t size, const char* filename, udword line, const char* class_name, MemoryType type)
+						{
+							return Fail() ? null : mAllocator.mallocDebug(size, filename, line, class_name, type);
+						}
+		virtual void*	realloc(void* memory, size_t size)	{ return Fail() ? null : mAllocator.realloc(memory, size);	}
+		virtual void*	shrink(void* memory, size_t size)	{ return mAllocator.shrink(memory, size);					}
+		virtual void	free(void* memory)					{ mAllocator.free(memory);									}
+
+		// Allocations are counted from all threads
+		inline_	bool	Fail()								{ return mNbAllocs++==mFailIndex;							}
+		inline_	bool	HasFailed()					const	{ return mNbAllocs>mFailIndex;								}
+
+				Allocator&				mAllocator;
+				const udword			mFailIndex;
+				std::atomic<udword>		mNbAllocs;
+	};
+
+// NUMA sort out of memory: each allocation fails in turn, the sort must fail cleanly & work again afterwards
+void TestNumaOutOfMemory()
+{
+	NumaTopology Topology;
+	Topology.Simulate(2, 2);
+
+	const udword Nb = NUMA_RADIX_MIN_NB*2;
+	const udword* Values = gValues;
+
+	Allocator& Default = *GetAllocator();
+	for(udword FailIndex=0;;FailIndex++)
+	{
+		NumaRadixSort NRS;
+		NRS.Init(Topology);
+
+		FailingAllocator Failing(Default, FailIndex);
+		SetAllocator(Failing);
+		const bool Status = NRS.Sort(Values, Nb, RADIX_UNSIGNED);
+		SetAllocator(Default);
+
+		if(Status)
+			CheckRanks("NumaRadixSort", Values, Nb, NRS.GetRanks());
+		else if(NRS.GetRanks())
+			printf("ERROR! (NumaRadixSort, ranks after a failure)\n");
+
+		// Same sorter, with memory
+		if(!NRS.Sort(Values, Nb, RADIX_UNSIGNED))
+			printf("ERROR! (NumaRadixSort, failed after a failure)\n");
+		CheckRanks("NumaRadixSort", Values, Nb, NRS.GetRanks());
+
+		// Done when all allocations went through
+		if(!Failing.HasFailed())
+			break;
+	}
+}
+
+// Define on x64 builds to sort more than 2^32 values. Needs about 90 GB.
+//#define TEST_RADIX_4G
+
+// 64-bit ranks: same ranks as RadixSort, then more values than 32-bit ranks can index
+void TestLargeRadix()
+{
+	RadixSort RS;
+	const udword* Expected = RS.Sort(gValues, NB_TO_SORT, RADIX_SIGNED).GetRanks();
+
+	START_PROFILE
+		RadixSort64 RS64;
+		const uqword* Ranks = RS64.Sort(gValues, NB_TO_SORT, RADIX_SIGNED).GetRanks();
+	END_PROFILE("%d (RadixSort64)\n")
+
+	for(udword i=0;i<NB_TO_SORT;i++)
+	{
+		if(!Ranks || Ranks[i]!=Expected[i])
+		{
+			printf("ERROR! (RadixSort64)\n");
+			break;
+		}
+	}
+
+#if defined(TEST_RADIX_4G) && defined(_WIN64)
+	// Few distinct values, so ties cross the 2^32 boundary
+	const uqword Nb = (uqword(1)<<32) + NB_TO_SORT;
+	udword* Values = new udword[Nb];
+	for(uqword i=0;i<Nb;i++)
+		Values[i] = gValues[i % NB_TO_SORT] >> 20;
+
+	{
+		START_PROFILE
+			RadixSort64 Large;
+			const uqword* LargeRanks = Large.Sort(Values, Nb, RADIX_UNSIGNED).GetRanks();
+		END_PROFILE("%d (RadixSort64, 2^32+ values)\n")
+
+		if(!LargeRanks)
+			printf("ERROR! (RadixSort64, out of memory)\n");
+		for(uqword i=0;LargeRanks && i<Nb-1;i++)
+		{
+			const udword Value0 = Values[LargeRanks[i]];
+			const udword Value1 = Values[LargeRanks[i+1]];
+			if(Value0>Value1 || (Value0==Value1 && LargeRanks[i]>LargeRanks[i+1]))
+			{
+				printf("ERROR! (RadixSort64, 2^32+ values)\n");
+				break;
+			}
+		}
+	}
+	DELETEARRAY(Values);
+#endif
+}
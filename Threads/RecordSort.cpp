@@ -0,0 +1,214 @@
+#include "stdafx.h"
+#include "RecordSort.h"
+
+// Record sort.
+// Keys are read once up-front: this builds the 8-bit histograms of all passes, checks whether the records are already
+// sorted, and keeps the sortable keys for the indirect mode. Passes where all keys have the same digit are skipped, and
+// the remaining number of passes drives the choice of mode:
+// - direct: each pass reads & writes the records once (2*size bytes), plus a final copy when the number of passes is odd,
+// - indirect: each pass reads & writes a combo (2*8 bytes), then the gather reads the records in random order (with
+//   RECORD_SORT_GATHER_COST per byte), writes them sequentially, and they're copied back (3*size bytes).
+// Small records with few passes go direct, large records with many passes go indirect.
+
+namespace
+{
+	inline_ udword ReadKey(const ubyte* record, udword key_offset)
+	{
+		return *reinterpret_cast<const udword*>(record + key_offset);
+	}
+
+	// One LSD pass moving whole records. Counters of the pass are turned into offsets on the way. Size is 0 for
+	// sizes without their own loop, with a constant size the copies are inlined.
+	template<class Traits, udword Size>
+	void ScatterRecords(const ubyte* src, ubyte* dst, udword nb, udword record_size, udword key_offset, udword shift, udword* counters)
+	{
+		udword Offset = 0;
+		for(udword i=0;i<256;i++)
+		{
+			const udword Count = counters[i];
+			counters[i] = Offset;
+			Offset += Count;
+		}
+
+		const udword RecordSize = Size ? Size : record_size;
+		for(udword i=0;i<nb;i++)
+		{
+			const udword Digit = (Traits::ToSortable(ReadKey(src, key_offset))>>shift) & 0xff;
+			CopyMemory(dst + size_t(counters[Digit]++)*RecordSize, src, RecordSize);
+			src += RecordSize;
+		}
+	}
+
+	typedef void (*ScatterFunction)(const ubyte* src, ubyte* dst, udword nb, udword record_size, udword key_offset, udword shift, udword* counters);
+
+	template<class Traits>
+	ScatterFunction GetScatterFunction(udword record_size)
+	{
+		switch(record_size)
+		{
+			case 16:	return ScatterRecords<Traits, 16>;
+			case 32:	return ScatterRecords<Traits, 32>;
+			case 64:	return ScatterRecords<Traits, 64>;
+			case 128:	return ScatterRecords<Traits, 128>;
+		}
+		return ScatterRecords<Traits, 0>;
+	}
+}
+
+RecordSort::RecordSort() :
+	mKeys		(null),
+	mKeysSize	(0),
+	mBuffer		(null),
+	mBufferSize	(0),
+	mExecutor	(null),
+	mMode		(RECORD_SORT_AUTO),
+	mLastMode	(RECORD_SORT_NONE),
+	mNbPasses	(0)
+{
+}
+
+RecordSort::~RecordSort()
+{
+	ICE_FREE(mBuffer);
+	ICE_FREE(mKeys);
+}
+
+bool RecordSort::ResizeKeys(udword nb)
+{
+	if(nb<=mKeysSize)
+		return true;
+
+	ICE_FREE(mKeys);
+	mKeysSize = 0;
+	mKeys = reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*nb));
+	if(!mKeys)
+		return false;
+	mKeysSize = nb;
+	return true;
+}
+
+bool RecordSort::ResizeBuffer(uqword size)
+{
+	if(size<=mBufferSize)
+		return true;
+
+	ICE_FREE(mBuffer);
+	mBufferSize = 0;
+	if(size!=size_t(size))
+		return false;
+	mBuffer = reinterpret_cast<ubyte*>(ICE_ALLOC(size_t(size)));
+	if(!mBuffer)
+		return false;
+	mBufferSize = size;
+	return true;
+}
+
+RecordSortMode RecordSort::SelectMode(udword record_size, udword nb_passes)
+{
+	if(!nb_passes)
+		return RECORD_SORT_NONE;
+
+	// Bytes moved per record, see above
+	const udword DirectCost = 2*record_size*nb_passes + ((nb_passes & 1) ? 2*record_size : 0);
+	const udword IndirectCost = 2*udword(sizeof(Combo))*nb_passes + udword(sizeof(udword)) + (RECORD_SORT_GATHER_COST + 3)*record_size;
+	return DirectCost<=IndirectCost ? RECORD_SORT_DIRECT : RECORD_SORT_INDIRECT;
+}
+
+template<class Traits>
+bool RecordSort::SortRecords(ubyte* records, udword nb, udword record_size, udword key_offset)
+{
+	mLastMode = RECORD_SORT_NONE;
+	mNbPasses = 0;
+
+	// Checkings
+	if(!nb)													return true;
+	if(!records || key_offset+sizeof(udword)>record_size)	return false;
+	if(!ResizeKeys(nb))										return false;
+
+	// Read the keys, create the histograms & check whether the records are sorted already
+	udword Histograms[256*4];
+	ZeroMemory(Histograms, sizeof(Histograms));
+	bool AlreadySorted = true;
+	udword PrevKey = 0;
+	const ubyte* Record = records;
+	for(udword i=0;i<nb;i++)
+	{
+		const udword Key = Traits::ToSortable(ReadKey(Record, key_offset));
+		Record += record_size;
+		if(Key<PrevKey)
+			AlreadySorted = false;
+		PrevKey = Key;
+		mKeys[i] = Key;
+		Histograms[Key & 0xff]++;
+		Histograms[256 + ((Key>>8) & 0xff)]++;
+		Histograms[512 + ((Key>>16) & 0xff)]++;
+		Histograms[768 + (Key>>24)]++;
+	}
+	if(AlreadySorted)
+		return true;
+
+	bool PassValidity[4];
+	for(udword j=0;j<4;j++)
+	{
+		PassValidity[j] = Histograms[j*256 + ((mKeys[0]>>(j*8)) & 0xff)]!=nb;
+		if(PassValidity[j])
+			mNbPasses++;
+	}
+
+	const RecordSortMode Mode = mMode==RECORD_SORT_AUTO ? SelectMode(record_size, mNbPasses) : mMode;
+	const uqword TotalSize = uqword(nb)*record_size;
+	if(!ResizeBuffer(TotalSize))
+		return false;
+
+	if(Mode==RECORD_SORT_INDIRECT)
+	{
+		const udword* Ranks = mRadix2.Sort(mKeys, nb, RADIX_UNSIGNED);
+		if(!Ranks || !ApplyPermutation(Ranks, nb, records, mBuffer, record_size, mExecutor))
+			return false;
+		CopyMemory(records, mBuffer, size_t(TotalSize));
+	}
+	else
+	{
+		const ScatterFunction Scatter = GetScatterFunction<Traits>(record_size);
+		ubyte* Src = records;
+		ubyte* Dst = mBuffer;
+		for(udword j=0;j<4;j++)
+		{
+			if(!PassValidity[j])
+				continue;
+
+			(Scatter)(Src, Dst, nb, record_size, key_offset, j*8, &Histograms[j*256]);
+
+			ubyte* Tmp = Src;
+			Src = Dst;
+			Dst = Tmp;
+		}
+		// Odd number of passes
+		if(Src!=records)
+			CopyMemory(records, Src, size_t(TotalSize));
+	}
+	mLastMode = Mode==RECORD_SORT_INDIRECT ? RECORD_SORT_INDIRECT : RECORD_SORT_DIRECT;
+	return true;
+}
+
+bool RecordSort::Sort(void* records, udword nb, udword record_size, udword key_offset, const RadixHints& hints)
+{
+	ubyte* Records = reinterpret_cast<ubyte*>(records);
+	if(hints.IsUnsigned())
+		return SortRecords<RadixKeyU32>(Records, nb, record_size, key_offset);
+	return SortRecords<RadixKeyS32>(Records, nb, record_size, key_offset);
+}
+
+bool RecordSort::SortFloats(void* records, udword nb, udword record_size, udword key_offset)
+{
+	return SortRecords<RadixKeyF32>(reinterpret_cast<ubyte*>(records), nb, record_size, key_offset);
+}
+
+udword RecordSort::GetUsedRam() const
+{
+	udword UsedRam = sizeof(RecordSort);
+	UsedRam += mRadix2.mCurrentSize*sizeof(Combo)*2;
+	UsedRam += mKeysSize*sizeof(udword);
+	UsedRam += udword(mBufferSize);
+	return UsedRam;
+}
@@ -0,0 +1,70 @@
+#ifndef RECORD_SORT_H
+#define RECORD_SORT_H
+
+#include "RadixSort2.h"
+
+	// Physical sort of fixed-size records (e.g. 16 to 128 bytes) on a 32-bit key stored in each record.
+	// - direct mode: LSD passes on 8-bit digits move the whole records, like RadixSort2 moves (rank, value) combos.
+	//   Each pass reads its keys sequentially from the records moved by the previous pass,
+	// - indirect mode: keys are sorted with RadixSort2, then the records are gathered with the ranks & copied back.
+	// Direct passes move nb*record_size bytes each, the indirect sort moves 8-byte combos instead but pays for a random
+	// gather of the records. The mode is picked from the record size & the number of passes actually needed.
+	// The sort is stable. Already sorted records are detected while reading the keys, and left untouched.
+
+	#define RECORD_SORT_GATHER_COST		3	// Cost of a randomly gathered byte, relative to a streamed one
+
+	enum RecordSortMode
+	{
+		RECORD_SORT_AUTO,			//!< Picks one of the modes below from the record size & the number of passes
+		RECORD_SORT_DIRECT,			//!< Moves the records during the passes
+		RECORD_SORT_INDIRECT,		//!< Sorts (key, rank) combos, then gathers the records
+		RECORD_SORT_NONE,			//!< Nothing to move, records were already sorted
+	};
+
+	class RecordSort
+	{
+		public:
+								RecordSort();
+								~RecordSort();
+
+				// Sorts records in place on an integer key at byte offset 'key_offset', with RADIX_SIGNED or RADIX_UNSIGNED hints
+				bool			Sort(void* records, udword nb, udword record_size, udword key_offset, const RadixHints& hints=RADIX_SIGNED);
+				// Same for a float key
+				bool			SortFloats(void* records, udword nb, udword record_size, udword key_offset);
+
+				// Returns the mode Sort() would use, for a given number of useful 8-bit passes
+		static	RecordSortMode	SelectMode(udword record_size, udword nb_passes);
+
+		// Settings
+		//! Forces a mode, RECORD_SORT_AUTO (the default) selects it for each call. RECORD_SORT_NONE is only reported by
+		//! GetLastMode(), it's the same as RECORD_SORT_AUTO here.
+		inline_	void			SetMode(RecordSortMode mode)		{ mMode = mode==RECORD_SORT_NONE ? RECORD_SORT_AUTO : mode;	}
+		//! Executor running the gather of the indirect mode. Null (the default) uses the global sort executor.
+		inline_	void			SetExecutor(SortExecutor* executor)	{ mExecutor = executor;	}
+
+		// Stats
+				udword			GetUsedRam()				const;
+		//! Returns the mode used by the last call.
+		inline_	RecordSortMode	GetLastMode()				const	{ return mLastMode;		}
+		//! Returns the number of passes of the last call.
+		inline_	udword			GetNbPasses()				const	{ return mNbPasses;		}
+
+								PREVENT_COPY(RecordSort)
+		private:
+				RadixSort2		mRadix2;			//!< Indirect mode
+				udword*			mKeys;				//!< Sortable keys, for the indirect mode
+				udword			mKeysSize;
+				ubyte*			mBuffer;			//!< Records, ping-pong buffer or gather destination
+				uqword			mBufferSize;
+				SortExecutor*	mExecutor;
+				RecordSortMode	mMode;
+				RecordSortMode	mLastMode;
+				udword			mNbPasses;
+
+		template<class Traits>
+				bool			SortRecords(ubyte* records, udword nb, udword record_size, udword key_offset);
+				bool			ResizeKeys(udword nb);
+				bool			ResizeBuffer(uqword size);
+	};
+
+#endif // RECORD_SORT_H
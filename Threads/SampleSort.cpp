@@ -0,0 +1,373 @@
+#include "stdafx.h"
+#include "SampleSort.h"
+#include "IntroSort.h"
+
+// Super scalar sample sort (Sanders & Winkel), with the equality buckets of IPS4o.
+// Splitters are stored as an implicit binary search tree: node i has children 2i and 2i+1. Finding the bucket of a key is
+// log2(nb buckets) steps of i = 2*i + (key > tree[i]), with no branch on the key. The bucket of each value is stored in an
+// oracle during the counting pass, so the scatter pass doesn't classify the values again.
+// Bucket b contains keys in ]splitter[b-1], splitter[b]]. With equality buckets, keys equal to splitter[b] go to their own
+// bucket: values are classified in 2*b + (key==splitter[b]), odd buckets hold a single key.
+
+namespace
+{
+	struct Classifier
+	{
+		udword	mTree[SAMPLE_SORT_MAX_BUCKETS];			//!< Search tree, from index 1
+		udword	mSplitters[SAMPLE_SORT_MAX_BUCKETS];	//!< Sorted splitters, for equality buckets
+		udword	mNbBuckets;								//!< Power of 2
+		udword	mNbLevels;
+
+		// Builds the tree for splitters [start, end[, from node 'node'
+		void	Build(udword node, udword start, udword end)
+		{
+			if(start>=end)
+				return;
+			const udword Middle = (start + end)/2;
+			mTree[node] = mSplitters[Middle];
+			Build(node*2, start, Middle);
+			Build(node*2+1, Middle+1, end);
+		}
+
+		template<bool EqualityBuckets>
+		inline_	udword	Classify(udword key)	const
+		{
+			udword i = 1;
+			for(udword j=0;j<mNbLevels;j++)
+				i = 2*i + (key>mTree[i]);
+			const udword Bucket = i - mNbBuckets;
+			return EqualityBuckets ? 2*Bucket + (key==mSplitters[Bucket]) : 2*Bucket;
+		}
+	};
+
+	struct PartitionContext
+	{
+		const udword*		mInput;
+		udword*				mKeys;
+		udword*				mIndices;
+		ubyte*				mOracle;
+		udword				mNb;
+		udword				mNbChunks;
+		udword*				mCounters;			//!< 2*SAMPLE_SORT_MAX_BUCKETS counters per chunk, then offsets
+		const Classifier*	mClassifier;
+	};
+
+	inline_ udword GetChunkStart(const PartitionContext* context, udword chunk)
+	{
+		return udword((uqword(context->mNb)*chunk)/context->mNbChunks);
+	}
+
+	template<class Traits, bool EqualityBuckets>
+	void CountJob(udword chunk, void* user_data)
+	{
+		const PartitionContext* Context = reinterpret_cast<const PartitionContext*>(user_data);
+		udword* Counters = Context->mCounters + chunk*SAMPLE_SORT_MAX_BUCKETS*2;
+		ZeroMemory(Counters, SAMPLE_SORT_MAX_BUCKETS*2*sizeof(udword));
+
+		const Classifier& C = *Context->mClassifier;
+		const typename Traits::Type* Input = reinterpret_cast<const typename Traits::Type*>(Context->mInput);
+		ubyte* Oracle = Context->mOracle;
+		const udword End = GetChunkStart(Context, chunk+1);
+		for(udword i=GetChunkStart(Context, chunk);i<End;i++)
+		{
+			const udword Bucket = C.Classify<EqualityBuckets>(Traits::ToSortable(Input[i]));
+			Oracle[i] = ubyte(Bucket);
+			Counters[Bucket]++;
+		}
+	}
+
+	template<class Traits>
+	void ScatterJob(udword chunk, void* user_data)
+	{
+		const PartitionContext* Context = reinterpret_cast<const PartitionContext*>(user_data);
+		udword* Offsets = Context->mCounters + chunk*SAMPLE_SORT_MAX_BUCKETS*2;
+
+		const typename Traits::Type* Input = reinterpret_cast<const typename Traits::Type*>(Context->mInput);
+		const ubyte* Oracle = Context->mOracle;
+		udword* Keys = Context->mKeys;
+		udword* Indices = Context->mIndices;
+		const udword End = GetChunkStart(Context, chunk+1);
+		for(udword i=GetChunkStart(Context, chunk);i<End;i++)
+		{
+			const udword Pos = Offsets[Oracle[i]]++;
+			Keys[Pos] = Traits::ToSortable(Input[i]);
+			Indices[Pos] = i;
+		}
+	}
+
+	struct BucketContext
+	{
+		const udword*		mKeys;
+		const udword*		mIndices;
+		udword*				mRanks;
+		const udword*		mStarts;
+		udword				mNbClasses;
+		SortDispatcher*		mDispatchers;		//!< One per worker
+		std::atomic<udword>	mNextBucket;		//!< Next bucket to sort, shared by the workers
+		std::atomic<bool>	mFailed;			//!< Out of memory in an engine
+		std::atomic<udword>*	mNbCalls;
+	};
+}
+
+SampleSort::SampleSort() :
+	mDispatchers		(null),
+	mNbDispatchers		(0),
+	mRanks				(null),
+	mKeys				(null),
+	mIndices			(null),
+	mOracle				(null),
+	mSortedRanks		(null),
+	mCurrentSize		(0),
+	mExecutor			(null),
+	mNbBuckets			(0),
+	mNbEqualityBuckets	(0)
+{
+	for(udword i=0;i<SORT_ENGINE_COUNT;i++)
+		mNbCalls[i] = 0;
+}
+
+SampleSort::~SampleSort()
+{
+	ICE_FREE(mOracle);
+	ICE_FREE(mIndices);
+	ICE_FREE(mKeys);
+	ICE_FREE(mRanks);
+	DELETEARRAY(mDispatchers);
+}
+
+bool SampleSort::CheckResize(udword nb)
+{
+	if(nb<=mCurrentSize)
+		return true;
+
+	ICE_FREE(mOracle);
+	ICE_FREE(mIndices);
+	ICE_FREE(mKeys);
+	ICE_FREE(mRanks);
+	mCurrentSize = 0;
+	mRanks		= reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*nb));
+	mKeys		= reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*nb));
+	mIndices	= reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*nb));
+	mOracle		= reinterpret_cast<ubyte*>(ICE_ALLOC(sizeof(ubyte)*nb));
+	if(!mRanks || !mKeys || !mIndices || !mOracle)
+		return false;
+	mCurrentSize = nb;
+	return true;
+}
+
+// Each worker pulls buckets until there's none left, and sorts them with its own dispatcher: its buffers are reused from
+// one bucket to the next, and from one call to the next.
+void SampleSort::SortBucketsJob(udword worker, void* user_data)
+{
+	BucketContext* Context = reinterpret_cast<BucketContext*>(user_data);
+	SortDispatcher& Dispatcher = Context->mDispatchers[worker];
+
+	udword Index;
+	while((Index = Context->mNextBucket++)<Context->mNbClasses)
+	{
+		const udword Start = Context->mStarts[Index];
+		const udword Nb = Context->mStarts[Index+1] - Start;
+		if(!Nb)
+			continue;
+
+		const udword* Indices = Context->mIndices + Start;
+		udword* Ranks = Context->mRanks + Start;
+
+		// Equality buckets are sorted already, and the partition is stable
+		if((Index & 1) || Nb==1)
+		{
+			CopyMemory(Ranks, Indices, Nb*sizeof(udword));
+			continue;
+		}
+
+		// Ranks of the previous bucket are unrelated to this one, and would break the stability
+		Dispatcher.ResetRanks();
+		const udword* LocalRanks = Dispatcher.Sort(Context->mKeys + Start, Nb, RadixHints(RADIX_UNSIGNED, RADIX_RANDOM));
+		if(!LocalRanks)
+		{
+			Context->mFailed = true;
+			continue;
+		}
+		for(udword i=0;i<Nb;i++)
+			Ranks[i] = Indices[LocalRanks[i]];
+		Context->mNbCalls[Dispatcher.GetLastEngine()]++;
+	}
+}
+
+template<class Traits>
+const udword* SampleSort::SortKeys(const typename Traits::Type* input, udword nb)
+{
+	if(!CheckResize(nb))
+		return null;
+
+	SortExecutor* Executor = mExecutor ? mExecutor : GetSortExecutor();
+
+	// Number of buckets: small enough to be sorted in cache, enough of them to keep all threads busy
+	udword NbBuckets = 2;
+	udword NbLevels = 1;
+	while(NbBuckets<SAMPLE_SORT_MAX_BUCKETS && (NbBuckets*SAMPLE_SORT_BUCKET_SIZE<nb || NbBuckets<4*(Executor->GetNbThreads()+1)))
+	{
+		NbBuckets *= 2;
+		NbLevels++;
+	}
+
+	// Sample. The generator is seeded the same way for each call, so results are reproducible.
+	const udword NbSamples = NbBuckets*SAMPLE_SORT_OVERSAMPLING;
+	udword Samples[SAMPLE_SORT_MAX_BUCKETS*SAMPLE_SORT_OVERSAMPLING];
+	udword Seed = 0x9e3779b9;
+	for(udword i=0;i<NbSamples;i++)
+	{
+		Seed ^= Seed<<13;
+		Seed ^= Seed>>17;
+		Seed ^= Seed<<5;
+		Samples[i] = Traits::ToSortable(input[Seed % nb]);
+	}
+	IntroSort<udword> Sorter(ADAPTIVE_PARTITION);
+	Sorter.Sort(Samples, NbSamples);
+
+	// Splitters. Duplicates are heavy keys: they're only kept once, and enable equality buckets.
+	Classifier C;
+	udword NbSplitters = 0;
+	bool Duplicates = false;
+	for(udword i=1;i<NbBuckets;i++)
+	{
+		const udword Splitter = Samples[i*SAMPLE_SORT_OVERSAMPLING - 1];
+		if(NbSplitters && C.mSplitters[NbSplitters-1]==Splitter)
+			Duplicates = true;
+		else
+			C.mSplitters[NbSplitters++] = Splitter;
+	}
+	// Missing splitters repeat the last one, their buckets stay empty. The last bucket has no upper splitter: its keys are
+	// larger than the last one, so they never go to its equality bucket.
+	for(udword i=NbSplitters;i<NbBuckets;i++)
+		C.mSplitters[i] = C.mSplitters[NbSplitters-1];
+	C.mNbBuckets = NbBuckets;
+	C.mNbLevels = NbLevels;
+	C.Build(1, 0, NbBuckets-1);
+
+	// Parallel partition
+	udword NbChunks = Executor->GetNbThreads() + 1;
+	if(nb/NbChunks<SAMPLE_SORT_BUCKET_SIZE)
+		NbChunks = nb/SAMPLE_SORT_BUCKET_SIZE ? nb/SAMPLE_SORT_BUCKET_SIZE : 1;
+
+	PartitionContext Context;
+	Context.mInput		= reinterpret_cast<const udword*>(input);
+	Context.mKeys		= mKeys;
+	Context.mIndices	= mIndices;
+	Context.mOracle		= mOracle;
+	Context.mNb			= nb;
+	Context.mNbChunks	= NbChunks;
+	Context.mCounters	= reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*SAMPLE_SORT_MAX_BUCKETS*2*NbChunks));
+	Context.mClassifier	= &C;
+	if(!Context.mCounters)
+		return null;
+
+	if(Duplicates)
+		Executor->ParallelFor(NbChunks, CountJob<Traits, true>, &Context);
+	else
+		Executor->ParallelFor(NbChunks, CountJob<Traits, false>, &Context);
+
+	// Each chunk writes its values after the same bucket's values from previous chunks
+	const udword NbClasses = NbBuckets*2;
+	udword Starts[SAMPLE_SORT_MAX_BUCKETS*2+1];
+	udword Offset = 0;
+	for(udword i=0;i<NbClasses;i++)
+	{
+		Starts[i] = Offset;
+		for(udword j=0;j<NbChunks;j++)
+		{
+			udword& Counter = Context.mCounters[j*SAMPLE_SORT_MAX_BUCKETS*2 + i];
+			const udword Count = Counter;
+			Counter = Offset;
+			Offset += Count;
+		}
+		if((i & 1) && Offset!=Starts[i])
+			mNbEqualityBuckets++;
+	}
+	Starts[NbClasses] = Offset;
+
+	Executor->ParallelFor(NbChunks, ScatterJob<Traits>, &Context);
+	ICE_FREE(Context.mCounters);
+
+	// Sort the buckets, one dispatcher per worker
+	const udword NbWorkers = TMin(Executor->GetNbThreads() + 1, NbClasses);
+	if(NbWorkers>mNbDispatchers)
+	{
+		DELETEARRAY(mDispatchers);
+		mDispatchers = new SortDispatcher[NbWorkers];
+		mNbDispatchers = NbWorkers;
+	}
+
+	BucketContext Buckets;
+	Buckets.mKeys			= mKeys;
+	Buckets.mIndices		= mIndices;
+	Buckets.mRanks			= mRanks;
+	Buckets.mStarts			= Starts;
+	Buckets.mNbClasses		= NbClasses;
+	Buckets.mDispatchers	= mDispatchers;
+	Buckets.mNextBucket		= 0;
+	Buckets.mFailed			= false;
+	Buckets.mNbCalls		= mNbCalls;
+	Executor->ParallelFor(NbWorkers, SortBucketsJob, &Buckets);
+	if(Buckets.mFailed)
+		return null;
+
+	mNbBuckets = Duplicates ? NbBuckets + mNbEqualityBuckets : NbBuckets;
+	return mRanks;
+}
+
+const udword* SampleSort::Sort(const udword* input, udword nb, const RadixHints& hints)
+{
+	if(!input || !nb)
+		return null;
+
+	mNbBuckets = mNbEqualityBuckets = 0;
+	for(udword i=0;i<SORT_ENGINE_COUNT;i++)
+		mNbCalls[i] = 0;
+
+	SortExecutor* Executor = mExecutor ? mExecutor : GetSortExecutor();
+	if(nb<SAMPLE_SORT_MIN_NB || !Executor->GetNbThreads())
+	{
+		// Same ranks as the parallel path, whatever the previous calls were
+		mDispatcher.ResetRanks();
+		mSortedRanks = mDispatcher.Sort(input, nb, hints);
+		mNbCalls[mDispatcher.GetLastEngine()]++;
+		mNbBuckets = 1;
+		return mSortedRanks;
+	}
+
+	mSortedRanks = hints.IsUnsigned() ? SortKeys<RadixKeyU32>(input, nb) : SortKeys<RadixKeyS32>(input, nb);
+	return mSortedRanks;
+}
+
+const udword* SampleSort::Sort(const float* input, udword nb, const RadixHints& hints)
+{
+	if(!input || !nb)
+		return null;
+
+	mNbBuckets = mNbEqualityBuckets = 0;
+	for(udword i=0;i<SORT_ENGINE_COUNT;i++)
+		mNbCalls[i] = 0;
+
+	SortExecutor* Executor = mExecutor ? mExecutor : GetSortExecutor();
+	if(nb<SAMPLE_SORT_MIN_NB || !Executor->GetNbThreads())
+	{
+		mDispatcher.ResetRanks();
+		mSortedRanks = mDispatcher.Sort(input, nb, hints);
+		mNbCalls[mDispatcher.GetLastEngine()]++;
+		mNbBuckets = 1;
+		return mSortedRanks;
+	}
+
+	// Same keys as RadixSort: a NaN policy wins over RADIX_POSITIVE, NaNs first wins over NaNs last
+	const udword* Bits = reinterpret_cast<const udword*>(input);
+	if(hints.mFlags & RADIX_NANS_FIRST)
+		mSortedRanks = SortKeys<RadixKeyF32NaNsFirst>(Bits, nb);
+	else if(hints.mFlags & RADIX_NANS_LAST)
+		mSortedRanks = SortKeys<RadixKeyF32NaNsLast>(Bits, nb);
+	else if(!(hints.mFlags & RADIX_TOTAL_ORDER) && (hints.mFlags & RADIX_POSITIVE))
+		mSortedRanks = SortKeys<RadixKeyU32>(Bits, nb);
+	else
+		mSortedRanks = SortKeys<RadixKeyF32>(Bits, nb);
+	return mSortedRanks;
+}
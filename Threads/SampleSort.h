@@ -0,0 +1,66 @@
+#ifndef SAMPLE_SORT_H
+#define SAMPLE_SORT_H
+
+#include "SortDispatcher.h"
+
+	// Parallel sample sort, for skewed keys that don't balance well with radix partitions.
+	// - splitters are picked from a sorted sample of the keys,
+	// - keys are classified with a branchless search tree and partitioned in parallel, each thread handling one chunk,
+	// - each bucket is sorted by one thread, with the engine a SortDispatcher picks for its size (IntroSort, RadixSort,
+	//   RadixSort3 or RadixSort2),
+	// - splitters found several times in the sample are heavy keys: they get their own equality buckets, which are
+	//   already sorted after the partition.
+	// The sort is stable, ranks are the same as RadixSort's. NaN policies are supported. No temporal coherence: ranks of
+	// previous calls are ignored, even on the small path.
+
+	#define SAMPLE_SORT_MIN_NB			65536	// Smaller arrays are sorted by a SortDispatcher on the calling thread
+	#define SAMPLE_SORT_BUCKET_SIZE		32768	// Target bucket size
+	#define SAMPLE_SORT_MAX_BUCKETS		128		// Power of 2, twice that many with equality buckets
+	#define SAMPLE_SORT_OVERSAMPLING	16		// Samples per bucket
+
+	class SampleSort
+	{
+		public:
+								SampleSort();
+								~SampleSort();
+
+				const udword*	Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				const udword*	Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+
+		inline_	const udword*	GetRanks()							const	{ return mSortedRanks;				}
+
+		// Settings
+		//! Runs the sort on a given executor. Null (the default) uses the global sort executor.
+		inline_	void			SetExecutor(SortExecutor* executor)			{ mExecutor = executor;				}
+
+		// Instrumentation, for the last call
+		//! Returns the number of buckets, including equality buckets.
+		inline_	udword			GetNbBuckets()						const	{ return mNbBuckets;				}
+		//! Returns the number of equality buckets, i.e. heavy keys found in the sample.
+		inline_	udword			GetNbEqualityBuckets()				const	{ return mNbEqualityBuckets;		}
+		//! Returns the number of buckets sorted by an engine.
+		inline_	udword			GetNbCalls(SortEngine engine)		const	{ return mNbCalls[engine];			}
+
+								PREVENT_COPY(SampleSort)
+		private:
+				SortDispatcher	mDispatcher;		//!< Small arrays
+				SortDispatcher*	mDispatchers;		//!< One per worker, for the buckets
+				udword			mNbDispatchers;
+				udword*			mRanks;				//!< Ranks of the partitioned buckets
+				udword*			mKeys;				//!< Sortable keys, partitioned
+				udword*			mIndices;			//!< Indices of these keys
+				ubyte*			mOracle;			//!< Bucket of each input value
+				const udword*	mSortedRanks;		//!< Ranks from the last call
+				udword			mCurrentSize;
+				SortExecutor*	mExecutor;
+				udword			mNbBuckets;
+				udword			mNbEqualityBuckets;
+				std::atomic<udword>	mNbCalls[SORT_ENGINE_COUNT];
+
+				bool			CheckResize(udword nb);
+		template<class Traits>
+				const udword*	SortKeys(const typename Traits::Type* input, udword nb);
+		static	void			SortBucketsJob(udword worker, void* user_data);
+	};
+
+#endif // SAMPLE_SORT_H
@@ -0,0 +1,259 @@
+#include "stdafx.h"
+#include "SortCalibration.h"
+#include <chrono>
+#include <string.h>
+
+// Per-machine calibration of the sort engines.
+// The crossovers in RadixTest.cpp were measured once, on one machine. Cache sizes move them a lot, so we measure
+// them again here: each engine sorts the same random keys, for sizes going from 64 values to max_nb, and we keep
+// the sizes where the winner changes. Results are saved to a small text file so that later runs just load them.
+// The digit width of the large-array engine moves with cache sizes too: fewer passes against bigger histograms.
+
+#define SORT_PROFILE_VERSION	3
+#define CALIBRATION_MIN_NB		64
+#define CALIBRATION_NB_RUNS		5			// Median of N, to filter out context switches & frequency changes
+#define CALIBRATION_WORK		(1<<20)		// Number of values sorted per run, small arrays are sorted several times
+
+bool SortProfile::IsValid() const
+{
+	return mThresholds.mIntroSortMax<mThresholds.mRadix3Min && mThresholds.mIntroSortMax<mThresholds.mRadix2Min
+		&& IsValidDigitBits(mThresholds.mDigitBits);
+}
+
+typedef std::chrono::high_resolution_clock	CalibrationClock;
+
+// Same keys on every machine, so that results can be compared
+static void GenerateKeys(udword* keys, udword nb)
+{
+	udword Seed = 0x9e3779b9;
+	for(udword i=0;i<nb;i++)
+	{
+		Seed ^= Seed<<13;
+		Seed ^= Seed>>17;
+		Seed ^= Seed<<5;
+		keys[i] = Seed;
+	}
+}
+
+static udword GetNbReps(udword nb)
+{
+	const udword NbReps = CALIBRATION_WORK/nb;
+	return NbReps ? NbReps : 1;
+}
+
+// Thresholds forcing SortDispatcher to use a given engine. RadixSort3 & RadixSortBits both come from the digit width.
+static SortThresholds ForceEngine(SortEngine engine, udword digit_bits)
+{
+	SortThresholds T;
+	T.mIntroSortMax	= engine==SORT_ENGINE_INTROSORT ? 0xffffffff : 0;
+	T.mRadix3Min	= engine==SORT_ENGINE_RADIX ? 0xffffffff : 0;
+	T.mRadix2Min	= engine==SORT_ENGINE_RADIX2 ? 0 : 0xffffffff;
+	T.mDigitBits	= digit_bits;
+	return T;
+}
+
+// The best run is biased towards lucky runs, e.g. the first one at a higher clock. The median isn't.
+static double GetMedian(double* times, udword nb)
+{
+	for(udword i=1;i<nb;i++)
+	{
+		const double Time = times[i];
+		udword j = i;
+		for(;j && times[j-1]>Time;j--)
+			times[j] = times[j-1];
+		times[j] = Time;
+	}
+	return times[nb/2];
+}
+
+// Returns the time per sort, in seconds. Keys are random so the coherence check is disabled, otherwise sorting the
+// same keys again would be an early exit.
+static double TimeEngine(SortEngine engine, const udword* keys, udword nb, udword digit_bits)
+{
+	SortDispatcher Sorter;
+	Sorter.SetThresholds(ForceEngine(engine, digit_bits));
+
+	const RadixHints Hints(RADIX_UNSIGNED, RADIX_RANDOM);
+	const udword NbReps = GetNbReps(nb);
+	double Times[CALIBRATION_NB_RUNS];
+	for(udword Run=0;Run<CALIBRATION_NB_RUNS;Run++)
+	{
+		const CalibrationClock::time_point Start = CalibrationClock::now();
+		for(udword i=0;i<NbReps;i++)
+			Sorter.Sort(keys, nb, Hints);
+		Times[Run] = std::chrono::duration<double>(CalibrationClock::now() - Start).count();
+		ASSERT(Sorter.GetLastEngine()==engine);
+	}
+	return GetMedian(Times, CALIBRATION_NB_RUNS)/NbReps;
+}
+
+// Same as TimeEngine() for one digit width, without the dispatcher
+template<udword NbBits>
+static double TimeDigitBits(const udword* keys, udword nb)
+{
+	RadixSortBits<NbBits> Sorter;
+
+	const RadixHints Hints(RADIX_UNSIGNED, RADIX_RANDOM);
+	const udword NbReps = GetNbReps(nb);
+	double Times[CALIBRATION_NB_RUNS];
+	for(udword Run=0;Run<CALIBRATION_NB_RUNS;Run++)
+	{
+		const CalibrationClock::time_point Start = CalibrationClock::now();
+		for(udword i=0;i<NbReps;i++)
+			Sorter.Sort(keys, nb, Hints);
+		Times[Run] = std::chrono::duration<double>(CalibrationClock::now() - Start).count();
+	}
+	return GetMedian(Times, CALIBRATION_NB_RUNS)/NbReps;
+}
+
+// Returns the fastest digit width on nb keys
+static udword SelectDigitBits(const udword* keys, udword nb)
+{
+	const udword NbBits[] = { 8, 10, 11, 12, 16 };
+	const double Times[] =
+	{
+		TimeDigitBits<8>(keys, nb),
+		TimeDigitBits<10>(keys, nb),
+		TimeDigitBits<11>(keys, nb),
+		TimeDigitBits<12>(keys, nb),
+		TimeDigitBits<16>(keys, nb),
+	};
+
+	udword Best = 0;
+	for(udword i=1;i<sizeof(NbBits)/sizeof(NbBits[0]);i++)
+	{
+		if(Times[i]<Times[Best])
+			Best = i;
+	}
+	return NbBits[Best];
+}
+
+bool CalibrateSort(SortProfile& profile, udword max_nb)
+{
+	if(max_nb<CALIBRATION_MIN_NB)
+		return false;
+
+	udword* Keys = reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*max_nb));
+	if(!Keys)
+		return false;
+	GenerateKeys(Keys, max_nb);
+
+	// Digit width first, on the largest size we time: that's where it matters, and the crossovers below then use it
+	udword LargestNb = CALIBRATION_MIN_NB;
+	while(LargestNb<=max_nb/2)
+		LargestNb *= 2;
+	const udword DigitBits = SelectDigitBits(Keys, LargestNb);
+	const SortEngine LargeEngine = DigitBits==11 ? SORT_ENGINE_RADIX3 : SORT_ENGINE_RADIX_BITS;
+
+	// The first size where an engine wins is the crossover. IntroSort only gets worse with size, so we stop
+	// timing it as soon as it loses.
+	udword IntroSortMax = 0;
+	udword Radix3Min = 0xffffffff;
+	udword Radix2Min = 0xffffffff;
+	bool IntroSortLost = false;
+	for(udword Nb=CALIBRATION_MIN_NB;Nb<=max_nb;Nb*=2)
+	{
+		const double Radix	= TimeEngine(SORT_ENGINE_RADIX, Keys, Nb, DigitBits);
+		const double Radix3	= TimeEngine(LargeEngine, Keys, Nb, DigitBits);
+		const double Radix2	= TimeEngine(SORT_ENGINE_RADIX2, Keys, Nb, DigitBits);
+		const double BestRadix = Radix<Radix3 ? Radix : Radix3;
+
+		if(!IntroSortLost)
+		{
+			const double Intro = TimeEngine(SORT_ENGINE_INTROSORT, Keys, Nb, DigitBits);
+			if(Intro<=BestRadix && Intro<=Radix2)
+				IntroSortMax = Nb;
+			else
+				IntroSortLost = true;
+		}
+		if(Radix3Min==0xffffffff && Radix3<Radix)
+			Radix3Min = Nb;
+		if(Radix2Min==0xffffffff && Radix2<BestRadix)
+			Radix2Min = Nb;
+
+		if(Nb>max_nb/2)
+			break;
+	}
+	ICE_FREE(Keys);
+
+	// Radix crossovers found among IntroSort's sizes don't matter, SortDispatcher picks IntroSort there
+	if(Radix3Min<=IntroSortMax)
+		Radix3Min = IntroSortMax + 1;
+	if(Radix2Min<=IntroSortMax)
+		Radix2Min = IntroSortMax + 1;
+
+	profile.mThresholds.mIntroSortMax	= IntroSortMax;
+	profile.mThresholds.mRadix3Min		= Radix3Min;
+	profile.mThresholds.mRadix2Min		= Radix2Min;
+	profile.mThresholds.mDigitBits		= DigitBits;
+	ASSERT(profile.IsValid());
+	return true;
+}
+
+bool SaveSortProfile(const char* filename, const SortProfile& profile)
+{
+	FILE* fp = fopen(filename, "w");
+	if(!fp)
+		return false;
+
+	fprintf(fp, "SortProfile %d\n", SORT_PROFILE_VERSION);
+	fprintf(fp, "IntroSortMax %u\n", profile.mThresholds.mIntroSortMax);
+	fprintf(fp, "Radix3Min %u\n", profile.mThresholds.mRadix3Min);
+	fprintf(fp, "Radix2Min %u\n", profile.mThresholds.mRadix2Min);
+	fprintf(fp, "DigitBits %u\n", profile.mThresholds.mDigitBits);
+
+	const bool Status = ferror(fp)==0;
+	fclose(fp);
+	return Status;
+}
+
+bool LoadSortProfile(const char* filename, SortProfile& profile)
+{
+	profile = SortProfile();
+
+	FILE* fp = fopen(filename, "r");
+	if(!fp)
+		return false;
+
+	// Profiles from other versions are ignored, they'd be recalibrated
+	udword Version = 0;
+	if(fscanf(fp, "SortProfile %u", &Version)!=1 || Version!=SORT_PROFILE_VERSION)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	// Unknown entries are skipped, missing ones keep their default values
+	SortProfile Profile;
+	char Name[64];
+	udword Value;
+	while(fscanf(fp, "%63s %u", Name, &Value)==2)
+	{
+		if(strcmp(Name, "IntroSortMax")==0)		Profile.mThresholds.mIntroSortMax = Value;
+		else if(strcmp(Name, "Radix3Min")==0)	Profile.mThresholds.mRadix3Min = Value;
+		else if(strcmp(Name, "Radix2Min")==0)	Profile.mThresholds.mRadix2Min = Value;
+		else if(strcmp(Name, "DigitBits")==0)	Profile.mThresholds.mDigitBits = Value;
+	}
+	fclose(fp);
+
+	// Hand-edited or corrupted files: thresholds in the wrong order would skip engines, and a width without a sorter
+	// would fall back to RadixSort3. Keep the defaults instead.
+	if(!Profile.IsValid())
+		return false;
+
+	profile = Profile;
+	return true;
+}
+
+bool InitSortProfile(const char* filename, SortProfile& profile, udword max_nb)
+{
+	if(LoadSortProfile(filename, profile))
+		return true;
+
+	if(!CalibrateSort(profile, max_nb))
+		return false;
+
+	// Not being able to save is not an error, we'll just calibrate again next time
+	SaveSortProfile(filename, profile);
+	return true;
+}
@@ -0,0 +1,27 @@
+#ifndef SORT_CALIBRATION_H
+#define SORT_CALIBRATION_H
+
+#include "SortDispatcher.h"
+
+	// Machine-specific settings, measured by CalibrateSort()
+	struct SortProfile
+	{
+		// IntroSort's range comes first: IntroSortMax < Radix3Min and IntroSortMax < Radix2Min. DigitBits is 8, 10, 11, 12 or 16.
+		bool			IsValid()	const;
+
+		SortThresholds	mThresholds;	//!< Crossovers for SortDispatcher
+	};
+
+	// Micro-benchmarks the engines on random keys, from 64 values up to max_nb, and fills the profile. The digit width
+	// for large arrays is timed at the largest size.
+	bool	CalibrateSort(SortProfile& profile, udword max_nb=1<<21);
+
+	// Small text file, one "name value" pair per line. When loading fails (missing file, other version, invalid values),
+	// the profile gets the default thresholds.
+	bool	SaveSortProfile(const char* filename, const SortProfile& profile);
+	bool	LoadSortProfile(const char* filename, SortProfile& profile);
+
+	// Loads the profile if the file exists, otherwise calibrates and saves it. Call this once at startup.
+	bool	InitSortProfile(const char* filename, SortProfile& profile, udword max_nb=1<<21);
+
+#endif // SORT_CALIBRATION_H
@@ -0,0 +1,207 @@
+#include "stdafx.h"
+#include "SortDispatcher.h"
+#include "IntroSort.h"
+
+// Automatic engine selection.
+// From RadixTest.cpp:
+// - IntroSort wins at 100 values, but is 3 times slower than RadixSort at 1000.
+// - RadixSort3 is faster than RadixSort for large arrays (see IceRadix3Passes.cpp).
+// - RadixSort2 is as fast as RadixSort at 1M values, and 10 times faster at 5M.
+// - The best digit width for large arrays depends on cache sizes, 11 bits (RadixSort3) by default. See CalibrateSort().
+SortThresholds::SortThresholds() :
+	mIntroSortMax	(256),
+	mRadix3Min		(10000),
+	mRadix2Min		(1000000),
+	mDigitBits		(11)
+{
+}
+
+bool IsValidDigitBits(udword nb_bits)
+{
+	return nb_bits==8 || nb_bits==10 || nb_bits==11 || nb_bits==12 || nb_bits==16;
+}
+
+const char* GetSortEngineName(SortEngine engine)
+{
+	switch(engine)
+	{
+		case SORT_ENGINE_INTROSORT:	return "IntroSort";
+		case SORT_ENGINE_RADIX:		return "RadixSort";
+		case SORT_ENGINE_RADIX3:	return "RadixSort3";
+		case SORT_ENGINE_RADIX2:	return "RadixSort2";
+		case SORT_ENGINE_RADIX_BITS:	return "RadixSortBits";
+		default:					return "None";
+	}
+}
+
+SortDispatcher::SortDispatcher() :
+	mPairs				(null),
+	mIntroRanks			(null),
+	mIntroSize			(0),
+	mRanks				(null),
+	mLastNb				(0),
+	mLastEngine			(SORT_ENGINE_NONE),
+	mMaxScratchMemory	(0)
+{
+	ZeroMemory(mNbCalls, sizeof(mNbCalls));
+}
+
+SortDispatcher::~SortDispatcher()
+{
+	ICE_FREE(mIntroRanks);
+	ICE_FREE(mPairs);
+}
+
+uqword SortDispatcher::GetScratchMemory(SortEngine engine, udword nb, udword digit_bits)
+{
+	switch(engine)
+	{
+		case SORT_ENGINE_INTROSORT:	return uqword(nb)*(sizeof(uqword)+sizeof(udword));	// Pairs & ranks
+		case SORT_ENGINE_RADIX:
+		case SORT_ENGINE_RADIX3:	return uqword(nb)*sizeof(udword)*2;					// 2 lists of ranks
+		case SORT_ENGINE_RADIX2:	return uqword(nb)*sizeof(Combo)*2;					// 2 lists of combos
+		case SORT_ENGINE_RADIX_BITS:													// 2 lists of ranks & the histograms, too big for the stack
+			return uqword(nb)*sizeof(udword)*2 + (uqword(sizeof(udword))<<digit_bits)*((32+digit_bits-1)/digit_bits);
+		default:					return 0;
+	}
+}
+
+bool SortDispatcher::FitsInScratchMemory(SortEngine engine, udword nb) const
+{
+	return !mMaxScratchMemory || GetScratchMemory(engine, nb, mThresholds.mDigitBits)<=mMaxScratchMemory;
+}
+
+SortEngine SortDispatcher::SelectEngine(udword nb, bool float_keys, const RadixHints& hints) const
+{
+	// NaN policies are only supported by RadixSort
+	if(float_keys && (hints.mFlags & RADIX_NAN_POLICY))
+		return FitsInScratchMemory(SORT_ENGINE_RADIX, nb) ? SORT_ENGINE_RADIX : SORT_ENGINE_NONE;
+
+	// Presorted input: stick to the previous radix engine when its ranks can be reused for temporal coherence.
+	// Otherwise small inputs go to IntroSort as usual: its adaptive partition (see SortIntro) is linear on sorted input.
+	if((hints.mFlags & RADIX_PRESORTED) && nb==mLastNb && FitsInScratchMemory(mLastEngine, nb)
+		&& (mLastEngine==SORT_ENGINE_RADIX || mLastEngine==SORT_ENGINE_RADIX3 || mLastEngine==SORT_ENGINE_RADIX_BITS))
+		return mLastEngine;
+
+	if(nb<=mThresholds.mIntroSortMax && FitsInScratchMemory(SORT_ENGINE_INTROSORT, nb))
+		return SORT_ENGINE_INTROSORT;
+
+	// RadixSort2 needs twice the memory of the others, and only handles unsigned integers
+	if(nb>=mThresholds.mRadix2Min && !float_keys && hints.IsUnsigned() && FitsInScratchMemory(SORT_ENGINE_RADIX2, nb))
+		return SORT_ENGINE_RADIX2;
+
+	// Large arrays use the calibrated digit width. Invalid widths fall back to RadixSort3.
+	const udword DigitBits = mThresholds.mDigitBits;
+	const SortEngine LargeEngine = (DigitBits!=11 && IsValidDigitBits(DigitBits)) ? SORT_ENGINE_RADIX_BITS : SORT_ENGINE_RADIX3;
+
+	// No fallback when the radix engines don't fit: IntroSort needs more memory than they do
+	const SortEngine Engine = nb>=mThresholds.mRadix3Min ? LargeEngine : SORT_ENGINE_RADIX;
+	return FitsInScratchMemory(Engine, nb) ? Engine : SORT_ENGINE_NONE;
+}
+
+// Sorts (key, index) pairs packed in 64-bit values. Indices in the low bits keep the sort stable.
+template<class Traits>
+const udword* SortDispatcher::SortIntro(const typename Traits::Type* input, udword nb)
+{
+	if(nb>mIntroSize)
+	{
+		ICE_FREE(mIntroRanks);
+		ICE_FREE(mPairs);
+		mIntroSize = 0;
+		mPairs		= reinterpret_cast<uqword*>(ICE_ALLOC(sizeof(uqword)*nb));
+		mIntroRanks	= reinterpret_cast<udword*>(ICE_ALLOC(sizeof(udword)*nb));
+		if(!mPairs || !mIntroRanks)
+			return null;
+		mIntroSize = nb;
+	}
+
+	for(udword i=0;i<nb;i++)
+		mPairs[i] = (uqword(Traits::ToSortable(input[i]))<<32)|i;
+
+	// Adaptive mode: sorted or nearly sorted keys are handled in linear time
+	IntroSort<uqword> Sorter(ADAPTIVE_PARTITION);
+	Sorter.Sort(mPairs, nb);
+
+	for(udword i=0;i<nb;i++)
+		mIntroRanks[i] = udword(mPairs[i]);
+	return mIntroRanks;
+}
+
+template<class T>
+const udword* SortDispatcher::SortRadixBits(const T* input, udword nb, const RadixHints& hints)
+{
+	switch(mThresholds.mDigitBits)
+	{
+		case 8:		return mRadix8.Sort(input, nb, hints).GetRanks();
+		case 10:	return mRadix10.Sort(input, nb, hints).GetRanks();
+		case 12:	return mRadix12.Sort(input, nb, hints).GetRanks();
+		case 16:	return mRadix16.Sort(input, nb, hints).GetRanks();
+		default:	return null;	// SelectEngine() doesn't pick RadixSortBits for other widths
+	}
+}
+
+const udword* SortDispatcher::Sort(const udword* input, udword nb, const RadixHints& hints)
+{
+	if(!input || !nb)
+		return null;
+
+	const SortEngine Engine = SelectEngine(nb, false, hints);
+	switch(Engine)
+	{
+		case SORT_ENGINE_INTROSORT:
+			mRanks = hints.IsUnsigned() ? SortIntro<RadixKeyU32>(input, nb) : SortIntro<RadixKeyS32>(input, nb);
+			break;
+		case SORT_ENGINE_RADIX:
+			mRanks = mRadix.Sort(input, nb, hints).GetRanks();
+			break;
+		case SORT_ENGINE_RADIX3:
+			mRanks = mRadix3.Sort(input, nb, hints).GetRanks();
+			break;
+		case SORT_ENGINE_RADIX2:
+			mRanks = mRadix2.Sort(input, nb, hints);
+			break;
+		case SORT_ENGINE_RADIX_BITS:
+			mRanks = SortRadixBits(input, nb, hints);
+			break;
+		default:
+			mRanks = null;
+			break;
+	}
+	mLastNb = nb;
+	mLastEngine = Engine;
+	mNbCalls[Engine]++;
+	return mRanks;
+}
+
+const udword* SortDispatcher::Sort(const float* input, udword nb, const RadixHints& hints)
+{
+	if(!input || !nb)
+		return null;
+
+	const udword* Bits = reinterpret_cast<const udword*>(input);
+	const bool Positive = (hints.mFlags & RADIX_POSITIVE)!=0;
+
+	const SortEngine Engine = SelectEngine(nb, true, hints);
+	switch(Engine)
+	{
+		case SORT_ENGINE_INTROSORT:
+			mRanks = Positive ? SortIntro<RadixKeyU32>(Bits, nb) : SortIntro<RadixKeyF32>(Bits, nb);
+			break;
+		case SORT_ENGINE_RADIX:
+			mRanks = mRadix.Sort(input, nb, hints).GetRanks();
+			break;
+		case SORT_ENGINE_RADIX3:
+			mRanks = mRadix3.Sort(input, nb, hints).GetRanks();
+			break;
+		case SORT_ENGINE_RADIX_BITS:
+			mRanks = SortRadixBits(input, nb, hints);
+			break;
+		default:
+			mRanks = null;
+			break;
+	}
+	mLastNb = nb;
+	mLastEngine = Engine;
+	mNbCalls[Engine]++;
+	return mRanks;
+}
@@ -0,0 +1,98 @@
+#ifndef SORT_DISPATCHER_H
+#define SORT_DISPATCHER_H
+
+#include "RadixSort2.h"
+
+	enum SortEngine
+	{
+		SORT_ENGINE_NONE,			//!< Nothing sorted yet
+		SORT_ENGINE_INTROSORT,		//!< IntroSort on (key, index) pairs
+		SORT_ENGINE_RADIX,			//!< RadixSort, 8-bit digits
+		SORT_ENGINE_RADIX3,			//!< RadixSort3, 11-bit digits
+		SORT_ENGINE_RADIX2,			//!< RadixSort2, cache-friendly combos (unsigned integers only)
+		SORT_ENGINE_RADIX_BITS,		//!< RadixSortBits, digit width from SortThresholds::mDigitBits (8, 10, 12 or 16 bits)
+
+		SORT_ENGINE_COUNT
+	};
+
+	const char*	GetSortEngineName(SortEngine engine);
+
+	// Digit widths available for large arrays: 11 bits is RadixSort3, 8, 10, 12 & 16 bits are RadixSortBits
+	bool		IsValidDigitBits(udword nb_bits);
+
+	// Crossovers between engines, in number of values. Defaults come from the tables in RadixTest.cpp.
+	struct SortThresholds
+	{
+		SortThresholds();
+
+		udword	mIntroSortMax;		//!< IntroSort up to that many values
+		udword	mRadix3Min;			//!< RadixSort3 from that many values
+		udword	mRadix2Min;			//!< RadixSort2 from that many values, when keys are unsigned integers
+		udword	mDigitBits;			//!< Digit width from mRadix3Min on: 11 for RadixSort3, else RadixSortBits
+	};
+
+	// Front-end sorting routine, picking the engine from the number of values, the key type, the hints and the scratch memory budget.
+	// Engines are kept between calls, so temporal coherence still works as long as the same engine gets picked.
+	class SortDispatcher
+	{
+		public:
+								SortDispatcher();
+								~SortDispatcher();
+
+				const udword*	Sort(const udword* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+				const udword*	Sort(const float* input, udword nb, const RadixHints& hints=RADIX_SIGNED);
+
+				// Returns the engine Sort() would use, SORT_ENGINE_NONE if none fits in the scratch memory budget
+				SortEngine		SelectEngine(udword nb, bool float_keys, const RadixHints& hints)	const;
+				// Returns the scratch memory needed by an engine, in bytes. The digit width only matters for RadixSortBits.
+		static	uqword			GetScratchMemory(SortEngine engine, udword nb, udword digit_bits=11);
+
+		inline_	const udword*	GetRanks()							const	{ return mRanks;				}
+
+		// Settings
+		inline_	const SortThresholds&	GetThresholds()				const	{ return mThresholds;			}
+		inline_	void			SetThresholds(const SortThresholds& t)		{ mThresholds = t;				}
+		//! Limits the scratch memory used by the engines (0 = no limit). Engines needing more are skipped. When none fits,
+		//! Sort() returns null and the last engine is SORT_ENGINE_NONE.
+		inline_	void			SetMaxScratchMemory(uqword nb_bytes)		{ mMaxScratchMemory = nb_bytes;	}
+		//! Forgets the ranks kept for temporal coherence: equal values keep the input order in the next call. IntroSort &
+		//! RadixSort2 don't keep any.
+		inline_	void			ResetRanks()
+								{
+									mRadix.ResetRanks();	mRadix3.ResetRanks();
+									mRadix8.ResetRanks();	mRadix10.ResetRanks();	mRadix12.ResetRanks();	mRadix16.ResetRanks();
+								}
+
+		// Instrumentation
+		//! Returns the engine used by the last call.
+		inline_	SortEngine		GetLastEngine()						const	{ return mLastEngine;			}
+		//! Returns the number of calls handled by an engine.
+		inline_	udword			GetNbCalls(SortEngine engine)		const	{ return mNbCalls[engine];		}
+
+								PREVENT_COPY(SortDispatcher)
+		private:
+				RadixSort		mRadix;
+				RadixSort3		mRadix3;
+				RadixSort2		mRadix2;
+				RadixSort8Bits	mRadix8;
+				RadixSort10Bits	mRadix10;
+				RadixSort12Bits	mRadix12;
+				RadixSort16Bits	mRadix16;
+				uqword*			mPairs;				//!< (key, index) pairs for IntroSort
+				udword*			mIntroRanks;		//!< Ranks from IntroSort
+				udword			mIntroSize;			//!< Capacity of the IntroSort buffers
+				const udword*	mRanks;				//!< Ranks from the last call
+				udword			mLastNb;			//!< Number of values in the last call
+				SortEngine		mLastEngine;
+				udword			mNbCalls[SORT_ENGINE_COUNT];
+				SortThresholds	mThresholds;
+				uqword			mMaxScratchMemory;
+
+				bool			FitsInScratchMemory(SortEngine engine, udword nb)	const;
+		template<class Traits>
+				const udword*	SortIntro(const typename Traits::Type* input, udword nb);
+		template<class T>
+				const udword*	SortRadixBits(const T* input, udword nb, const RadixHints& hints);
+	};
+
+#endif // SORT_DISPATCHER_H
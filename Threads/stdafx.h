@@ -31,6 +31,15 @@
 	#include <float.h>
 	#include <Math.h>
 
+	// For the sort thread pool
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+	#include <atomic>
+
+	// For the profiler, rdtsc & cpuid intrinsics on x64
+	#include <intrin.h>
+
 	#ifndef ASSERT
 		#define	ASSERT(exp)	{}
 	#endif
@@ -54,24 +63,46 @@
 	{
 		#include ".\Ice\IceUtils.h"
 		#include ".\Ice\IceAllocator.h"
+		#include ".\Ice\IceRadixHints.h"
+		#include ".\Ice\IceRadixEngine.h"
+		#include ".\Ice\IceSortThreadPool.h"
 		#include ".\Ice\IceRevisitedRadix.h"
 		#include ".\Ice\IceRadix3Passes.h"
+		#include ".\Ice\IceLargeRadix.h"
+		#include ".\Ice\IceRadixBits.h"
+		#include ".\Ice\IceParallelRadix.h"
+		#include ".\Ice\IceNumaTopology.h"
+		#include ".\Ice\IceNumaRadix.h"
+		#include ".\Ice\IcePermutation.h"
+		#include ".\Ice\IceIncrementalRadix.h"
+		#include ".\Ice\IceStreamingRadix.h"
+		#include ".\Ice\IceLazyRadix.h"
+		#include ".\Ice\IceStringRadix.h"
 		#include ".\Ice\IceRandom.h"
 	}
 	using namespace IceCore;
 
+	#include "IntroSort.h"
+
 	inline_ void	StartProfile(udword& val)
 	{
+#ifdef PLATFORM_X86
 		__asm{
 			cpuid
 			rdtsc
 			mov		ebx, val
 			mov		[ebx], eax
 		}
+#else
+		int CPUInfo[4];
+		__cpuid(CPUInfo, 0);
+		val = udword(__rdtsc());
+#endif
 	}
 
 	inline_ void	EndProfile(udword& val)
 	{
+#ifdef PLATFORM_X86
 		__asm{
 			cpuid
 			rdtsc
@@ -79,4 +110,9 @@
 			sub		eax, [ebx]
 			mov		[ebx], eax
 		}
+#else
+		int CPUInfo[4];
+		__cpuid(CPUInfo, 0);
+		val = udword(__rdtsc()) - val;
+#endif
 	}